@@ -0,0 +1,467 @@
+//*****************************************************************************
+//
+// decbench.c - Host benchmark of the firmware frame decoders.
+//
+// Runs the decoders from the firmware on a stream of packets written by
+// codecBench.py --dump and reports their throughput on the host.  Each
+// record in the stream is the packet type, the payload length (two bytes,
+// little endian) and the payload, without the link framing.
+//
+// Build from this directory with a host compiler, for example
+//
+//   gcc -O2 -I.. -o decbench decbench.c ../blockcodec.c ../tilecache.c
+//       ../vqcodec.c ../lzcodec.c ../huffcodec.c ../planecodec.c
+//       ../depthcodec.c ../drawcmd.c ../textcon.c ../sprite.c ../window.c
+//       ../framecache.c
+//
+// and run as
+//
+//   decbench <stream> [<decoded frames>]
+//
+// If a second file is named, every decoded frame is written to it so the
+// output can be compared against the encoder's reconstruction.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "video.h"
+#include "link.h"
+#include "blockcodec.h"
+#include "tilecache.h"
+#include "vqcodec.h"
+#include "lzcodec.h"
+#include "huffcodec.h"
+#include "planecodec.h"
+#include "depthcodec.h"
+#include "drawcmd.h"
+#include "textcon.h"
+#include "sprite.h"
+#include "window.h"
+#include "framecache.h"
+
+//*****************************************************************************
+//
+// The shortest time the stream is decoded for, in seconds.
+//
+//*****************************************************************************
+#define BENCH_MIN_TIME          1.0
+
+//*****************************************************************************
+//
+// Packet types counted separately; anything else is counted as the last.
+//
+//*****************************************************************************
+#define BENCH_TYPES             28
+
+//*****************************************************************************
+//
+// The frame slots, laid out as on the device.
+//
+//*****************************************************************************
+static uint32_t g_ppulFrame[2][FRAME_BYTES / 4];
+static unsigned long g_ulFront;
+
+//*****************************************************************************
+//
+// Per packet type totals.
+//
+//*****************************************************************************
+static unsigned long g_pulFrames[BENCH_TYPES];
+static unsigned long g_pulBytes[BENCH_TYPES];
+static double g_pdSeconds[BENCH_TYPES];
+
+static const char *g_ppcNames[BENCH_TYPES] =
+{
+    "raw", "block", "tile", "vqbook", "vq", "lz", "hufftab", "huff",
+    "plane", "depth", "?", "field", "refresh", "draw", "text", "sprimg",
+    "sprite", "scroll", "layout", "window", "clip", "store", "show", "time",
+    "sync", "stamp", "profile", "?"
+};
+
+//*****************************************************************************
+//
+// The frame cache reports its counters to the host, which is not needed here.
+//
+//*****************************************************************************
+void
+LinkReport(unsigned char ucType, const unsigned char *pucData,
+           unsigned long ulLength)
+{
+    (void)ucType;
+    (void)pucData;
+    (void)ulLength;
+}
+
+//*****************************************************************************
+//
+// Returns the current time in seconds.
+//
+//*****************************************************************************
+static double
+BenchTime(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return(sNow.tv_sec + (sNow.tv_nsec * 1e-9));
+}
+
+//*****************************************************************************
+//
+// Decodes one packet into the back slot and swaps the slots.  Returns 0 if a
+// frame was produced, 1 for a packet that does not produce one, or -1 if the
+// decoder rejected it.
+//
+//*****************************************************************************
+static long
+BenchDecode(unsigned char ucType, const unsigned char *pucData,
+            unsigned long ulLength)
+{
+    unsigned short pusDirty[VIDEO_BANDS];
+    unsigned char *pucFront, *pucBack;
+    unsigned long ulRow, ulCached;
+    long lResult;
+
+    pucFront = (unsigned char *)g_ppulFrame[g_ulFront];
+    pucBack = (unsigned char *)g_ppulFrame[g_ulFront ^ 1];
+
+    switch(ucType)
+    {
+        case LINK_PKT_RAW:
+        {
+            if(ulLength != FRAME_BYTES)
+            {
+                return(-1);
+            }
+            memcpy(pucBack, pucData, FRAME_BYTES);
+            lResult = 0;
+            break;
+        }
+
+        case LINK_PKT_BLOCK:
+        {
+            lResult = BlockDecode(pucData, ulLength, pucFront, pucBack,
+                                  pusDirty);
+            break;
+        }
+
+        case LINK_PKT_TILE:
+        {
+            lResult = TileDecode(pucData, ulLength, pucBack, pusDirty);
+            break;
+        }
+
+        case LINK_PKT_VQ_CODEBOOK:
+        {
+            return(VQCodebookLoad(pucData, ulLength) ? -1 : 1);
+        }
+
+        case LINK_PKT_VQ:
+        {
+            lResult = VQDecode(pucData, ulLength, pucBack);
+            break;
+        }
+
+        case LINK_PKT_LZ:
+        {
+            lResult = LZDecode(pucData, ulLength, pucFront, pucBack);
+            break;
+        }
+
+        case LINK_PKT_HUFF_TABLE:
+        {
+            return(HuffTableLoad(pucData, ulLength) ? -1 : 1);
+        }
+
+        case LINK_PKT_HUFF:
+        {
+            lResult = HuffDecode(pucData, ulLength, pucFront, pucBack);
+            break;
+        }
+
+        case LINK_PKT_PLANE:
+        {
+            lResult = PlaneDecode(pucData, ulLength, pucFront, pucBack);
+            break;
+        }
+
+        case LINK_PKT_DEPTH:
+        {
+            lResult = DepthDecode(pucData, ulLength, pucBack);
+            break;
+        }
+
+        case LINK_PKT_REFRESH:
+        {
+            if((ulLength == 0) || (pucData[0] >= BLOCK_ROWS))
+            {
+                return(-1);
+            }
+            lResult = BlockDecode(pucData + 1, ulLength - 1, pucFront, pucBack,
+                                  pusDirty);
+            break;
+        }
+
+        case LINK_PKT_FIELD:
+        {
+            if((ulLength != (1 + (FRAME_BYTES / 2))) ||
+               (pucData[0] & ~VIDEO_FIELD_ODD))
+            {
+                return(-1);
+            }
+            for(ulRow = 0; ulRow < FRAME_HEIGHT; ulRow++)
+            {
+                if((ulRow & 1) == pucData[0])
+                {
+                    memcpy(pucBack + (ulRow * FRAME_STRIDE),
+                           pucData + 1 + ((ulRow / 2) * FRAME_STRIDE),
+                           FRAME_STRIDE);
+                }
+                else
+                {
+                    memcpy(pucBack + (ulRow * FRAME_STRIDE),
+                           pucFront + (ulRow * FRAME_STRIDE), FRAME_STRIDE);
+                }
+            }
+            lResult = 0;
+            break;
+        }
+
+        case LINK_PKT_DRAW:
+        {
+            memcpy(pucBack, pucFront, FRAME_BYTES);
+            lResult = DrawDecode(pucData, ulLength, pucBack, pusDirty,
+                                 &ulCached);
+            break;
+        }
+
+        case LINK_PKT_TEXT:
+        {
+            memcpy(pucBack, pucFront, FRAME_BYTES);
+            lResult = TextDecode(pucData, ulLength, pucBack, pusDirty);
+            break;
+        }
+
+        case LINK_PKT_SPRITE_IMAGE:
+        {
+            return(SpriteImageLoad(pucData, ulLength) ? -1 : 1);
+        }
+
+        case LINK_PKT_SPRITE:
+        {
+            memcpy(pucBack, pucFront, FRAME_BYTES);
+            memset(pusDirty, 0, sizeof(pusDirty));
+            lResult = SpriteDecode(pucData, ulLength, pucBack, pusDirty);
+            break;
+        }
+
+        case LINK_PKT_SCROLL:
+        {
+            if((ulLength == 0) || (pucData[0] == 0) ||
+               (pucData[0] > FRAME_HEIGHT) ||
+               (ulLength != (1UL + (pucData[0] * FRAME_STRIDE))))
+            {
+                return(-1);
+            }
+            ulLength--;
+            memcpy(pucBack, pucFront + ulLength, FRAME_BYTES - ulLength);
+            memcpy(pucBack + FRAME_BYTES - ulLength, pucData + 1, ulLength);
+            lResult = 0;
+            break;
+        }
+
+        case LINK_PKT_LAYOUT:
+        {
+            return(WindowLayout(pucData, ulLength) ? -1 : 1);
+        }
+
+        case LINK_PKT_WINDOW:
+        {
+            memcpy(pucBack, pucFront, FRAME_BYTES);
+            memset(pusDirty, 0, sizeof(pusDirty));
+            lResult = WindowDecode(pucData, ulLength, pucBack, pusDirty);
+            break;
+        }
+
+        case LINK_PKT_CACHE_STORE:
+        {
+            if(ulLength != 1)
+            {
+                return(-1);
+            }
+            FrameCacheStore(pucData[0], pucFront);
+            return(1);
+        }
+
+        case LINK_PKT_CACHE_SHOW:
+        {
+            if(ulLength != 1)
+            {
+                return(-1);
+            }
+            lResult = FrameCacheShow(pucData[0], pucBack) ? -1 : 0;
+            break;
+        }
+
+        default:
+        {
+            return(1);
+        }
+    }
+
+    if(lResult == 0)
+    {
+        g_ulFront ^= 1;
+    }
+    return(lResult);
+}
+
+//*****************************************************************************
+//
+// Decodes the whole stream once, adding to the totals.  Returns the number
+// of packets rejected.
+//
+//*****************************************************************************
+static unsigned long
+BenchPass(const unsigned char *pucStream, unsigned long ulSize, FILE *pOut)
+{
+    unsigned long ulPos, ulLength, ulType, ulErrors;
+    double dStart;
+    long lResult;
+
+    //
+    // Each pass starts with the frame cache empty, as the host's mirror did.
+    //
+    FrameCacheForget();
+    ulErrors = 0;
+    for(ulPos = 0; (ulPos + 3) <= ulSize; ulPos += 3 + ulLength)
+    {
+        ulType = pucStream[ulPos];
+        ulLength = pucStream[ulPos + 1] | (pucStream[ulPos + 2] << 8);
+        if((ulPos + 3 + ulLength) > ulSize)
+        {
+            break;
+        }
+
+        dStart = BenchTime();
+        lResult = BenchDecode(ulType, pucStream + ulPos + 3, ulLength);
+        if(ulType >= BENCH_TYPES)
+        {
+            ulType = BENCH_TYPES - 1;
+        }
+        g_pdSeconds[ulType] += BenchTime() - dStart;
+        g_pulBytes[ulType] += ulLength;
+
+        if(lResult < 0)
+        {
+            ulErrors++;
+        }
+        else if(lResult == 0)
+        {
+            g_pulFrames[ulType]++;
+            if(pOut)
+            {
+                fwrite(g_ppulFrame[g_ulFront], 1, FRAME_BYTES, pOut);
+            }
+        }
+    }
+
+    return(ulErrors);
+}
+
+//*****************************************************************************
+//
+// Loads the stream, decodes it repeatedly and prints the throughput of each
+// decoder.
+//
+//*****************************************************************************
+int
+main(int argc, char **argv)
+{
+    unsigned char *pucStream;
+    unsigned long ulSize, ulType, ulPasses, ulErrors;
+    double dTotal;
+    FILE *pFile;
+
+    if((argc < 2) || (argc > 3))
+    {
+        fprintf(stderr, "usage: %s <stream> [<decoded frames>]\n", argv[0]);
+        return(1);
+    }
+
+    pFile = fopen(argv[1], "rb");
+    if(!pFile)
+    {
+        perror(argv[1]);
+        return(1);
+    }
+    fseek(pFile, 0, SEEK_END);
+    ulSize = ftell(pFile);
+    fseek(pFile, 0, SEEK_SET);
+    pucStream = malloc(ulSize ? ulSize : 1);
+    if(!pucStream || (fread(pucStream, 1, ulSize, pFile) != ulSize))
+    {
+        fprintf(stderr, "%s: read failed\n", argv[1]);
+        return(1);
+    }
+    fclose(pFile);
+
+    //
+    // The first pass checks the stream and writes out the decoded frames.
+    //
+    pFile = 0;
+    if(argc == 3)
+    {
+        pFile = fopen(argv[2], "wb");
+        if(!pFile)
+        {
+            perror(argv[2]);
+            return(1);
+        }
+    }
+    ulErrors = BenchPass(pucStream, ulSize, pFile);
+    if(pFile)
+    {
+        fclose(pFile);
+    }
+
+    //
+    // Repeat until the timings are long enough to be meaningful.
+    //
+    ulPasses = 1;
+    do
+    {
+        BenchPass(pucStream, ulSize, 0);
+        ulPasses++;
+        for(dTotal = 0, ulType = 0; ulType < BENCH_TYPES; ulType++)
+        {
+            dTotal += g_pdSeconds[ulType];
+        }
+    }
+    while(dTotal < BENCH_MIN_TIME);
+
+    printf("%lu passes, %lu packets rejected per pass\n", ulPasses,
+           ulErrors);
+    printf("%-7s %8s %12s %10s %10s\n", "type", "frames", "bytes/frame",
+           "us/frame", "out MB/s");
+    for(ulType = 0; ulType < BENCH_TYPES; ulType++)
+    {
+        if(!g_pulFrames[ulType])
+        {
+            continue;
+        }
+        printf("%-7s %8lu %12.0f %10.2f %10.1f\n", g_ppcNames[ulType],
+               g_pulFrames[ulType] / ulPasses,
+               (double)g_pulBytes[ulType] / g_pulFrames[ulType],
+               1e6 * g_pdSeconds[ulType] / g_pulFrames[ulType],
+               (g_pulFrames[ulType] * (double)FRAME_BYTES) /
+               (g_pdSeconds[ulType] * 1e6));
+    }
+
+    free(pucStream);
+    return(0);
+}
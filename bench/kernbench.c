@@ -0,0 +1,263 @@
+//*****************************************************************************
+//
+// kernbench.c - Host benchmark of the row kernels against a generic loop.
+//
+// Expands rows with every kernel variant rowkernel.h can generate and with a
+// single loop that tests the depth, scale and operation for each pixel,
+// checks that both produce the same output and reports the speed of each.
+//
+// Build from this directory with a host compiler, for example
+//
+//   gcc -O2 -I.. -o kernbench kernbench.c
+//
+// and run with no arguments.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "rowkernel.h"
+
+//*****************************************************************************
+//
+// The amount of output produced per timing, in words: one frame.
+//
+//*****************************************************************************
+#define BENCH_WORDS             1536
+
+//*****************************************************************************
+//
+// The shortest time each variant is run for, in seconds.
+//
+//*****************************************************************************
+#define BENCH_MIN_TIME          0.2
+
+//*****************************************************************************
+//
+// The kernels, tables and buffers.
+//
+//*****************************************************************************
+ROW_KERNEL_TABLE(BenchTable11, 1, 1)
+ROW_KERNEL_TABLE(BenchTable12, 1, 2)
+ROW_KERNEL_TABLE(BenchTable21, 2, 1)
+ROW_KERNEL_TABLE(BenchTable22, 2, 2)
+ROW_KERNEL_TABLE(BenchTable42, 4, 2)
+ROW_KERNEL(BenchCopy11, 1, 1, COPY)
+ROW_KERNEL(BenchCopy12, 1, 2, COPY)
+ROW_KERNEL(BenchCopy21, 2, 1, COPY)
+ROW_KERNEL(BenchCopy22, 2, 2, COPY)
+ROW_KERNEL(BenchCopy41, 4, 1, COPY)
+ROW_KERNEL(BenchCopy42, 4, 2, COPY)
+ROW_KERNEL(BenchXor11, 1, 1, XOR)
+ROW_KERNEL(BenchXor12, 1, 2, XOR)
+ROW_KERNEL(BenchXor21, 2, 1, XOR)
+ROW_KERNEL(BenchXor22, 2, 2, XOR)
+ROW_KERNEL(BenchXor41, 4, 1, XOR)
+ROW_KERNEL(BenchXor42, 4, 2, XOR)
+
+static uint32_t g_pulTable[256];
+static uint32_t g_pulSrc[BENCH_WORDS];
+static uint32_t g_pulOut[BENCH_WORDS];
+static uint32_t g_pulCheck[BENCH_WORDS];
+
+//*****************************************************************************
+//
+// One kernel variant.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulBits;
+    unsigned long ulScale;
+    int bXor;
+    void (*pfnTable)(uint32_t *pulTable, const unsigned char *pucLevel);
+    void (*pfnKernel)(uint32_t *pulDst, const unsigned char *pucSrc,
+                      const uint32_t *pulTable, unsigned long ulWords);
+}
+tBenchKernel;
+
+static const tBenchKernel g_psKernels[] =
+{
+    { 1, 1, 0, BenchTable11, BenchCopy11 },
+    { 1, 2, 0, BenchTable12, BenchCopy12 },
+    { 2, 1, 0, BenchTable21, BenchCopy21 },
+    { 2, 2, 0, BenchTable22, BenchCopy22 },
+    { 4, 1, 0, 0, BenchCopy41 },
+    { 4, 2, 0, BenchTable42, BenchCopy42 },
+    { 1, 1, 1, BenchTable11, BenchXor11 },
+    { 1, 2, 1, BenchTable12, BenchXor12 },
+    { 2, 1, 1, BenchTable21, BenchXor21 },
+    { 2, 2, 1, BenchTable22, BenchXor22 },
+    { 4, 1, 1, 0, BenchXor41 },
+    { 4, 2, 1, BenchTable42, BenchXor42 }
+};
+
+//*****************************************************************************
+//
+// Returns the current time in seconds.
+//
+//*****************************************************************************
+static double
+BenchTime(void)
+{
+    struct timespec sNow;
+
+    clock_gettime(CLOCK_MONOTONIC, &sNow);
+    return(sNow.tv_sec + (sNow.tv_nsec * 1e-9));
+}
+
+//*****************************************************************************
+//
+// The generic row loop: one output pixel at a time, with the depth, scale
+// and operation tested for each.
+//
+//*****************************************************************************
+static void
+BenchGeneric(uint32_t *pulDst, const unsigned char *pucSrc,
+             const unsigned char *pucLevel, unsigned long ulBits,
+             unsigned long ulScale, int bXor, unsigned long ulWords)
+{
+    unsigned char *pucDst;
+    unsigned long ulOut, ulIn, ulValue, ulPixel;
+
+    pucDst = (unsigned char *)pulDst;
+    for(ulOut = 0; ulOut < (ulWords * 8); ulOut++)
+    {
+        ulIn = (ulScale == 2) ? (ulOut / 2) : ulOut;
+        if(ulBits == 1)
+        {
+            ulValue = (pucSrc[ulIn / 8] >> (7 - (ulIn % 8))) & 1;
+        }
+        else if(ulBits == 2)
+        {
+            ulValue = (pucSrc[ulIn / 4] >> (6 - (2 * (ulIn % 4)))) & 3;
+        }
+        else
+        {
+            ulValue = (pucSrc[ulIn / 2] >> ((ulIn & 1) ? 0 : 4)) & 0xF;
+        }
+        ulPixel = pucLevel[ulValue];
+        if(!(ulOut & 1))
+        {
+            ulPixel <<= 4;
+        }
+        if(bXor)
+        {
+            pucDst[ulOut / 2] ^= ulPixel;
+        }
+        else if(ulOut & 1)
+        {
+            pucDst[ulOut / 2] |= ulPixel;
+        }
+        else
+        {
+            pucDst[ulOut / 2] = ulPixel;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Runs each variant specialised and generic, and prints the throughput of
+// each.
+//
+//*****************************************************************************
+int
+main(void)
+{
+    unsigned char pucLevel[16];
+    unsigned long ulKernel, ulIdx, ulRuns;
+    const tBenchKernel *psKernel;
+    double dStart, dKernel, dGeneric;
+    int iFailed;
+
+    //
+    // Levels that differ from the input values show up palette errors.
+    //
+    for(ulIdx = 0; ulIdx < 16; ulIdx++)
+    {
+        pucLevel[ulIdx] = 15 - ulIdx;
+    }
+    for(ulIdx = 0; ulIdx < BENCH_WORDS; ulIdx++)
+    {
+        g_pulSrc[ulIdx] = (ulIdx * 2654435761u) ^ (ulIdx >> 3);
+    }
+
+    iFailed = 0;
+    printf("%-5s %-5s %-4s %12s %12s %8s\n", "bits", "scale", "op",
+           "kernel MB/s", "generic MB/s", "speedup");
+    for(ulKernel = 0; ulKernel < (sizeof(g_psKernels) /
+                                  sizeof(g_psKernels[0])); ulKernel++)
+    {
+        psKernel = &g_psKernels[ulKernel];
+        if(psKernel->pfnTable)
+        {
+            psKernel->pfnTable(g_pulTable, pucLevel);
+        }
+
+        //
+        // Four bit kernels without scaling copy their input unchanged, so
+        // the generic loop is given the identity palette for them.
+        //
+        memset(g_pulOut, 0x5A, sizeof(g_pulOut));
+        memset(g_pulCheck, 0x5A, sizeof(g_pulCheck));
+        psKernel->pfnKernel(g_pulOut, (unsigned char *)g_pulSrc, g_pulTable,
+                            BENCH_WORDS);
+        if(!psKernel->pfnTable)
+        {
+            for(ulIdx = 0; ulIdx < 16; ulIdx++)
+            {
+                pucLevel[ulIdx] = ulIdx;
+            }
+        }
+        BenchGeneric(g_pulCheck, (unsigned char *)g_pulSrc, pucLevel,
+                     psKernel->ulBits, psKernel->ulScale, psKernel->bXor,
+                     BENCH_WORDS);
+        if(memcmp(g_pulOut, g_pulCheck, sizeof(g_pulOut)))
+        {
+            printf("%lu bit, scale %lu %s: output differs\n",
+                   psKernel->ulBits, psKernel->ulScale,
+                   psKernel->bXor ? "xor" : "copy");
+            iFailed = 1;
+        }
+
+        ulRuns = 0;
+        dStart = BenchTime();
+        do
+        {
+            psKernel->pfnKernel(g_pulOut, (unsigned char *)g_pulSrc,
+                                g_pulTable, BENCH_WORDS);
+            ulRuns++;
+            dKernel = BenchTime() - dStart;
+        }
+        while(dKernel < BENCH_MIN_TIME);
+        dKernel /= ulRuns;
+
+        ulRuns = 0;
+        dStart = BenchTime();
+        do
+        {
+            BenchGeneric(g_pulCheck, (unsigned char *)g_pulSrc, pucLevel,
+                         psKernel->ulBits, psKernel->ulScale, psKernel->bXor,
+                         BENCH_WORDS);
+            ulRuns++;
+            dGeneric = BenchTime() - dStart;
+        }
+        while(dGeneric < BENCH_MIN_TIME);
+        dGeneric /= ulRuns;
+
+        printf("%-5lu %-5lu %-4s %12.1f %12.1f %7.1fx\n", psKernel->ulBits,
+               psKernel->ulScale, psKernel->bXor ? "xor" : "copy",
+               (BENCH_WORDS * 4) / (dKernel * 1e6),
+               (BENCH_WORDS * 4) / (dGeneric * 1e6), dGeneric / dKernel);
+
+        for(ulIdx = 0; ulIdx < 16; ulIdx++)
+        {
+            pucLevel[ulIdx] = 15 - ulIdx;
+        }
+    }
+
+    return(iFailed);
+}
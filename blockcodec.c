@@ -0,0 +1,161 @@
+//*****************************************************************************
+//
+// blockcodec.c - Decoder for the 8x8 block skip/copy/raw inter frame codec.
+//
+// The 128x96 frame is split into a 16x12 grid of 8x8 blocks.  A block frame
+// starts with 48 bytes of block modes, two bits per block in raster order
+// with the first block of each byte in bits 1:0.  The per-block data follows
+// in the same order:
+//
+//   BLOCK_SKIP - nothing; the block is unchanged from the reference frame.
+//   BLOCK_COPY - one motion vector byte.  Bits 7:4 are the signed horizontal
+//                offset in bytes and bits 3:0 the signed vertical offset in
+//                rows of the source block in the reference frame.
+//   BLOCK_RAW  - 32 bytes of pixels, four bytes for each of the eight rows.
+//   BLOCK_FILL - one byte that is repeated across the whole block.
+//
+// Panning and scrolling content turns into a frame of mostly copy blocks, one
+// byte each, instead of a full resend.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include "video.h"
+#include "blockcodec.h"
+
+//*****************************************************************************
+//
+//! Decodes a block frame.
+//!
+//! \param pucData is a pointer to the encoded frame.
+//! \param ulLength is the number of bytes of encoded data.
+//! \param pucRef is the reference frame that skip and copy blocks read from.
+//! \param pucFrame is the frame slot to decode into; it must not be the same
+//! as \e pucRef and must be word aligned.
+//! \param pusDirty is an array of \b VIDEO_BANDS masks; the bit for every
+//! block that is not skipped is set.
+//!
+//! \return Returns 0 on success or -1 if the encoded data is malformed, in
+//! which case the contents of \e pucFrame are undefined.
+//
+//*****************************************************************************
+long
+BlockDecode(const unsigned char *pucData, unsigned long ulLength,
+            const unsigned char *pucRef, unsigned char *pucFrame,
+            unsigned short *pusDirty)
+{
+    const unsigned char *pucModes, *pucEnd, *pucSrc;
+    unsigned char *pucDst;
+    unsigned long ulBlock, ulMode, ulX, ulY, ulRow;
+    long lX, lY;
+    uint32_t ulFill;
+
+    if(ulLength < BLOCK_MODE_BYTES)
+    {
+        return(-1);
+    }
+    pucModes = pucData;
+    pucEnd = pucData + ulLength;
+    pucData += BLOCK_MODE_BYTES;
+
+    for(ulBlock = 0; ulBlock < BLOCK_COUNT; ulBlock++)
+    {
+        ulX = (ulBlock % BLOCK_COLS) * BLOCK_ROW_BYTES;
+        ulY = (ulBlock / BLOCK_COLS) * BLOCK_SIZE;
+        pucDst = pucFrame + (ulY * FRAME_STRIDE) + ulX;
+        ulMode = (pucModes[ulBlock / 4] >> ((ulBlock % 4) * 2)) & 3;
+
+        //
+        // Skipped blocks are aligned in both frames, so copy a word per row.
+        //
+        if(ulMode == BLOCK_SKIP)
+        {
+            pucSrc = pucRef + (ulY * FRAME_STRIDE) + ulX;
+            for(ulRow = 0; ulRow < BLOCK_SIZE; ulRow++)
+            {
+                *(uint32_t *)pucDst = *(const uint32_t *)pucSrc;
+                pucDst += FRAME_STRIDE;
+                pucSrc += FRAME_STRIDE;
+            }
+            continue;
+        }
+
+        pusDirty[ulBlock / BLOCK_COLS] |= 1 << (ulBlock % BLOCK_COLS);
+        switch(ulMode)
+        {
+            case BLOCK_COPY:
+            {
+                if(pucData >= pucEnd)
+                {
+                    return(-1);
+                }
+
+                //
+                // Sign extend the two four bit vector components and make
+                // sure the source block lies inside the reference frame.
+                //
+                lX = (long)ulX + ((long)((*pucData >> 4) ^ 8) - 8);
+                lY = (long)ulY + ((long)((*pucData & 0xF) ^ 8) - 8);
+                pucData++;
+                if((lX < 0) || (lX > (FRAME_STRIDE - BLOCK_ROW_BYTES)) ||
+                   (lY < 0) || (lY > (FRAME_HEIGHT - BLOCK_SIZE)))
+                {
+                    return(-1);
+                }
+
+                //
+                // The source may be at any byte offset, so copy bytewise.
+                //
+                pucSrc = pucRef + (lY * FRAME_STRIDE) + lX;
+                for(ulRow = 0; ulRow < BLOCK_SIZE; ulRow++)
+                {
+                    pucDst[0] = pucSrc[0];
+                    pucDst[1] = pucSrc[1];
+                    pucDst[2] = pucSrc[2];
+                    pucDst[3] = pucSrc[3];
+                    pucDst += FRAME_STRIDE;
+                    pucSrc += FRAME_STRIDE;
+                }
+                break;
+            }
+
+            case BLOCK_RAW:
+            {
+                if((pucEnd - pucData) < (BLOCK_SIZE * BLOCK_ROW_BYTES))
+                {
+                    return(-1);
+                }
+                for(ulRow = 0; ulRow < BLOCK_SIZE; ulRow++)
+                {
+                    pucDst[0] = pucData[0];
+                    pucDst[1] = pucData[1];
+                    pucDst[2] = pucData[2];
+                    pucDst[3] = pucData[3];
+                    pucDst += FRAME_STRIDE;
+                    pucData += BLOCK_ROW_BYTES;
+                }
+                break;
+            }
+
+            default:
+            {
+                if(pucData >= pucEnd)
+                {
+                    return(-1);
+                }
+                ulFill = (uint32_t)*pucData++ * 0x01010101;
+                for(ulRow = 0; ulRow < BLOCK_SIZE; ulRow++)
+                {
+                    *(uint32_t *)pucDst = ulFill;
+                    pucDst += FRAME_STRIDE;
+                }
+                break;
+            }
+        }
+    }
+
+    //
+    // Trailing bytes mean the host and device disagree about the format.
+    //
+    return((pucData == pucEnd) ? 0 : -1);
+}
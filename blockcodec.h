@@ -0,0 +1,51 @@
+//*****************************************************************************
+//
+// blockcodec.h - Decoder for the 8x8 block skip/copy/raw inter frame codec.
+//
+//*****************************************************************************
+
+#ifndef __BLOCKCODEC_H__
+#define __BLOCKCODEC_H__
+
+//*****************************************************************************
+//
+// Block geometry.  A block is 8x8 pixels, which is four bytes of each of
+// eight rows in the frame slot.
+//
+//*****************************************************************************
+#define BLOCK_SIZE              8
+#define BLOCK_ROW_BYTES         (BLOCK_SIZE / 2)
+#define BLOCK_COLS              16
+#define BLOCK_ROWS              12
+#define BLOCK_COUNT             (BLOCK_COLS * BLOCK_ROWS)
+#define BLOCK_MODE_BYTES        (BLOCK_COUNT / 4)
+
+//*****************************************************************************
+//
+// Block coding modes, two bits per block.
+//
+//*****************************************************************************
+#define BLOCK_SKIP              0           // Same as the reference frame
+#define BLOCK_COPY              1           // Displaced copy of the reference
+#define BLOCK_RAW               2           // 32 bytes of new pixel data
+#define BLOCK_FILL              3           // Solid fill, one byte
+
+//*****************************************************************************
+//
+// Range of a motion vector.  The horizontal component is in bytes (pairs of
+// pixels), the vertical component in rows; both are signed four bit values.
+//
+//*****************************************************************************
+#define BLOCK_MV_MIN            (-8)
+#define BLOCK_MV_MAX            7
+
+//*****************************************************************************
+//
+// Prototypes for the block codec APIs.
+//
+//*****************************************************************************
+extern long BlockDecode(const unsigned char *pucData, unsigned long ulLength,
+                        const unsigned char *pucRef, unsigned char *pucFrame,
+                        unsigned short *pusDirty);
+
+#endif // __BLOCKCODEC_H__
@@ -0,0 +1,104 @@
+#Encoder for the 8x8 block skip/copy/raw inter frame codec decoded by
+#blockcodec.c on the device
+from hostframe import STRIDE, HEIGHT
+
+#Block geometry, matching blockcodec.h
+BLOCK_SIZE = 8
+ROW_BYTES = BLOCK_SIZE // 2
+COLS = 16
+ROWS = 12
+COUNT = COLS * ROWS
+MODE_BYTES = COUNT // 4
+
+#Block coding modes
+SKIP = 0
+COPY = 1
+RAW = 2
+FILL = 3
+
+#Motion vector range; horizontal in bytes, vertical in rows
+MV_MIN = -8
+MV_MAX = 7
+
+#Most positions remembered for one block pattern when indexing a frame
+MAX_POSITIONS = 8
+
+
+def columns(frame):
+    """Split a frame into 4-byte wide columns, one per byte offset, each a
+    list of row slices"""
+    return [[bytes(frame[y * STRIDE + x:y * STRIDE + x + ROW_BYTES])
+             for y in range(HEIGHT)]
+            for x in range(STRIDE - ROW_BYTES + 1)]
+
+
+def index(cols):
+    """Map every 8x8 block pattern in a frame, at any byte and row offset, to
+    the positions it occurs at"""
+    positions = {}
+    for x, col in enumerate(cols):
+        for y in range(HEIGHT - BLOCK_SIZE + 1):
+            found = positions.setdefault(b''.join(col[y:y + BLOCK_SIZE]), [])
+            if len(found) < MAX_POSITIONS:
+                found.append((x, y))
+    return positions
+
+
+class BlockEncoder(object):
+    """Lossless block encoder.  The columns of each frame are kept between
+    calls since each frame becomes the next frame's reference."""
+
+    def __init__(self):
+        self.ref = None
+        self.ref_cols = None
+        self.ref_index = None
+
+    def encode(self, frame, ref, refresh=None):
+        """Encode frame as a block frame against ref, returning the payload.
+        If refresh is a band of blocks, that band is coded without the
+        reference and no block above it copies from it or below it."""
+        cols = columns(frame)
+        if ref is not self.ref:
+            self.ref = ref
+            self.ref_cols = columns(ref)
+            self.ref_index = None
+        modes = bytearray(MODE_BYTES)
+        data = bytearray()
+        for block in range(COUNT):
+            x = (block % COLS) * ROW_BYTES
+            y = (block // COLS) * BLOCK_SIZE
+            cur = b''.join(cols[x][y:y + BLOCK_SIZE])
+            #Blocks above the refresh band may only copy from bands already
+            #refreshed in the reference
+            limit = HEIGHT
+            intra = False
+            if refresh is not None:
+                intra = y == refresh * BLOCK_SIZE
+                if y < refresh * BLOCK_SIZE:
+                    limit = refresh * BLOCK_SIZE
+            if not intra and cur == b''.join(self.ref_cols[x][y:y + BLOCK_SIZE]):
+                mode = SKIP
+            elif cur == cur[:1] * (BLOCK_SIZE * ROW_BYTES):
+                mode = FILL
+                data += cur[:1]
+            else:
+                mode = RAW
+                #Only index the reference once a block needs searching
+                if self.ref_index is None:
+                    self.ref_index = index(self.ref_cols)
+                for px, py in () if intra else self.ref_index.get(cur, ()):
+                    dx = px - x
+                    dy = py - y
+                    if (MV_MIN <= dx <= MV_MAX and MV_MIN <= dy <= MV_MAX and
+                            py + BLOCK_SIZE <= limit):
+                        mode = COPY
+                        data.append((dx & 0xF) << 4 | (dy & 0xF))
+                        break
+                if mode == RAW:
+                    data += cur
+            modes[block >> 2] |= mode << ((block & 3) * 2)
+        #The frame is the reference for the next one
+        self.ref = frame
+        self.ref_cols = cols
+        self.ref_index = None
+        return modes + data
@@ -0,0 +1,75 @@
+//*****************************************************************************
+//
+// boot.c - Timeline of the steps from reset to the first frame.
+//
+// The units are power cycled often, so the time from reset until the board
+// can take packets, and until it shows a frame, matters as much as the frame
+// rate.  Each step of startup is marked with the cycle count when it is
+// first reached, counted from when the system clock is set, and once the
+// first frame is drawn the marks are sent to the host in a LINK_RPT_BOOT
+// report:
+//
+//   bytes 0-3     cycles to the system clock being set, which is zero
+//   bytes 4-7     cycles to being ready to receive from the host
+//   bytes 8-11    cycles to the display being cleared and turned on
+//   bytes 12-15   cycles to the first packet, or the first record of a clip
+//                 stored in flash
+//   bytes 16-19   cycles to the first frame being drawn
+//
+// The time before the clock is set, the reset itself, the start up code
+// and the PLL locking, is about a millisecond and is not counted.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "cyclecount.h"
+#include "link.h"
+#include "boot.h"
+
+//*****************************************************************************
+//
+// The cycle count at each step, and a bit for each step already marked.
+// Both start at zero from reset.
+//
+//*****************************************************************************
+static unsigned long g_pulBootMark[BOOT_MARKS];
+static unsigned long g_ulBootMarked;
+
+//*****************************************************************************
+//
+//! Marks a step of startup.
+//!
+//! \param ulMark is the step, one of the \b BOOT_MARK_ values.
+//!
+//! Only the first time a step is reached is kept, so the calls can stay in
+//! paths that run for every packet or frame.  Marking the first frame sends
+//! the timeline to the host.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+BootMark(unsigned long ulMark)
+{
+    unsigned char pucReport[BOOT_MARKS * 4];
+    unsigned long ulIdx;
+
+    if(g_ulBootMarked & (1 << ulMark))
+    {
+        return;
+    }
+    g_pulBootMark[ulMark] = CycleCountGet();
+    g_ulBootMarked |= 1 << ulMark;
+
+    if(ulMark == BOOT_MARK_FRAME)
+    {
+        for(ulIdx = 0; ulIdx < BOOT_MARKS; ulIdx++)
+        {
+            pucReport[ulIdx * 4] = g_pulBootMark[ulIdx];
+            pucReport[(ulIdx * 4) + 1] = g_pulBootMark[ulIdx] >> 8;
+            pucReport[(ulIdx * 4) + 2] = g_pulBootMark[ulIdx] >> 16;
+            pucReport[(ulIdx * 4) + 3] = g_pulBootMark[ulIdx] >> 24;
+        }
+        LinkReport(LINK_RPT_BOOT, pucReport, sizeof(pucReport));
+    }
+}
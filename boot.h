@@ -0,0 +1,29 @@
+//*****************************************************************************
+//
+// boot.h - Timeline of the steps from reset to the first frame.
+//
+//*****************************************************************************
+
+#ifndef __BOOT_H__
+#define __BOOT_H__
+
+//*****************************************************************************
+//
+// The steps marked, in the order they happen.
+//
+//*****************************************************************************
+#define BOOT_MARK_CLOCK         0           // System clock set
+#define BOOT_MARK_LINK          1           // Ready to receive from the host
+#define BOOT_MARK_DISPLAY       2           // Display cleared and turned on
+#define BOOT_MARK_PACKET        3           // First packet or clip record
+#define BOOT_MARK_FRAME         4           // First frame drawn
+#define BOOT_MARKS              5
+
+//*****************************************************************************
+//
+// Prototypes for the boot timeline APIs.
+//
+//*****************************************************************************
+extern void BootMark(unsigned long ulMark);
+
+#endif // __BOOT_H__
@@ -0,0 +1,47 @@
+#Measures how long the board takes from reset to being ready for packets and
+#to showing its first frame
+import time, sys, argparse
+import serial
+import hostframe, hostlink
+
+#Set serial baud rate
+baud = 1500000
+comPort = 'COM9'
+
+parser = argparse.ArgumentParser(description='Time the startup of the LM3S6965 video player')
+parser.add_argument('--port', default=comPort, help='serial port of the board')
+parser.add_argument('--timeout', type=float, default=30,
+                    help='seconds to wait for the board to be reset')
+args = parser.parse_args()
+
+#A grey frame to show, sent over and over as a host streaming to the board
+#when it comes up would
+frame = hostlink.packet(hostlink.PKT_RAW,
+                        bytearray([0x44]) * hostframe.FRAME_BYTES)
+
+ser = None
+try:
+    ser = serial.Serial(args.port, baud, timeout=0)
+    reports = hostlink.ReportParser()
+    print('Reset or power cycle the board')
+    boot = None
+    end = time.time() + args.timeout
+    while boot is None and time.time() < end:
+        ser.write(frame)
+        for rtype, payload in reports.feed(ser.read(max(1, ser.inWaiting()))):
+            if rtype == hostlink.RPT_BOOT:
+                boot = hostlink.boot_report(bytearray(payload))
+except KeyboardInterrupt:
+    boot = None
+except serial.SerialException:
+    sys.exit('Error: Serial Error. Please check that the board is connected')
+ser.close()
+
+if boot is None:
+    sys.exit('The board did not report a reset')
+#Marks are cycles from the clock being set; steps are the time between marks
+last = 0
+for step, cycles in zip(hostlink.BOOT_STEPS, boot):
+    print('%-14s %8.2f ms  (+%.2f ms)' % (step, 1000.0 * cycles / hostlink.CPU_HZ,
+                                          1000.0 * (cycles - last) / hostlink.CPU_HZ))
+    last = cycles
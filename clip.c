@@ -0,0 +1,395 @@
+//*****************************************************************************
+//
+// clip.c - Clips stored in flash and played back without the host.
+//
+// Looping content need not cross the serial link more than once.  The host
+// writes a clip into the flash region the linker script reserves for it, in
+// clip packets
+//
+//   byte 0        command (CLIP_CMD_*)
+//   rest          the command's arguments, multi-byte values little endian
+//
+// each of which is answered with a LINK_RPT_CLIP report
+//
+//   byte 0        command
+//   byte 1        status (CLIP_STATUS_*)
+//   bytes 2-5     the offset the next write must start at
+//
+// The host waits for each report before sending more, since the processor
+// stalls while the flash is erased or programmed and received characters
+// would be lost.  Pages are erased as the writes reach them.
+//
+// The region holds a header, which CLIP_CMD_END writes last, and then the
+// records of the clip, each
+//
+//   byte 0        packet type
+//   byte 1        flags (CLIP_RECORD_*)
+//   bytes 2-3     payload length
+//   rest          the payload, padded to a whole word
+//
+// Flash reads take no wait states, so payloads are decoded where they lie,
+// word aligned as in a receive buffer.  A stored clip plays from reset, in a
+// loop, until a packet arrives from the host.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/flash.h"
+#include "driverlib/sysctl.h"
+#include "cyclecount.h"
+#include "link.h"
+#include "clip.h"
+
+//*****************************************************************************
+//
+// The flash erase page size, and the header at the start of the region:
+// a marker, the bytes of records and the frame interval in microseconds.
+//
+//*****************************************************************************
+#define CLIP_PAGE_BYTES         1024
+#define CLIP_HEADER_BYTES       16
+#define CLIP_MARKER             0x50494C43  // "CLIP"
+
+//*****************************************************************************
+//
+// The largest write, in bytes.
+//
+//*****************************************************************************
+#define CLIP_WRITE_BYTES        1024
+
+//*****************************************************************************
+//
+// The flash region reserved for the clip, from the linker script.
+//
+//*****************************************************************************
+extern unsigned long _clip[];
+extern unsigned long _eclip[];
+
+//*****************************************************************************
+//
+// Writing: the offset of the next write in the records and the bytes of the
+// region erased so far.
+//
+//*****************************************************************************
+static unsigned long g_ulClipWrite;
+static unsigned long g_ulClipErased;
+
+//*****************************************************************************
+//
+// Playback: whether a clip is playing, the offset of its next record, its
+// frame interval in cycles and the cycle count at which the last frame was
+// due.
+//
+//*****************************************************************************
+static tBoolean g_bClipPlaying;
+static unsigned long g_ulClipRead;
+static unsigned long g_ulClipInterval;
+static unsigned long g_ulClipDue;
+
+//*****************************************************************************
+//
+// Words staged for programming, which must come from a word aligned buffer.
+//
+//*****************************************************************************
+#define CLIP_STAGE_BYTES        64
+static unsigned long g_pulClipStage[CLIP_STAGE_BYTES / 4];
+
+//*****************************************************************************
+//
+// Returns the header of the stored clip, or 0 if there is none.
+//
+//*****************************************************************************
+static const unsigned long *
+ClipHeader(void)
+{
+    const unsigned long *pulHeader;
+
+    pulHeader = _clip;
+    if((pulHeader[0] != CLIP_MARKER) ||
+       (pulHeader[1] > ((unsigned long)_eclip - (unsigned long)_clip -
+                        CLIP_HEADER_BYTES)))
+    {
+        return(0);
+    }
+    return(pulHeader);
+}
+
+//*****************************************************************************
+//
+// Sends the report for a clip command.
+//
+//*****************************************************************************
+static void
+ClipReport(unsigned long ulCommand, unsigned long ulStatus)
+{
+    unsigned char pucReport[6];
+
+    pucReport[0] = ulCommand;
+    pucReport[1] = ulStatus;
+    pucReport[2] = g_ulClipWrite;
+    pucReport[3] = g_ulClipWrite >> 8;
+    pucReport[4] = g_ulClipWrite >> 16;
+    pucReport[5] = g_ulClipWrite >> 24;
+    LinkReport(LINK_RPT_CLIP, pucReport, sizeof(pucReport));
+}
+
+//*****************************************************************************
+//
+// Erases the pages of the region up to a byte offset from its start.
+// Returns 0 on success or -1 if an erase failed.
+//
+//*****************************************************************************
+static long
+ClipErase(unsigned long ulEnd)
+{
+    while(g_ulClipErased < ulEnd)
+    {
+        if(FlashErase((unsigned long)_clip + g_ulClipErased) != 0)
+        {
+            return(-1);
+        }
+        g_ulClipErased += CLIP_PAGE_BYTES;
+    }
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Starts playing the stored clip, if there is one.
+//!
+//! This must be called after the system clock is set.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClipInit(void)
+{
+    const unsigned long *pulHeader;
+
+    FlashUsecSet(SysCtlClockGet() / 1000000);
+    g_ulClipWrite = 0;
+    g_ulClipErased = 0;
+    g_bClipPlaying = false;
+    pulHeader = ClipHeader();
+    if(pulHeader)
+    {
+        g_bClipPlaying = true;
+        g_ulClipRead = 0;
+        g_ulClipInterval = pulHeader[2] * (SysCtlClockGet() / 1000000);
+        g_ulClipDue = CycleCountGet();
+    }
+}
+
+//*****************************************************************************
+//
+//! Carries out a clip packet received from the host.
+//!
+//! \param pucData is a pointer to the clip packet.
+//! \param ulLength is the number of bytes in the packet.
+//!
+//! Every packet is answered with a \b LINK_RPT_CLIP report.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClipCommand(const unsigned char *pucData, unsigned long ulLength)
+{
+    unsigned long ulCommand, ulOffset, ulRegion, ulIdx, ulCount;
+    const unsigned long *pulHeader;
+
+    if(ulLength == 0)
+    {
+        return;
+    }
+    ulCommand = pucData[0];
+    ulRegion = (unsigned long)_eclip - (unsigned long)_clip;
+
+    switch(ulCommand)
+    {
+        case CLIP_CMD_START:
+        {
+            //
+            // The first page holds the header, so erasing it forgets the
+            // stored clip.
+            //
+            g_ulClipWrite = 0;
+            g_ulClipErased = 0;
+            if(ClipErase(CLIP_HEADER_BYTES) != 0)
+            {
+                ClipReport(ulCommand, CLIP_STATUS_FLASH);
+                return;
+            }
+            break;
+        }
+
+        case CLIP_CMD_WRITE:
+        {
+            //
+            // Writes must follow one another, in whole words, after a start.
+            //
+            if((ulLength < 5) || !g_ulClipErased || ((ulLength - 5) & 3) ||
+               ((ulLength - 5) > CLIP_WRITE_BYTES))
+            {
+                ClipReport(ulCommand, CLIP_STATUS_ERROR);
+                return;
+            }
+            ulOffset = (pucData[1] | (pucData[2] << 8) | (pucData[3] << 16) |
+                        ((unsigned long)pucData[4] << 24));
+            ulLength -= 5;
+            if((ulOffset != g_ulClipWrite) ||
+               ((CLIP_HEADER_BYTES + ulOffset + ulLength) > ulRegion))
+            {
+                ClipReport(ulCommand, CLIP_STATUS_ERROR);
+                return;
+            }
+            if(ClipErase(CLIP_HEADER_BYTES + ulOffset + ulLength) != 0)
+            {
+                ClipReport(ulCommand, CLIP_STATUS_FLASH);
+                return;
+            }
+            for(pucData += 5; ulLength; ulLength -= ulCount)
+            {
+                ulCount = ((ulLength > CLIP_STAGE_BYTES) ? CLIP_STAGE_BYTES :
+                           ulLength);
+                for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+                {
+                    ((unsigned char *)g_pulClipStage)[ulIdx] = *pucData++;
+                }
+                if(FlashProgram(g_pulClipStage,
+                                ((unsigned long)_clip + CLIP_HEADER_BYTES +
+                                 g_ulClipWrite), ulCount) != 0)
+                {
+                    ClipReport(ulCommand, CLIP_STATUS_FLASH);
+                    return;
+                }
+                g_ulClipWrite += ulCount;
+            }
+            break;
+        }
+
+        case CLIP_CMD_END:
+        {
+            //
+            // The header goes in last, so a clip is only played once all of
+            // it is written.
+            //
+            if((ulLength != 5) || !g_ulClipErased)
+            {
+                ClipReport(ulCommand, CLIP_STATUS_ERROR);
+                return;
+            }
+            g_pulClipStage[0] = CLIP_MARKER;
+            g_pulClipStage[1] = g_ulClipWrite;
+            g_pulClipStage[2] = (pucData[1] | (pucData[2] << 8) |
+                                 (pucData[3] << 16) |
+                                 ((unsigned long)pucData[4] << 24));
+            g_pulClipStage[3] = 0;
+            if(FlashProgram(g_pulClipStage, (unsigned long)_clip,
+                            CLIP_HEADER_BYTES) != 0)
+            {
+                ClipReport(ulCommand, CLIP_STATUS_FLASH);
+                return;
+            }
+            g_ulClipErased = 0;
+            break;
+        }
+
+        case CLIP_CMD_PLAY:
+        {
+            pulHeader = ClipHeader();
+            if(!pulHeader)
+            {
+                ClipReport(ulCommand, CLIP_STATUS_ERROR);
+                return;
+            }
+            g_bClipPlaying = true;
+            g_ulClipRead = 0;
+            g_ulClipInterval = pulHeader[2] * (SysCtlClockGet() / 1000000);
+            g_ulClipDue = CycleCountGet();
+            break;
+        }
+
+        default:
+        {
+            ClipReport(ulCommand, CLIP_STATUS_ERROR);
+            return;
+        }
+    }
+
+    ClipReport(ulCommand, CLIP_STATUS_OK);
+}
+
+//*****************************************************************************
+//
+//! Stops playing the stored clip.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ClipStop(void)
+{
+    g_bClipPlaying = false;
+}
+
+//*****************************************************************************
+//
+//! Gets the next record of the clip being played.
+//!
+//! \param pucType is a pointer to the location to store the packet type.
+//! \param pulLength is a pointer to the location to store the payload length.
+//!
+//! Records that show a frame are returned once the frame interval has passed
+//! since the frame before; if playback falls behind by more than an interval
+//! the next frame is timed from when it is returned.
+//!
+//! \return Returns a pointer to the payload in flash, or 0 if no clip is
+//! playing or the next record is not yet due.
+//
+//*****************************************************************************
+const unsigned char *
+ClipNext(unsigned char *pucType, unsigned long *pulLength)
+{
+    const unsigned long *pulHeader;
+    const unsigned char *pucRecord;
+    unsigned long ulLength, ulNow;
+
+    if(!g_bClipPlaying)
+    {
+        return(0);
+    }
+    pulHeader = _clip;
+    if((g_ulClipRead + 4) > pulHeader[1])
+    {
+        g_ulClipRead = 0;
+    }
+    pucRecord = ((const unsigned char *)_clip + CLIP_HEADER_BYTES +
+                 g_ulClipRead);
+    ulLength = pucRecord[2] | (pucRecord[3] << 8);
+    if((g_ulClipRead + 4 + ulLength) > pulHeader[1])
+    {
+        g_bClipPlaying = false;
+        return(0);
+    }
+
+    if(pucRecord[1] & CLIP_RECORD_FRAME)
+    {
+        ulNow = CycleCountGet();
+        if((ulNow - g_ulClipDue) < g_ulClipInterval)
+        {
+            return(0);
+        }
+        g_ulClipDue += g_ulClipInterval;
+        if((ulNow - g_ulClipDue) >= g_ulClipInterval)
+        {
+            g_ulClipDue = ulNow;
+        }
+    }
+
+    g_ulClipRead += 4 + ((ulLength + 3) & ~3);
+    *pucType = pucRecord[0];
+    *pulLength = ulLength;
+    return(pucRecord + 4);
+}
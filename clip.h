@@ -0,0 +1,47 @@
+//*****************************************************************************
+//
+// clip.h - Clips stored in flash and played back without the host.
+//
+//*****************************************************************************
+
+#ifndef __CLIP_H__
+#define __CLIP_H__
+
+//*****************************************************************************
+//
+// Commands carried in the first byte of a clip packet.
+//
+//*****************************************************************************
+#define CLIP_CMD_START          0x01        // Forget the stored clip
+#define CLIP_CMD_WRITE          0x02        // offset, data
+#define CLIP_CMD_END            0x03        // frame interval in microseconds
+#define CLIP_CMD_PLAY           0x04        // Play the stored clip
+
+//*****************************************************************************
+//
+// Status codes in a clip report.
+//
+//*****************************************************************************
+#define CLIP_STATUS_OK          0           // Command done
+#define CLIP_STATUS_ERROR       1           // Malformed, out of order or full
+#define CLIP_STATUS_FLASH       2           // Erasing or programming failed
+
+//*****************************************************************************
+//
+// Flags carried in the second byte of a stored record.
+//
+//*****************************************************************************
+#define CLIP_RECORD_FRAME       0x01        // Shown at the frame interval
+
+//*****************************************************************************
+//
+// Prototypes for the clip APIs.
+//
+//*****************************************************************************
+extern void ClipInit(void);
+extern void ClipCommand(const unsigned char *pucData, unsigned long ulLength);
+extern void ClipStop(void);
+extern const unsigned char *ClipNext(unsigned char *pucType,
+                                     unsigned long *pulLength);
+
+#endif // __CLIP_H__
@@ -0,0 +1,112 @@
+#Stores a packet stream in the board's flash, from where the board plays it
+#in a loop without the host
+import time, sys, struct, argparse
+import serial
+import hostlink
+
+#Set serial baud rate
+baud = 1500000
+comPort = 'COM9'
+
+#Clip commands, report status codes and record flags, matching clip.h
+CMD_START = 0x01
+CMD_WRITE = 0x02
+CMD_END = 0x03
+CMD_PLAY = 0x04
+STATUS_OK = 0
+STATUS_NAMES = {1: 'rejected', 2: 'flash failed'}
+RECORD_FRAME = 0x01
+
+#Bytes of flash the board keeps for a clip, after its header
+REGION = 0x20000 - 16
+#Bytes sent in each write
+WRITE_BYTES = 1024
+#Seconds to wait for the board to answer a command; erasing flash stalls it
+TIMEOUT = 2.0
+
+#Packets that load tables or images rather than show a frame, so are not
+#held back to the frame interval
+TABLES = (hostlink.PKT_VQ_CODEBOOK, hostlink.PKT_HUFF_TABLE,
+          hostlink.PKT_SPRITE_IMAGE, hostlink.PKT_LAYOUT,
+          hostlink.PKT_CACHE_STORE)
+
+
+def records(stream):
+    """Flash records from a stream of type, length and payload records as
+    written by --dump: each payload is padded to a whole word and flagged if
+    it shows a frame"""
+    data = bytearray(stream)
+    out = bytearray()
+    pos = 0
+    while pos + 3 <= len(data):
+        ptype = data[pos]
+        length = data[pos + 1] | data[pos + 2] << 8
+        payload = data[pos + 3:pos + 3 + length]
+        pos += 3 + length
+        if len(payload) < length:
+            break
+        flags = 0 if ptype in TABLES else RECORD_FRAME
+        out += bytearray([ptype, flags, length & 0xFF, length >> 8]) + payload
+        out += bytearray(-length % 4)
+    return out
+
+
+class ClipWriter(object):
+    """Sends clip commands one at a time, each once the board has answered
+    the one before"""
+
+    def __init__(self, ser):
+        self.ser = ser
+        self.parser = hostlink.ReportParser()
+
+    def command(self, cmd, args=b''):
+        """Send a command and return the offset the board expects next"""
+        self.ser.write(hostlink.packet(hostlink.PKT_CLIP,
+                                       bytearray([cmd]) + bytearray(args)))
+        deadline = time.time() + TIMEOUT
+        while time.time() < deadline:
+            data = self.ser.read(max(1, self.ser.inWaiting()))
+            for rtype, payload in self.parser.feed(data):
+                payload = bytearray(payload)
+                if rtype != hostlink.RPT_CLIP or payload[0] != cmd:
+                    continue
+                if payload[1] != STATUS_OK:
+                    raise IOError('clip command %d %s' %
+                                  (cmd, STATUS_NAMES.get(payload[1], '?')))
+                return hostlink.le32(payload, 2)
+        raise IOError('no answer to clip command %d' % cmd)
+
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Store a clip in the flash of the LM3S6965 board')
+    parser.add_argument('stream', help='packets written by --dump of codecBench.py or a demo')
+    parser.add_argument('--port', default=comPort, help='serial port of the board')
+    parser.add_argument('--fps', type=float, default=30,
+                        help='frames per second to play at (default 30)')
+    parser.add_argument('--no-play', action='store_true',
+                        help='only store the clip; it still plays on the next reset')
+    args = parser.parse_args()
+
+    with open(args.stream, 'rb') as f:
+        clip = records(f.read())
+    if len(clip) > REGION:
+        sys.exit('Error: clip is %d bytes, the board keeps %d' % (len(clip), REGION))
+
+    try:
+        ser = serial.Serial(args.port, baud, timeout=0.05)
+        writer = ClipWriter(ser)
+        start = time.time()
+        writer.command(CMD_START)
+        offset = 0
+        while offset < len(clip):
+            chunk = clip[offset:offset + WRITE_BYTES]
+            offset = writer.command(CMD_WRITE, struct.pack('<I', offset) + chunk)
+        writer.command(CMD_END, struct.pack('<I', int(1e6 / args.fps)))
+        if not args.no_play:
+            writer.command(CMD_PLAY)
+        ser.close()
+    except serial.SerialException:
+        sys.exit('Error: Serial Error. Please check that the board is connected')
+    except IOError as e:
+        sys.exit('Error: ' + str(e))
+    print('Stored %d bytes in %.1f s' % (len(clip), time.time() - start))
@@ -0,0 +1,77 @@
+#Host-side benchmark of the frame encoders on a clip of pgm frames
+import os, sys, time, argparse
+import hostframe, hostlink
+from streamenc import StreamEncoder, CODECS
+from ratecontrol import RateController
+
+#Serial link rate and bits per byte on the wire (start, 8 data, stop)
+baud = 1500000
+BITS_PER_BYTE = 10
+
+parser = argparse.ArgumentParser(description='Measure encoder speed and output size')
+parser.add_argument('path', nargs='?', default='./imageConv',
+                    help='directory of 128x96 pgm frames (default ./imageConv)')
+parser.add_argument('--codec', choices=CODECS, action='append',
+                    help='codec to measure, may be repeated (default all)')
+parser.add_argument('--keyint', type=int, default=60,
+                    help='frames between raw keyframes')
+parser.add_argument('--refresh', action='store_true',
+                    help='refresh a band of every block frame rather than send keyframes')
+parser.add_argument('--scroll', action='store_true',
+                    help='send frames that are the last one moved up as scroll frames')
+parser.add_argument('--cache', action='store_true',
+                    help='keep frames that come round again on the device and show them from there')
+parser.add_argument('--fps', type=float,
+                    help='rate control the stream to this frame rate on the link')
+parser.add_argument('--dump', metavar='PREFIX',
+                    help='write each packet stream to PREFIX-<codec>.bin for '
+                    'bench/decbench')
+args = parser.parse_args()
+
+#Load and pack the whole clip up front so only encoding is timed
+frames = []
+for name in hostframe.list_frames(args.path):
+    pixels = hostframe.read_pgm(os.path.join(args.path, name))
+    if pixels is not None:
+        frames.append(hostframe.pack(pixels))
+if not frames:
+    sys.exit('Error: no frames found in ' + args.path)
+
+print('%d frames from %s' % (len(frames), args.path))
+print('%-6s %10s %10s %12s %6s %8s %10s' % ('codec', 'ms/frame', 'enc fps',
+                                            'bytes/frame', 'bpp', 'ratio',
+                                            'link fps'))
+for codec in args.codec or CODECS:
+    rate = RateController(args.fps, baud) if args.fps else None
+    encoder = StreamEncoder(codec, args.keyint, rate=rate, refresh=args.refresh,
+                            scroll=args.scroll, cache=args.cache)
+    #Codecs that prepare the whole clip up front report that time separately
+    start = time.time()
+    encoder.pretrain(frames)
+    trained = time.time() - start
+    if trained > 0.01:
+        print('%-6s trained in %.2f s' % (codec, trained))
+    total = 0
+    packets = []
+    start = time.time()
+    for frame in frames:
+        for ptype, payload in encoder.encode(frame):
+            total += len(hostlink.packet(ptype, payload))
+            packets.append((ptype, payload))
+    elapsed = time.time() - start
+    if args.dump:
+        hostlink.write_records('%s-%s.bin' % (args.dump, codec), packets)
+    average = float(total) / len(frames)
+    print('%-6s %10.2f %10.1f %12.0f %6.2f %7.2fx %10.1f' %
+          (codec, 1000.0 * elapsed / len(frames), len(frames) / elapsed,
+           average, 8 * average / (hostframe.WIDTH * hostframe.HEIGHT),
+           hostframe.FRAME_BYTES / average,
+           baud / (BITS_PER_BYTE * average)))
+    if encoder.chosen:
+        print('%-6s chose %s' % (codec, encoder.choices()))
+    if encoder.cache:
+        print('%-6s showed %d of %d frames from the cache, storing %d' %
+              (codec, encoder.frames.shown, len(frames), encoder.frames.stored))
+    if rate and rate.skipped:
+        print('%-6s skipped %d frames to stay within the link rate' %
+              (codec, rate.skipped))
@@ -0,0 +1,47 @@
+//*****************************************************************************
+//
+// cyclecount.h - Access to the Cortex-M3 DWT cycle counter.
+//
+// The DWT unit contains a free running 32-bit counter that increments once
+// per core clock.  At 50 MHz it wraps roughly every 85 seconds, so unsigned
+// differences between two readings are valid for any interval shorter than
+// that.
+//
+//*****************************************************************************
+
+#ifndef __CYCLECOUNT_H__
+#define __CYCLECOUNT_H__
+
+//*****************************************************************************
+//
+// Core debug and DWT registers used to run the cycle counter.
+//
+//*****************************************************************************
+#define NVIC_DBG_DEMCR          0xE000EDFC  // Debug Exception and Monitor Ctrl
+#define NVIC_DBG_DEMCR_TRCENA   0x01000000  // Enable DWT and ITM
+#define DWT_CTRL                0xE0001000  // DWT Control
+#define DWT_CTRL_CYCCNTENA      0x00000001  // Enable the cycle counter
+#define DWT_CYCCNT              0xE0001004  // DWT Cycle Count
+
+//*****************************************************************************
+//
+// Starts the cycle counter from zero.
+//
+//*****************************************************************************
+#define CycleCountInit()                                                      \
+    do                                                                        \
+    {                                                                         \
+        HWREG(NVIC_DBG_DEMCR) |= NVIC_DBG_DEMCR_TRCENA;                       \
+        HWREG(DWT_CYCCNT) = 0;                                                \
+        HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;                                \
+    }                                                                         \
+    while(0)
+
+//*****************************************************************************
+//
+// Returns the current value of the cycle counter.
+//
+//*****************************************************************************
+#define CycleCountGet()         (HWREG(DWT_CYCCNT))
+
+#endif // __CYCLECOUNT_H__
@@ -0,0 +1,127 @@
+//*****************************************************************************
+//
+// depthcodec.c - Decoder for reduced bit depth frames.
+//
+// Text and line art need only a few grey levels, so a frame can be sent with
+// one or two bits per pixel, 1536 or 3072 bytes instead of 6144:
+//
+//   byte 0         bits per pixel, 1 or 2
+//   bytes 1-2      palette of four 4-bit grey levels, first in the high
+//                  nibble of byte 1
+//   rest           pixels in frame order, leftmost in the most significant
+//                  bits of each byte, each an index into the palette
+//
+// Each byte of pixels is expanded to the 4bpp frame layout with a single
+// table lookup, by the row kernels from rowkernel.h.  The table is rebuilt
+// only when the depth or palette changes.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include "video.h"
+#include "depthcodec.h"
+#include "rowkernel.h"
+
+//*****************************************************************************
+//
+// The expansion table: the 4bpp bytes for each input byte, as stored in the
+// frame slot read as a little endian word.  Two bit frames use only the low
+// half word of each entry.
+//
+//*****************************************************************************
+static uint32_t g_pulDepthExpand[256];
+
+//*****************************************************************************
+//
+// The table builders and kernels for each depth.
+//
+//*****************************************************************************
+ROW_KERNEL_TABLE(DepthTable1, 1, 1)
+ROW_KERNEL_TABLE(DepthTable2, 2, 1)
+ROW_KERNEL(DepthExpand1, 1, 1, COPY)
+ROW_KERNEL(DepthExpand2, 2, 1, COPY)
+
+//*****************************************************************************
+//
+// The depth and palette the table was built for; zero depth until one has
+// been built.
+//
+//*****************************************************************************
+static unsigned long g_ulDepthBits;
+static unsigned long g_ulDepthPalette;
+
+//*****************************************************************************
+//
+// Builds the expansion table for a depth and palette.
+//
+//*****************************************************************************
+static void
+DepthTableBuild(unsigned long ulBits, const unsigned char *pucPalette)
+{
+    unsigned char pucLevel[DEPTH_PALETTE_SIZE];
+
+    pucLevel[0] = pucPalette[0] >> 4;
+    pucLevel[1] = pucPalette[0] & 0xF;
+    pucLevel[2] = pucPalette[1] >> 4;
+    pucLevel[3] = pucPalette[1] & 0xF;
+    if(ulBits == 1)
+    {
+        DepthTable1(g_pulDepthExpand, pucLevel);
+    }
+    else
+    {
+        DepthTable2(g_pulDepthExpand, pucLevel);
+    }
+
+    g_ulDepthBits = ulBits;
+    g_ulDepthPalette = (pucPalette[0] << 8) | pucPalette[1];
+}
+
+//*****************************************************************************
+//
+//! Decodes a reduced depth frame.
+//!
+//! \param pucData is a pointer to the encoded frame.
+//! \param ulLength is the number of bytes of encoded data.
+//! \param pucFrame is the frame slot to decode into; it must be word aligned.
+//!
+//! \return Returns 0 on success or -1 if the encoded data is malformed.
+//
+//*****************************************************************************
+long
+DepthDecode(const unsigned char *pucData, unsigned long ulLength,
+            unsigned char *pucFrame)
+{
+    unsigned long ulBits;
+
+    if(ulLength < DEPTH_HEADER_BYTES)
+    {
+        return(-1);
+    }
+    ulBits = pucData[0];
+    if(((ulBits != 1) && (ulBits != 2)) ||
+       (ulLength != (DEPTH_HEADER_BYTES + ((FRAME_BYTES * ulBits) / 4))))
+    {
+        return(-1);
+    }
+
+    if((ulBits != g_ulDepthBits) ||
+       ((unsigned long)((pucData[1] << 8) | pucData[2]) != g_ulDepthPalette))
+    {
+        DepthTableBuild(ulBits, pucData + 1);
+    }
+    pucData += DEPTH_HEADER_BYTES;
+
+    if(ulBits == 1)
+    {
+        DepthExpand1((uint32_t *)pucFrame, pucData, g_pulDepthExpand,
+                     FRAME_BYTES / 4);
+    }
+    else
+    {
+        DepthExpand2((uint32_t *)pucFrame, pucData, g_pulDepthExpand,
+                     FRAME_BYTES / 4);
+    }
+
+    return(0);
+}
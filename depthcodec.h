@@ -0,0 +1,28 @@
+//*****************************************************************************
+//
+// depthcodec.h - Decoder for reduced bit depth frames.
+//
+//*****************************************************************************
+
+#ifndef __DEPTHCODEC_H__
+#define __DEPTHCODEC_H__
+
+//*****************************************************************************
+//
+// The header of a reduced depth frame: the bits per pixel, 1 or 2, and a
+// palette of four grey levels, two per byte with the first in the high
+// nibble.  One bit frames use only the first two levels.
+//
+//*****************************************************************************
+#define DEPTH_HEADER_BYTES      3
+#define DEPTH_PALETTE_SIZE      4
+
+//*****************************************************************************
+//
+// Prototypes for the reduced depth codec APIs.
+//
+//*****************************************************************************
+extern long DepthDecode(const unsigned char *pucData, unsigned long ulLength,
+                        unsigned char *pucFrame);
+
+#endif // __DEPTHCODEC_H__
@@ -0,0 +1,93 @@
+#Encoder for the reduced bit depth frames decoded by depthcodec.c on the
+#device
+from hostframe import FRAME_BYTES
+
+#Frame header and palette, matching depthcodec.h
+HEADER_BYTES = 3
+PALETTE_SIZE = 4
+
+#Refinement passes when choosing grey levels
+ITERATIONS = 8
+#Relative increase in error accepted to keep the previous palette, which
+#saves the device rebuilding its expansion table
+KEEP_PALETTE = 1.05
+
+
+def histogram(frame):
+    """Count of each 4-bit grey level in a packed frame"""
+    counts = [0] * 16
+    for b in bytearray(frame):
+        counts[b >> 4] += 1
+        counts[b & 0xF] += 1
+    return counts
+
+
+def nearest(levels):
+    """Palette index closest to each of the 16 grey levels"""
+    return [min(range(len(levels)), key=lambda i: abs(levels[i] - v))
+            for v in range(16)]
+
+
+def error(counts, levels):
+    """Squared error of showing a histogram with a palette"""
+    index = nearest(levels)
+    return sum(c * (v - levels[index[v]]) ** 2 for v, c in enumerate(counts))
+
+
+def choose_levels(counts, size):
+    """Grey levels minimising the squared error for a histogram, most common
+    first so that the background of text is sent as zero bits"""
+    used = [v for v in range(16) if counts[v]]
+    if len(used) <= size:
+        levels = used + [0] * (size - len(used))
+    else:
+        #Start evenly spread over the levels in use and refine
+        levels = [used[0] + (used[-1] - used[0]) * i / (size - 1.0)
+                  for i in range(size)]
+        for n in range(ITERATIONS):
+            index = nearest(levels)
+            for i in range(size):
+                weight = sum(counts[v] for v in range(16) if index[v] == i)
+                if weight:
+                    levels[i] = (sum(v * counts[v] for v in range(16)
+                                     if index[v] == i) / float(weight))
+        levels = [int(round(l)) for l in levels]
+    index = nearest(levels)
+    use = [sum(counts[v] for v in range(16) if index[v] == i)
+           for i in range(size)]
+    return [l for u, l in sorted(zip(use, levels), key=lambda p: -p[0])]
+
+
+class DepthEncoder(object):
+    """Sends frames with 1 or 2 bits per pixel and a palette of grey levels"""
+
+    def __init__(self, bits=2):
+        self.bits = bits
+        self.levels = None
+
+    def encode(self, frame):
+        """Encode a frame, returning the payload and the frame the device will
+        show"""
+        counts = histogram(frame)
+        levels = choose_levels(counts, 1 << self.bits)
+        if (self.levels is None or error(counts, self.levels) >
+                KEEP_PALETTE * error(counts, levels)):
+            self.levels = levels
+        levels = self.levels + [0] * (PALETTE_SIZE - len(self.levels))
+        index = nearest(self.levels)
+        per_byte = 8 // self.bits
+        payload = bytearray([self.bits, levels[0] << 4 | levels[1],
+                             levels[2] << 4 | levels[3]])
+        recon = bytearray()
+        pixels = []
+        for b in bytearray(frame):
+            pixels.append(index[b >> 4])
+            pixels.append(index[b & 0xF])
+        for i in range(0, len(pixels), per_byte):
+            value = 0
+            for p in pixels[i:i + per_byte]:
+                value = value << self.bits | p
+            payload.append(value)
+        for i in range(0, len(pixels), 2):
+            recon.append(levels[pixels[i]] << 4 | levels[pixels[i + 1]])
+        return payload, recon
@@ -0,0 +1,128 @@
+#Dashboard demo of draw packets: a dial and a bar graph updated by sending
+#the drawing commands that change them rather than the frames
+import math, sys, argparse
+import serial
+import hostframe, hostlink, drawcmd
+
+#Set serial baud rate
+baud = 1500000
+comPort = 'COM9'
+
+parser = argparse.ArgumentParser(description='Animate a dashboard on the LM3S6965 OLED display')
+parser.add_argument('--port', default=comPort, help='serial port of the board')
+parser.add_argument('--fps', type=float, default=30,
+                    help='updates per second (default 30)')
+parser.add_argument('--frames', type=int, default=0,
+                    help='updates to send, 0 to run until interrupted')
+parser.add_argument('--dump', metavar='FILE',
+                    help='write the packets to FILE for bench/decbench rather '
+                    'than send them')
+args = parser.parse_args()
+
+#Dial centre and needle length, bar graph position and size
+DIAL_X, DIAL_Y, NEEDLE = 40, 56, 30
+BAR_X, BAR_Y, BAR_W, BAR_H = 88, 16, 24, 72
+#Grey levels of the background, the markings and the live parts
+BACK, MARK, LIVE = 0, 6, 15
+#Bitmap slot of the tick mark icon
+TICK = 0
+
+
+def tick_icon():
+    """An 8x8 diamond used for the dial's tick marks"""
+    pixels = []
+    for y in range(drawcmd.BITMAP_SIZE):
+        for x in range(drawcmd.BITMAP_SIZE):
+            d = abs(2 * x - 7) + abs(2 * y - 7)
+            pixels.append(MARK if d <= 6 else BACK)
+    return pixels
+
+
+def needle_end(value):
+    """End of the needle for a value from 0 to 1, over a half turn"""
+    angle = math.pi * (1 - value)
+    return (int(round(DIAL_X + NEEDLE * math.cos(angle))),
+            int(round(DIAL_Y - NEEDLE * math.sin(angle))))
+
+
+class Dashboard(object):
+    """Sends the layout once and then only what changes between updates.
+    Stands in for the stream encoder of the report reader: a rejected packet
+    makes it send the layout again."""
+
+    def __init__(self):
+        self.want_layout = True
+        self.needle = None
+        self.bar = 0
+
+    def request_keyframe(self):
+        self.want_layout = True
+
+    def decoded(self, ptype, length, cycles):
+        pass
+
+    def update(self, value):
+        """Return the (type, payload) packets that show a value from 0 to 1"""
+        packets = []
+        draw = drawcmd.DrawList(reset=self.want_layout)
+        if self.want_layout:
+            #A blank frame gives the device a reference to draw over
+            packets.append((hostlink.PKT_RAW, hostframe.black()))
+            draw.load(TICK, tick_icon())
+            for i in range(5):
+                x, y = needle_end(i / 4.0)
+                draw.blit(x + (x - DIAL_X) // 6 - 4, y + (y - DIAL_Y) // 6 - 4,
+                          TICK)
+            draw.hline(DIAL_X - NEEDLE - 4, DIAL_Y + 2, 2 * NEEDLE + 8, MARK)
+            draw.hline(BAR_X - 2, BAR_Y - 2, BAR_W + 4, MARK)
+            draw.hline(BAR_X - 2, BAR_Y + BAR_H + 1, BAR_W + 4, MARK)
+            draw.vline(BAR_X - 2, BAR_Y - 2, BAR_H + 4, MARK)
+            draw.vline(BAR_X + BAR_W + 1, BAR_Y - 2, BAR_H + 4, MARK)
+            self.want_layout = False
+            self.needle = None
+            self.bar = 0
+        #Move the needle by drawing over the old one in the background level
+        end = needle_end(value)
+        if end != self.needle:
+            if self.needle:
+                draw.line(DIAL_X, DIAL_Y, self.needle[0], self.needle[1], BACK)
+            draw.line(DIAL_X, DIAL_Y, end[0], end[1], LIVE)
+            self.needle = end
+        #Grow or shrink the bar by the difference only
+        bar = int(round(value * BAR_H))
+        if bar > self.bar:
+            draw.fill(BAR_X, BAR_Y + BAR_H - bar, BAR_W, bar - self.bar, LIVE)
+        elif bar < self.bar:
+            draw.fill(BAR_X, BAR_Y + BAR_H - self.bar, BAR_W, self.bar - bar,
+                      BACK)
+        self.bar = bar
+        if len(draw.payload) > 1:
+            packets.append((hostlink.PKT_DRAW, draw.payload))
+        return packets
+
+
+dashboard = Dashboard()
+
+
+def packets(n):
+    """The packets of update n, which sweeps the value back and forth"""
+    return dashboard.update(0.5 + 0.5 * math.sin(n * 0.05))
+
+
+if args.dump:
+    hostlink.write_records(args.dump, [packet for n in range(args.frames or 300)
+                                       for packet in packets(n)])
+    sys.exit(0)
+
+try:
+    ser = serial.Serial(args.port, baud)
+    stats, sent, n = hostlink.stream(ser, packets, args.fps, dashboard,
+                                     args.frames)
+except KeyboardInterrupt:
+    sys.exit(0)
+except serial.SerialException:
+    sys.exit('Error: Serial Error. Please check that the board is connected')
+
+if stats.types:
+    print(stats.summary())
+print('Sent %d bytes, %.1f bytes/update' % (sent, float(sent) / max(n, 1)))
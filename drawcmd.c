@@ -0,0 +1,364 @@
+//*****************************************************************************
+//
+// drawcmd.c - Renderer for streams of drawing commands.
+//
+// Dashboards and other synthetic displays change a few shapes at a time, so
+// rather than pixels the host can send the drawing commands that produce
+// them.  A draw packet is
+//
+//   byte 0        flags (DRAW_FLAG_*)
+//   rest          drawing commands (DRAW_CMD_*), each a command byte and
+//                 its arguments
+//
+// The commands are drawn over a copy of the previous frame, and only the
+// cells they touch are marked for redrawing, so an update of a needle or a
+// bar is a few tens of bytes on the link and a few small windows on the
+// display.  Shapes are clipped to the frame.
+//
+// Bitmaps loaded with DRAW_CMD_LOAD stay cached for later packets to blit.
+// As with the tile cache, the host decides which bitmap lives in which slot.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <string.h>
+#include "video.h"
+#include "drawcmd.h"
+
+//*****************************************************************************
+//
+// The bytes of arguments that follow each command.
+//
+//*****************************************************************************
+static const unsigned char g_pucDrawArgs[] =
+{
+    0,                                      // Not a command
+    5,                                      // DRAW_CMD_FILL
+    4,                                      // DRAW_CMD_HLINE
+    4,                                      // DRAW_CMD_VLINE
+    5,                                      // DRAW_CMD_LINE
+    3,                                      // DRAW_CMD_BLIT
+    1 + DRAW_BITMAP_BYTES                   // DRAW_CMD_LOAD
+};
+
+//*****************************************************************************
+//
+// The bitmap cache.
+//
+//*****************************************************************************
+static unsigned char g_ppucDrawBitmap[DRAW_BITMAP_COUNT][DRAW_BITMAP_BYTES];
+
+//*****************************************************************************
+//
+// Marks the cells covering a rectangle of pixels, given by its inclusive
+// corners, as dirty.
+//
+//*****************************************************************************
+static void
+DrawMark(unsigned short *pusDirty, unsigned long ulX0, unsigned long ulY0,
+         unsigned long ulX1, unsigned long ulY1)
+{
+    unsigned long ulBand;
+    unsigned short usMask;
+
+    usMask = (((2 << (ulX1 / VIDEO_CELL_SIZE)) - 1) &
+              ~((1 << (ulX0 / VIDEO_CELL_SIZE)) - 1));
+    for(ulBand = ulY0 / VIDEO_CELL_SIZE; ulBand <= ulY1 / VIDEO_CELL_SIZE;
+        ulBand++)
+    {
+        pusDirty[ulBand] |= usMask;
+    }
+}
+
+//*****************************************************************************
+//
+// Sets one pixel, if it lies in the frame.
+//
+//*****************************************************************************
+static void
+DrawPixel(unsigned char *pucFrame, unsigned short *pusDirty, long lX,
+          long lY, unsigned long ulLevel)
+{
+    unsigned char *pucByte;
+
+    if((lX < 0) || (lX >= FRAME_WIDTH) || (lY < 0) || (lY >= FRAME_HEIGHT))
+    {
+        return;
+    }
+    pucByte = pucFrame + (lY * FRAME_STRIDE) + (lX / 2);
+    if(lX & 1)
+    {
+        *pucByte = (*pucByte & 0xF0) | ulLevel;
+    }
+    else
+    {
+        *pucByte = (*pucByte & 0x0F) | (ulLevel << 4);
+    }
+    pusDirty[lY / VIDEO_CELL_SIZE] |= 1 << (lX / VIDEO_CELL_SIZE);
+}
+
+//*****************************************************************************
+//
+// Fills a rectangle, clipped to the frame.
+//
+//*****************************************************************************
+static void
+DrawFill(unsigned char *pucFrame, unsigned short *pusDirty, unsigned long ulX,
+         unsigned long ulY, unsigned long ulWidth, unsigned long ulHeight,
+         unsigned long ulLevel)
+{
+    unsigned char *pucRow;
+    unsigned long ulStart, ulEnd, ulRow;
+
+    if((ulX >= FRAME_WIDTH) || (ulY >= FRAME_HEIGHT) || !ulWidth ||
+       !ulHeight)
+    {
+        return;
+    }
+    if((ulX + ulWidth) > FRAME_WIDTH)
+    {
+        ulWidth = FRAME_WIDTH - ulX;
+    }
+    if((ulY + ulHeight) > FRAME_HEIGHT)
+    {
+        ulHeight = FRAME_HEIGHT - ulY;
+    }
+    DrawMark(pusDirty, ulX, ulY, ulX + ulWidth - 1, ulY + ulHeight - 1);
+
+    //
+    // A pixel at an odd start or an even end shares its byte with a pixel
+    // outside the rectangle; the bytes in between are filled whole.
+    //
+    ulStart = (ulX + 1) / 2;
+    ulEnd = (ulX + ulWidth) / 2;
+    for(ulRow = 0; ulRow < ulHeight; ulRow++)
+    {
+        pucRow = pucFrame + ((ulY + ulRow) * FRAME_STRIDE);
+        if(ulX & 1)
+        {
+            pucRow[ulX / 2] = (pucRow[ulX / 2] & 0xF0) | ulLevel;
+        }
+        if(ulEnd > ulStart)
+        {
+            memset(pucRow + ulStart, ulLevel * 0x11, ulEnd - ulStart);
+        }
+        if((ulX + ulWidth) & 1)
+        {
+            pucRow[ulEnd] = (pucRow[ulEnd] & 0x0F) | (ulLevel << 4);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Draws a line between two points with Bresenham's algorithm.
+//
+//*****************************************************************************
+static void
+DrawLine(unsigned char *pucFrame, unsigned short *pusDirty, long lX0,
+         long lY0, long lX1, long lY1, unsigned long ulLevel)
+{
+    long lDX, lDY, lStepX, lStepY, lError, lDouble;
+
+    lDX = (lX1 > lX0) ? (lX1 - lX0) : (lX0 - lX1);
+    lDY = (lY1 > lY0) ? (lY0 - lY1) : (lY1 - lY0);
+    lStepX = (lX0 < lX1) ? 1 : -1;
+    lStepY = (lY0 < lY1) ? 1 : -1;
+    lError = lDX + lDY;
+
+    while(1)
+    {
+        DrawPixel(pucFrame, pusDirty, lX0, lY0, ulLevel);
+        if((lX0 == lX1) && (lY0 == lY1))
+        {
+            break;
+        }
+        lDouble = 2 * lError;
+        if(lDouble >= lDY)
+        {
+            lError += lDY;
+            lX0 += lStepX;
+        }
+        if(lDouble <= lDX)
+        {
+            lError += lDX;
+            lY0 += lStepY;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Copies a cached bitmap into the frame, clipped to the frame.
+//
+//*****************************************************************************
+static void
+DrawBlit(unsigned char *pucFrame, unsigned short *pusDirty, unsigned long ulX,
+         unsigned long ulY, const unsigned char *pucBitmap)
+{
+    unsigned long ulRow, ulCol, ulPixel;
+
+    if((ulX >= FRAME_WIDTH) || (ulY >= FRAME_HEIGHT))
+    {
+        return;
+    }
+
+    //
+    // Bitmaps on an even column that fit in the frame are copied a row of
+    // bytes at a time; any others a pixel at a time.
+    //
+    if(!(ulX & 1) && ((ulX + DRAW_BITMAP_SIZE) <= FRAME_WIDTH) &&
+       ((ulY + DRAW_BITMAP_SIZE) <= FRAME_HEIGHT))
+    {
+        for(ulRow = 0; ulRow < DRAW_BITMAP_SIZE; ulRow++)
+        {
+            memcpy(pucFrame + ((ulY + ulRow) * FRAME_STRIDE) + (ulX / 2),
+                   pucBitmap + (ulRow * (DRAW_BITMAP_SIZE / 2)),
+                   DRAW_BITMAP_SIZE / 2);
+        }
+        DrawMark(pusDirty, ulX, ulY, ulX + DRAW_BITMAP_SIZE - 1,
+                 ulY + DRAW_BITMAP_SIZE - 1);
+        return;
+    }
+
+    for(ulRow = 0; ulRow < DRAW_BITMAP_SIZE; ulRow++)
+    {
+        for(ulCol = 0; ulCol < DRAW_BITMAP_SIZE; ulCol++)
+        {
+            ulPixel = pucBitmap[(ulRow * (DRAW_BITMAP_SIZE / 2)) +
+                                (ulCol / 2)];
+            ulPixel = (ulCol & 1) ? (ulPixel & 0xF) : (ulPixel >> 4);
+            DrawPixel(pucFrame, pusDirty, ulX + ulCol, ulY + ulRow, ulPixel);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Draws the commands of a draw packet.
+//!
+//! \param pucData is a pointer to the draw packet.
+//! \param ulLength is the number of bytes in the packet.
+//! \param pucFrame is the frame to draw over; it must already hold the
+//! previous frame.
+//! \param pusDirty is an array of \b VIDEO_BANDS masks; the bit for every
+//! cell a command touched is set.
+//! \param pulCached is set to the number of blits from bitmaps that were not
+//! loaded by this packet, which are only right if the bitmap cache is.
+//!
+//! Commands are drawn in order, so a later command draws over an earlier one
+//! and a bitmap may be blitted by the packet that loads it.
+//!
+//! \return Returns 0 on success or -1 if the packet is malformed.
+//
+//*****************************************************************************
+long
+DrawDecode(const unsigned char *pucData, unsigned long ulLength,
+           unsigned char *pucFrame, unsigned short *pusDirty,
+           unsigned long *pulCached)
+{
+    uint32_t pulLoaded[DRAW_BITMAP_COUNT / 32];
+    unsigned long ulCmd, ulBitmap;
+    const unsigned char *pucArg;
+
+    *pulCached = 0;
+    if(ulLength == 0)
+    {
+        return(-1);
+    }
+    memset(pulLoaded, 0, sizeof(pulLoaded));
+
+    ulLength--;
+    pucData++;
+    while(ulLength)
+    {
+        ulCmd = pucData[0];
+        if((ulCmd == 0) || (ulCmd > DRAW_CMD_LOAD) ||
+           (ulLength < (1UL + g_pucDrawArgs[ulCmd])))
+        {
+            return(-1);
+        }
+        pucArg = pucData + 1;
+        pucData += 1 + g_pucDrawArgs[ulCmd];
+        ulLength -= 1 + g_pucDrawArgs[ulCmd];
+
+        switch(ulCmd)
+        {
+            case DRAW_CMD_FILL:
+            {
+                if(pucArg[4] > 15)
+                {
+                    return(-1);
+                }
+                DrawFill(pucFrame, pusDirty, pucArg[0], pucArg[1], pucArg[2],
+                         pucArg[3], pucArg[4]);
+                break;
+            }
+
+            case DRAW_CMD_HLINE:
+            {
+                if(pucArg[3] > 15)
+                {
+                    return(-1);
+                }
+                DrawFill(pucFrame, pusDirty, pucArg[0], pucArg[1], pucArg[2],
+                         1, pucArg[3]);
+                break;
+            }
+
+            case DRAW_CMD_VLINE:
+            {
+                if(pucArg[3] > 15)
+                {
+                    return(-1);
+                }
+                DrawFill(pucFrame, pusDirty, pucArg[0], pucArg[1], 1,
+                         pucArg[2], pucArg[3]);
+                break;
+            }
+
+            case DRAW_CMD_LINE:
+            {
+                if(pucArg[4] > 15)
+                {
+                    return(-1);
+                }
+                DrawLine(pucFrame, pusDirty, pucArg[0], pucArg[1], pucArg[2],
+                         pucArg[3], pucArg[4]);
+                break;
+            }
+
+            case DRAW_CMD_BLIT:
+            {
+                ulBitmap = pucArg[2];
+                if(ulBitmap >= DRAW_BITMAP_COUNT)
+                {
+                    return(-1);
+                }
+                if(!(pulLoaded[ulBitmap / 32] &
+                     ((uint32_t)1 << (ulBitmap % 32))))
+                {
+                    (*pulCached)++;
+                }
+                DrawBlit(pucFrame, pusDirty, pucArg[0], pucArg[1],
+                         g_ppucDrawBitmap[ulBitmap]);
+                break;
+            }
+
+            case DRAW_CMD_LOAD:
+            {
+                ulBitmap = pucArg[0];
+                if(ulBitmap >= DRAW_BITMAP_COUNT)
+                {
+                    return(-1);
+                }
+                memcpy(g_ppucDrawBitmap[ulBitmap], pucArg + 1,
+                       DRAW_BITMAP_BYTES);
+                pulLoaded[ulBitmap / 32] |= (uint32_t)1 << (ulBitmap % 32);
+                break;
+            }
+        }
+    }
+
+    return(0);
+}
@@ -0,0 +1,49 @@
+//*****************************************************************************
+//
+// drawcmd.h - Renderer for streams of drawing commands.
+//
+//*****************************************************************************
+
+#ifndef __DRAWCMD_H__
+#define __DRAWCMD_H__
+
+//*****************************************************************************
+//
+// Flags carried in the first byte of a draw packet.
+//
+//*****************************************************************************
+#define DRAW_FLAG_RESET         0x01        // Every bitmap used is loaded
+
+//*****************************************************************************
+//
+// Drawing commands.  Each is the command byte followed by its arguments, one
+// byte each; coordinates are in pixels and levels are 4-bit grey levels.
+//
+//*****************************************************************************
+#define DRAW_CMD_FILL           0x01        // x, y, width, height, level
+#define DRAW_CMD_HLINE          0x02        // x, y, width, level
+#define DRAW_CMD_VLINE          0x03        // x, y, height, level
+#define DRAW_CMD_LINE           0x04        // x0, y0, x1, y1, level
+#define DRAW_CMD_BLIT           0x05        // x, y, bitmap
+#define DRAW_CMD_LOAD           0x06        // bitmap, 32 bytes of pixels
+
+//*****************************************************************************
+//
+// Cached bitmaps.  A bitmap is 8x8 pixels stored as eight rows of four bytes,
+// laid out as in a frame.
+//
+//*****************************************************************************
+#define DRAW_BITMAP_SIZE        8
+#define DRAW_BITMAP_BYTES       (DRAW_BITMAP_SIZE * DRAW_BITMAP_SIZE / 2)
+#define DRAW_BITMAP_COUNT       64
+
+//*****************************************************************************
+//
+// Prototypes for the draw command APIs.
+//
+//*****************************************************************************
+extern long DrawDecode(const unsigned char *pucData, unsigned long ulLength,
+                       unsigned char *pucFrame, unsigned short *pusDirty,
+                       unsigned long *pulCached);
+
+#endif // __DRAWCMD_H__
@@ -0,0 +1,120 @@
+#Draw packets: drawing commands the device renders over the frame it is
+#showing, matching drawcmd.h on the device
+from hostframe import WIDTH, HEIGHT, STRIDE
+
+#Flags in the first byte of a draw packet
+FLAG_RESET = 0x01
+
+#Drawing commands
+CMD_FILL = 0x01
+CMD_HLINE = 0x02
+CMD_VLINE = 0x03
+CMD_LINE = 0x04
+CMD_BLIT = 0x05
+CMD_LOAD = 0x06
+
+#Cached bitmaps: 8x8 pixels, four bytes a row packed as in a frame
+BITMAP_SIZE = 8
+BITMAP_BYTES = BITMAP_SIZE * BITMAP_SIZE // 2
+BITMAP_COUNT = 64
+
+
+class DrawList(object):
+    """Builds the payload of one draw packet.  With reset set the packet
+    loads every bitmap it blits, which makes the device's bitmap cache valid
+    again after it was lost."""
+
+    def __init__(self, reset=False):
+        self.payload = bytearray([FLAG_RESET if reset else 0])
+
+    def fill(self, x, y, width, height, level):
+        self.payload += bytearray([CMD_FILL, x, y, width, height, level])
+
+    def hline(self, x, y, width, level):
+        self.payload += bytearray([CMD_HLINE, x, y, width, level])
+
+    def vline(self, x, y, height, level):
+        self.payload += bytearray([CMD_VLINE, x, y, height, level])
+
+    def line(self, x0, y0, x1, y1, level):
+        self.payload += bytearray([CMD_LINE, x0, y0, x1, y1, level])
+
+    def blit(self, x, y, bitmap):
+        self.payload += bytearray([CMD_BLIT, x, y, bitmap])
+
+    def load(self, bitmap, pixels):
+        """Load a bitmap from 64 4-bit levels in rows"""
+        self.payload += bytearray([CMD_LOAD, bitmap])
+        self.payload += bytearray(pixels[i] << 4 | pixels[i + 1]
+                                  for i in range(0, len(pixels), 2))
+
+
+def _set(frame, x, y, level):
+    if 0 <= x < WIDTH and 0 <= y < HEIGHT:
+        i = y * STRIDE + x // 2
+        if x & 1:
+            frame[i] = (frame[i] & 0xF0) | level
+        else:
+            frame[i] = (frame[i] & 0x0F) | level << 4
+
+
+def _fill(frame, x, y, width, height, level):
+    for row in range(y, min(y + height, HEIGHT)):
+        for col in range(x, min(x + width, WIDTH)):
+            _set(frame, col, row, level)
+
+
+def _line(frame, x0, y0, x1, y1, level):
+    dx = abs(x1 - x0)
+    dy = -abs(y1 - y0)
+    sx = 1 if x0 < x1 else -1
+    sy = 1 if y0 < y1 else -1
+    err = dx + dy
+    while 1:
+        _set(frame, x0, y0, level)
+        if x0 == x1 and y0 == y1:
+            break
+        e2 = 2 * err
+        if e2 >= dy:
+            err += dy
+            x0 += sx
+        if e2 <= dx:
+            err += dx
+            y0 += sy
+
+
+def render(payload, frame, bitmaps):
+    """Draw a draw packet over a packed frame as the device does, updating
+    the list of cached bitmaps, and return the new frame"""
+    frame = bytearray(frame)
+    data = bytearray(payload)
+    pos = 1
+    while pos < len(data):
+        cmd = data[pos]
+        a = data[pos + 1:]
+        if cmd == CMD_FILL:
+            _fill(frame, a[0], a[1], a[2], a[3], a[4])
+            pos += 6
+        elif cmd == CMD_HLINE:
+            _fill(frame, a[0], a[1], a[2], 1, a[3])
+            pos += 5
+        elif cmd == CMD_VLINE:
+            _fill(frame, a[0], a[1], 1, a[2], a[3])
+            pos += 5
+        elif cmd == CMD_LINE:
+            _line(frame, a[0], a[1], a[2], a[3], a[4])
+            pos += 6
+        elif cmd == CMD_BLIT:
+            bitmap = bitmaps[a[2]]
+            for row in range(BITMAP_SIZE):
+                for col in range(BITMAP_SIZE):
+                    b = bitmap[row * BITMAP_SIZE // 2 + col // 2]
+                    _set(frame, a[0] + col, a[1] + row,
+                         b & 0xF if col & 1 else b >> 4)
+            pos += 4
+        elif cmd == CMD_LOAD:
+            bitmaps[a[0]] = bytearray(a[1:1 + BITMAP_BYTES])
+            pos += 2 + BITMAP_BYTES
+        else:
+            raise ValueError('bad draw command 0x%02x' % cmd)
+    return frame
@@ -0,0 +1,26 @@
+#Encoder for the interlaced fields that the device merges with the other
+#field of the frame it is showing
+from hostframe import FRAME_BYTES, STRIDE, HEIGHT
+
+#First byte of a field packet, matching video.h
+FIELD_ODD = 0x01
+
+
+class FieldEncoder(object):
+    """Sends the even and odd rows of successive frames in turn"""
+
+    def __init__(self):
+        self.parity = 0
+
+    def encode(self, frame, ref):
+        """Return the field packet for the next field of a packed frame and the
+        frame the device shows after it, keeping the other field from ref"""
+        data = bytearray(frame)
+        shown = bytearray(ref) if ref is not None else bytearray(FRAME_BYTES)
+        payload = bytearray([self.parity])
+        for row in range(self.parity, HEIGHT, 2):
+            line = data[row * STRIDE:(row + 1) * STRIDE]
+            payload += line
+            shown[row * STRIDE:(row + 1) * STRIDE] = line
+        self.parity ^= FIELD_ODD
+        return payload, shown
@@ -0,0 +1,342 @@
+//*****************************************************************************
+//
+// framecache.c - Cache of whole frames kept for the host to show again.
+//
+// Spinners, idle animations and slide shows show the same frames over and
+// over.  The host can ask for the frame on display to be kept under an id it
+// chooses, and later show it again with a two byte packet rather than
+// sending it.  Frames are packed with PackBits run length coding, which
+// flat synthetic content shrinks well under, so several fit in the SRAM the
+// rest of the firmware leaves free.  A header byte n below 128 is followed by
+// n + 1 bytes copied as they are; a header byte n of 129 or more by one byte
+// repeated 257 - n times.
+//
+// When a new frame does not fit, the least recently stored or shown frames
+// are dropped until it does.  The host keeps a mirror of the cache, packing
+// frames the same way to know their sizes, so it knows which ids are still
+// held without asking.
+//
+// Counters of the frames shown from the cache and of those asked for but not
+// held are sent to the host in a LINK_RPT_CACHE report after every cache
+// packet:
+//
+//   bytes 0-3     frames shown from the cache
+//   bytes 4-7     frames asked for but not held
+//   bytes 8-11    frames stored
+//   bytes 12-15   frames dropped to make room
+//   byte 16       frames held
+//   byte 17       zero
+//   bytes 18-19   bytes of the cache in use
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "video.h"
+#include "link.h"
+#include "framecache.h"
+
+//*****************************************************************************
+//
+// A cached frame: the host's id for it, where it is packed, and when it was
+// last stored or shown.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulId;
+    unsigned long ulOffset;
+    unsigned long ulLength;
+    unsigned long ulUsed;
+}
+tFrameCacheEntry;
+
+//*****************************************************************************
+//
+// The packed frames, in order from the start of the cache with no gaps, and
+// the count of stores and shows that dates their use.
+//
+//*****************************************************************************
+static unsigned char g_pucFrameCache[FRAME_CACHE_BYTES];
+static tFrameCacheEntry g_psFrameCacheEntry[FRAME_CACHE_ENTRIES];
+static unsigned long g_ulFrameCacheCount;
+static unsigned long g_ulFrameCacheUsed;
+static unsigned long g_ulFrameCacheClock;
+
+//*****************************************************************************
+//
+// The counters sent to the host.
+//
+//*****************************************************************************
+static unsigned long g_ulFrameCacheHits;
+static unsigned long g_ulFrameCacheMisses;
+static unsigned long g_ulFrameCacheStores;
+static unsigned long g_ulFrameCacheDrops;
+
+//*****************************************************************************
+//
+// Packs a frame with PackBits, returning the packed size.  If pucOut is 0
+// the size is found without writing anything.
+//
+//*****************************************************************************
+static unsigned long
+FrameCachePack(const unsigned char *pucFrame, unsigned char *pucOut)
+{
+    unsigned long ulPos, ulRun, ulLiteral, ulSize;
+
+    ulSize = 0;
+    ulPos = 0;
+    while(ulPos < FRAME_BYTES)
+    {
+        //
+        // A run of three or more equal bytes is repeated.
+        //
+        for(ulRun = 1; ((ulPos + ulRun) < FRAME_BYTES) && (ulRun < 128) &&
+            (pucFrame[ulPos + ulRun] == pucFrame[ulPos]); ulRun++)
+        {
+        }
+        if(ulRun >= 3)
+        {
+            if(pucOut)
+            {
+                pucOut[ulSize] = 257 - ulRun;
+                pucOut[ulSize + 1] = pucFrame[ulPos];
+            }
+            ulSize += 2;
+            ulPos += ulRun;
+            continue;
+        }
+
+        //
+        // Otherwise bytes are copied up to the next such run.
+        //
+        for(ulLiteral = 1; ((ulPos + ulLiteral) < FRAME_BYTES) &&
+            (ulLiteral < 128); ulLiteral++)
+        {
+            if(((ulPos + ulLiteral + 2) < FRAME_BYTES) &&
+               (pucFrame[ulPos + ulLiteral] ==
+                pucFrame[ulPos + ulLiteral + 1]) &&
+               (pucFrame[ulPos + ulLiteral] ==
+                pucFrame[ulPos + ulLiteral + 2]))
+            {
+                break;
+            }
+        }
+        if(pucOut)
+        {
+            pucOut[ulSize] = ulLiteral - 1;
+            memcpy(pucOut + ulSize + 1, pucFrame + ulPos, ulLiteral);
+        }
+        ulSize += 1 + ulLiteral;
+        ulPos += ulLiteral;
+    }
+
+    return(ulSize);
+}
+
+//*****************************************************************************
+//
+// Unpacks a frame packed by FrameCachePack().
+//
+//*****************************************************************************
+static void
+FrameCacheUnpack(const unsigned char *pucData, unsigned char *pucFrame)
+{
+    unsigned long ulPos, ulCount;
+
+    for(ulPos = 0; ulPos < FRAME_BYTES; ulPos += ulCount)
+    {
+        if(*pucData < 128)
+        {
+            ulCount = *pucData + 1;
+            memcpy(pucFrame + ulPos, pucData + 1, ulCount);
+            pucData += 1 + ulCount;
+        }
+        else
+        {
+            ulCount = 257 - *pucData;
+            memset(pucFrame + ulPos, pucData[1], ulCount);
+            pucData += 2;
+        }
+    }
+}
+
+//*****************************************************************************
+//
+// Drops an entry, moving the frames after it down to close the gap.
+//
+//*****************************************************************************
+static void
+FrameCacheRemove(unsigned long ulEntry)
+{
+    unsigned long ulIdx, ulOffset, ulLength;
+
+    ulOffset = g_psFrameCacheEntry[ulEntry].ulOffset;
+    ulLength = g_psFrameCacheEntry[ulEntry].ulLength;
+    memmove(g_pucFrameCache + ulOffset, g_pucFrameCache + ulOffset + ulLength,
+            g_ulFrameCacheUsed - ulOffset - ulLength);
+    g_ulFrameCacheUsed -= ulLength;
+    for(ulIdx = ulEntry + 1; ulIdx < g_ulFrameCacheCount; ulIdx++)
+    {
+        g_psFrameCacheEntry[ulIdx - 1] = g_psFrameCacheEntry[ulIdx];
+        g_psFrameCacheEntry[ulIdx - 1].ulOffset -= ulLength;
+    }
+    g_ulFrameCacheCount--;
+}
+
+//*****************************************************************************
+//
+// Returns the entry holding an id, or FRAME_CACHE_ENTRIES if none does.
+//
+//*****************************************************************************
+static unsigned long
+FrameCacheFind(unsigned long ulId)
+{
+    unsigned long ulEntry;
+
+    for(ulEntry = 0; ulEntry < g_ulFrameCacheCount; ulEntry++)
+    {
+        if(g_psFrameCacheEntry[ulEntry].ulId == ulId)
+        {
+            break;
+        }
+    }
+    return((ulEntry < g_ulFrameCacheCount) ? ulEntry : FRAME_CACHE_ENTRIES);
+}
+
+//*****************************************************************************
+//
+//! Stores a frame in the cache.
+//!
+//! \param ulId is the id the host gives the frame.
+//! \param pucFrame is the frame.
+//!
+//! Any frame held under the same id is replaced, and the least recently used
+//! frames are dropped until the new one fits.
+//!
+//! \return Returns 0 on success or -1 if the frame does not pack small
+//! enough to fit in the cache at all.
+//
+//*****************************************************************************
+long
+FrameCacheStore(unsigned long ulId, const unsigned char *pucFrame)
+{
+    tFrameCacheEntry *psEntry;
+    unsigned long ulSize, ulEntry, ulOldest;
+
+    ulEntry = FrameCacheFind(ulId);
+    if(ulEntry != FRAME_CACHE_ENTRIES)
+    {
+        FrameCacheRemove(ulEntry);
+    }
+    ulSize = FrameCachePack(pucFrame, 0);
+    if(ulSize > FRAME_CACHE_BYTES)
+    {
+        return(-1);
+    }
+
+    while((g_ulFrameCacheCount == FRAME_CACHE_ENTRIES) ||
+          ((g_ulFrameCacheUsed + ulSize) > FRAME_CACHE_BYTES))
+    {
+        for(ulOldest = 0, ulEntry = 1; ulEntry < g_ulFrameCacheCount;
+            ulEntry++)
+        {
+            if(g_psFrameCacheEntry[ulEntry].ulUsed <
+               g_psFrameCacheEntry[ulOldest].ulUsed)
+            {
+                ulOldest = ulEntry;
+            }
+        }
+        FrameCacheRemove(ulOldest);
+        g_ulFrameCacheDrops++;
+    }
+
+    psEntry = &g_psFrameCacheEntry[g_ulFrameCacheCount++];
+    psEntry->ulId = ulId;
+    psEntry->ulOffset = g_ulFrameCacheUsed;
+    psEntry->ulLength = ulSize;
+    psEntry->ulUsed = ++g_ulFrameCacheClock;
+    FrameCachePack(pucFrame, g_pucFrameCache + g_ulFrameCacheUsed);
+    g_ulFrameCacheUsed += ulSize;
+    g_ulFrameCacheStores++;
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Copies a cached frame out of the cache.
+//!
+//! \param ulId is the id the host gave the frame.
+//! \param pucFrame is the frame slot to copy it into.
+//!
+//! \return Returns 0 on success or 1 if no frame is held under the id.
+//
+//*****************************************************************************
+long
+FrameCacheShow(unsigned long ulId, unsigned char *pucFrame)
+{
+    tFrameCacheEntry *psEntry;
+    unsigned long ulEntry;
+
+    ulEntry = FrameCacheFind(ulId);
+    if(ulEntry == FRAME_CACHE_ENTRIES)
+    {
+        g_ulFrameCacheMisses++;
+        return(1);
+    }
+    psEntry = &g_psFrameCacheEntry[ulEntry];
+    psEntry->ulUsed = ++g_ulFrameCacheClock;
+    FrameCacheUnpack(g_pucFrameCache + psEntry->ulOffset, pucFrame);
+    g_ulFrameCacheHits++;
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Drops every cached frame.
+//!
+//! The host's mirror of the cache is only right while no packet has been
+//! lost, so the cache is emptied along with the other decoder state.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+FrameCacheForget(void)
+{
+    g_ulFrameCacheCount = 0;
+    g_ulFrameCacheUsed = 0;
+}
+
+//*****************************************************************************
+//
+//! Sends the cache counters to the host.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+FrameCacheReport(void)
+{
+    unsigned char pucReport[20];
+    unsigned long pulCount[4];
+    unsigned long ulIdx;
+
+    pulCount[0] = g_ulFrameCacheHits;
+    pulCount[1] = g_ulFrameCacheMisses;
+    pulCount[2] = g_ulFrameCacheStores;
+    pulCount[3] = g_ulFrameCacheDrops;
+    for(ulIdx = 0; ulIdx < 4; ulIdx++)
+    {
+        pucReport[ulIdx * 4] = pulCount[ulIdx];
+        pucReport[(ulIdx * 4) + 1] = pulCount[ulIdx] >> 8;
+        pucReport[(ulIdx * 4) + 2] = pulCount[ulIdx] >> 16;
+        pucReport[(ulIdx * 4) + 3] = pulCount[ulIdx] >> 24;
+    }
+    pucReport[16] = g_ulFrameCacheCount;
+    pucReport[17] = 0;
+    pucReport[18] = g_ulFrameCacheUsed;
+    pucReport[19] = g_ulFrameCacheUsed >> 8;
+    LinkReport(LINK_RPT_CACHE, pucReport, sizeof(pucReport));
+}
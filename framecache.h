@@ -0,0 +1,28 @@
+//*****************************************************************************
+//
+// framecache.h - Cache of whole frames kept for the host to show again.
+//
+//*****************************************************************************
+
+#ifndef __FRAMECACHE_H__
+#define __FRAMECACHE_H__
+
+//*****************************************************************************
+//
+// The most frames cached at once, and the bytes of SRAM they are packed into.
+//
+//*****************************************************************************
+#define FRAME_CACHE_ENTRIES     16
+#define FRAME_CACHE_BYTES       6144
+
+//*****************************************************************************
+//
+// Prototypes for the frame cache APIs.
+//
+//*****************************************************************************
+extern long FrameCacheStore(unsigned long ulId, const unsigned char *pucFrame);
+extern long FrameCacheShow(unsigned long ulId, unsigned char *pucFrame);
+extern void FrameCacheForget(void);
+extern void FrameCacheReport(void);
+
+#endif // __FRAMECACHE_H__
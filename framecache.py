@@ -0,0 +1,101 @@
+#Mirror of the device's cache of whole frames, matching framecache.c on the
+#device
+import hashlib
+from collections import deque
+from hostframe import FRAME_BYTES
+
+#Most frames cached at once, and the bytes they are packed into
+ENTRIES = 16
+BYTES = 6144
+#Frames remembered to find the ones that come round again
+HISTORY = 1024
+
+
+def packed_size(frame):
+    """Bytes of a frame packed with PackBits as the device packs it"""
+    data = bytearray(frame)
+    size = 0
+    pos = 0
+    while pos < FRAME_BYTES:
+        run = 1
+        while (pos + run < FRAME_BYTES and run < 128 and
+               data[pos + run] == data[pos]):
+            run += 1
+        if run >= 3:
+            size += 2
+            pos += run
+            continue
+        literal = 1
+        while pos + literal < FRAME_BYTES and literal < 128:
+            at = pos + literal
+            if (at + 2 < FRAME_BYTES and data[at] == data[at + 1] and
+                    data[at] == data[at + 2]):
+                break
+            literal += 1
+        size += 1 + literal
+        pos += literal
+    return size
+
+
+class FrameCache(object):
+    """Tracks which frames the device holds, dropping the least recently
+    stored or shown as it does, and which frames have been sent before"""
+
+    def __init__(self):
+        self.history = deque()
+        self.seen = {}
+        #Frames sent as cache packets rather than encoded
+        self.shown = 0
+        self.stored = 0
+        self.reset()
+
+    def reset(self):
+        """Forget the device's cache, which it empties after a lost packet"""
+        #Entries of [key, id, size, last use, frame] in the device's order
+        self.entries = []
+        self.clock = 0
+        self.next_id = 0
+
+    def lookup(self, frame):
+        """Return the id and frame the device shows for a frame it holds,
+        or None"""
+        key = hashlib.md5(bytes(frame)).digest()
+        for entry in self.entries:
+            if entry[0] == key:
+                self.clock += 1
+                entry[3] = self.clock
+                self.shown += 1
+                return entry[1], entry[4]
+        return None
+
+    def repeated(self, frame):
+        """True if a frame has been sent recently; remembers it either way"""
+        key = hashlib.md5(bytes(frame)).digest()
+        if key in self.seen:
+            return True
+        self.seen[key] = True
+        self.history.append(key)
+        if len(self.history) > HISTORY:
+            del self.seen[self.history.popleft()]
+        return False
+
+    def store(self, frame, shown):
+        """Return the id to store the frame shown for a frame under, or None
+        if it does not fit"""
+        size = packed_size(shown)
+        if size > BYTES:
+            return None
+        used = set(entry[1] for entry in self.entries)
+        while self.next_id in used:
+            self.next_id = (self.next_id + 1) % 256
+        ident = self.next_id
+        self.next_id = (self.next_id + 1) % 256
+        while (len(self.entries) == ENTRIES or
+               sum(entry[2] for entry in self.entries) + size > BYTES):
+            oldest = min(self.entries, key=lambda entry: entry[3])
+            self.entries.remove(oldest)
+        self.clock += 1
+        self.entries.append([hashlib.md5(bytes(frame)).digest(), ident, size,
+                             self.clock, bytearray(shown)])
+        self.stored += 1
+        return ident
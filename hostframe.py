@@ -0,0 +1,55 @@
+#Frame reading and packing for the 128x96x4 OLED display
+import os
+
+#Display geometry, matching video.h on the device
+WIDTH = 128
+HEIGHT = 96
+STRIDE = WIDTH // 2
+FRAME_BYTES = STRIDE * HEIGHT
+
+
+def list_frames(path='./'):
+    """Return the pgm files in a directory in frame order"""
+    return sorted(f for f in os.listdir(path) if f.endswith('.pgm'))
+
+
+def read_pgm(name, width=WIDTH, height=HEIGHT):
+    """Read the 8-bit luminance of a 128x96, or width x height, pgm file
+    written by ffmpeg.  Returns None if the file is incomplete, which happens
+    when ffmpeg is still writing it."""
+    f = open(name, 'rb')
+    try:
+        #Skip the magic number, dimensions and maximum value
+        for x in range(0, 3):
+            f.readline()
+        pixels = bytearray(f.read(width * height))
+    finally:
+        f.close()
+    if len(pixels) < width * height:
+        return None
+    return pixels
+
+
+def tile(pixels, width, column, row):
+    """The 128x96 luminance of one display's tile of a larger picture width
+    pixels across, column and row counting displays"""
+    out = bytearray()
+    for y in range(row * HEIGHT, (row + 1) * HEIGHT):
+        start = y * width + column * WIDTH
+        out += pixels[start:start + WIDTH]
+    return out
+
+
+def pack(pixels):
+    """Pack 8-bit luminance into two pixels per byte, left pixel in the high
+    nibble"""
+    frame = bytearray((pixels[i] & 0xF0) | (pixels[i + 1] >> 4)
+                      for i in range(0, WIDTH * HEIGHT, 2))
+    #Remove the sync byte where it occurs so white frames are not doubled in
+    #size by escaping on the wire
+    return bytearray(bytes(frame).replace(b'\xff', b'\xee'))
+
+
+def black():
+    """A blank frame"""
+    return bytearray(FRAME_BYTES)
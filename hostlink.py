@@ -0,0 +1,442 @@
+#Serial link framing shared with link.c and video.c on the device
+import threading, time
+from hostframe import FRAME_BYTES
+
+#Framing bytes
+SYNC = 0xFF
+ESCAPE = 0xFE
+#Largest payload the device accepts
+MAX_PAYLOAD = 6144 + 64
+
+#Packet types sent to the device
+PKT_RAW = 0x00
+PKT_BLOCK = 0x01
+PKT_TILE = 0x02
+PKT_VQ_CODEBOOK = 0x03
+PKT_VQ = 0x04
+PKT_LZ = 0x05
+PKT_HUFF_TABLE = 0x06
+PKT_HUFF = 0x07
+PKT_PLANE = 0x08
+PKT_DEPTH = 0x09
+PKT_SCALED = 0x0A
+PKT_FIELD = 0x0B
+PKT_REFRESH = 0x0C
+PKT_DRAW = 0x0D
+PKT_TEXT = 0x0E
+PKT_SPRITE_IMAGE = 0x0F
+PKT_SPRITE = 0x10
+PKT_SCROLL = 0x11
+PKT_LAYOUT = 0x12
+PKT_WINDOW = 0x13
+PKT_CLIP = 0x14
+PKT_CACHE_STORE = 0x15
+PKT_CACHE_SHOW = 0x16
+PKT_TIME = 0x17
+PKT_SYNC = 0x18
+PKT_STAMP = 0x19
+PKT_PROFILE = 0x1A
+
+#Report types sent back by the device
+RPT_FRAME = 0x80
+RPT_CLIP = 0x81
+RPT_CACHE = 0x82
+RPT_BOOT = 0x83
+RPT_LATENCY = 0x84
+RPT_PROFILE = 0x85
+
+#Frame report status codes
+STATUS_OK = 0
+STATUS_NO_REF = 1
+STATUS_ERROR = 2
+
+#Readable names for the statistics summary
+PKT_NAMES = {PKT_RAW: 'raw', PKT_BLOCK: 'block', PKT_TILE: 'tile',
+             PKT_VQ: 'vq', PKT_LZ: 'lz', PKT_HUFF: 'huff',
+             PKT_PLANE: 'plane', PKT_DEPTH: 'depth', PKT_SCALED: 'scaled',
+             PKT_FIELD: 'field', PKT_REFRESH: 'refresh',
+             PKT_DRAW: 'draw', PKT_TEXT: 'text', PKT_SPRITE: 'sprite',
+             PKT_SCROLL: 'scroll', PKT_WINDOW: 'window',
+             PKT_CACHE_SHOW: 'show'}
+
+#Core clock of the device, used to turn cycles into time
+CPU_HZ = 50000000
+
+
+def packet(ptype, payload):
+    """Frame a payload for the wire: sync byte, type, length, payload, with
+    0xFE and 0xFF escaped after the sync byte."""
+    if len(payload) > MAX_PAYLOAD:
+        raise ValueError('payload too large: %d bytes' % len(payload))
+    body = bytearray([ptype, len(payload) & 0xFF, len(payload) >> 8])
+    body += payload
+    #Escape the escape byte first so the 0xFF escapes are not doubled
+    body = bytes(body).replace(b'\xfe', b'\xfe\x00').replace(b'\xff', b'\xfe\x01')
+    return bytearray([SYNC]) + bytearray(body)
+
+
+def time_payload(ms, latency):
+    """Payload of a time packet: the next frame is shown ms milliseconds into
+    the stream, with the board holding frames for latency milliseconds"""
+    ms = int(ms) & 0xFFFFFFFF
+    return bytearray([ms & 0xFF, ms >> 8 & 0xFF, ms >> 16 & 0xFF, ms >> 24,
+                      latency & 0xFF, latency >> 8])
+
+
+def sync_payload(ms):
+    """Payload of a sync packet: the host's clock in milliseconds, which
+    timed frames are shown by on a video wall"""
+    ms = int(ms) & 0xFFFFFFFF
+    return bytearray([ms & 0xFF, ms >> 8 & 0xFF, ms >> 16 & 0xFF, ms >> 24])
+
+
+def stamp_payload(seq, us):
+    """Payload of a stamp packet: the sequence number of the next frame and
+    the host's time it was sent in microseconds, which the device echoes back
+    with the time it took over the frame"""
+    payload = bytearray()
+    for value in (seq, int(us)):
+        value &= 0xFFFFFFFF
+        payload += bytearray([value & 0xFF, value >> 8 & 0xFF,
+                              value >> 16 & 0xFF, value >> 24])
+    return payload
+
+
+def wire_size(ptype, payload):
+    """Bytes packet() makes of a payload, counting escapes"""
+    body = bytes(bytearray([ptype, len(payload) & 0xFF, len(payload) >> 8]))
+    body += bytes(payload)
+    return 1 + len(body) + body.count(b'\xfe') + body.count(b'\xff')
+
+
+def record(ptype, payload):
+    """A packet as a record of type, length and payload without the link
+    framing, as bench/decbench and clipStore.py read them"""
+    return (bytearray([ptype, len(payload) & 0xFF, len(payload) >> 8]) +
+            bytearray(payload))
+
+
+def write_records(path, packets):
+    """Write (type, payload) packets to a file as records"""
+    out = open(path, 'wb')
+    try:
+        for ptype, payload in packets:
+            out.write(record(ptype, payload))
+    finally:
+        out.close()
+
+
+def backlog(ser):
+    """Bytes written to the port but not yet sent, or 0 if the serial driver
+    cannot tell"""
+    try:
+        return ser.out_waiting
+    except AttributeError:
+        return 0
+
+
+def le32(data, offset):
+    """Read a little endian 32-bit value"""
+    return (data[offset] | data[offset + 1] << 8 | data[offset + 2] << 16 |
+            data[offset + 3] << 24)
+
+
+def frame_report(payload):
+    """Split a frame report into packet type, status, payload length, decode
+    cycles and draw cycles"""
+    payload = bytearray(payload)
+    return (payload[0], payload[1], payload[2] | payload[3] << 8,
+            le32(payload, 4), le32(payload, 8))
+
+
+def cache_report(payload):
+    """Split a frame cache report into frames shown, frames not held, frames
+    stored, frames dropped, frames held and bytes in use"""
+    payload = bytearray(payload)
+    return (le32(payload, 0), le32(payload, 4), le32(payload, 8),
+            le32(payload, 12), payload[16], payload[18] | payload[19] << 8)
+
+
+#Steps of the boot report, in order
+BOOT_STEPS = ('clock set', 'link ready', 'display ready', 'first packet',
+              'first frame')
+
+
+def boot_report(payload):
+    """Split a boot report into the cycles from the clock being set to each of
+    BOOT_STEPS"""
+    return [le32(payload, 4 * i) for i in range(len(BOOT_STEPS))]
+
+
+def latency_report(payload):
+    """Split a latency report into sequence number, host time, and the
+    cycles from the stamp arriving to the frame arriving, decoding it,
+    waiting to draw it and drawing it"""
+    payload = bytearray(payload)
+    return [le32(payload, 4 * i) for i in range(6)]
+
+
+#Code the device's profiling probes time, in the order of profile.h
+PROFILE_PROBES = ('UARTIntHandler', 'SSIIntHandler', 'RITWriteData',
+                  'VideoPacketDecode', 'VideoPresent')
+
+
+def profile_report(payload):
+    """Split a profile report into probe, number of probes, runs, and the
+    fewest, most and total cycles"""
+    payload = bytearray(payload)
+    return (payload[0], payload[1], le32(payload, 4), le32(payload, 8),
+            le32(payload, 12), le32(payload, 16) | le32(payload, 20) << 32)
+
+
+def read_profile(ser, reader, clear=False):
+    """Read every probe from a device built with PROFILE=1, returning a list
+    of (runs, fewest, most, total cycles), or None if it does not answer"""
+    probes = 1
+    probe = 0
+    while probe < probes:
+        reader.profile.pop(probe, None)
+        ser.write(packet(PKT_PROFILE, bytearray([probe, 1 if clear else 0])))
+        for n in range(50):
+            if probe in reader.profile:
+                break
+            time.sleep(0.01)
+        else:
+            return None
+        probes = reader.profile[probe][1]
+        probe += 1
+    return [reader.profile[probe][2:] for probe in range(probes)]
+
+
+def stream(ser, step, fps, handler, count=0):
+    """Send the packets step(n) returns for n = 0, 1, ... at fps steps a
+    second, count of them or until interrupted if count is 0, then close the
+    port.  handler is passed the device's reports as an encoder is.  Returns
+    the FrameStats of the reports, the bytes sent and the steps sent."""
+    reader = ReportReader(ser, handler)
+    reader.start()
+    sent = 0
+    n = 0
+    due = time.time()
+    try:
+        while not count or n < count:
+            for ptype, payload in step(n):
+                data = packet(ptype, payload)
+                sent += len(data)
+                ser.write(data)
+            n += 1
+            due += 1.0 / fps
+            delay = due - time.time()
+            if delay > 0:
+                time.sleep(delay)
+    except KeyboardInterrupt:
+        pass
+    finally:
+        #Let the last reports arrive, then close the serial connection
+        time.sleep(0.2)
+        ser.close()
+    return reader.stats, sent, n
+
+
+def mbps(size, cycles):
+    """Rate in megabytes per second of producing size bytes in cycles"""
+    return size * CPU_HZ / 1e6 / cycles if cycles else 0.0
+
+
+class ReportParser(object):
+    """Splits the byte stream coming back from the device into reports"""
+
+    def __init__(self):
+        self.state = None
+        self.escape = False
+        self.header = bytearray()
+        self.payload = bytearray()
+
+    def feed(self, data):
+        """Parse received bytes, returning a list of (type, payload) tuples"""
+        reports = []
+        for c in bytearray(data):
+            #A sync byte always starts a new report
+            if c == SYNC:
+                self.state = 'header'
+                self.escape = False
+                self.header = bytearray()
+                self.payload = bytearray()
+                continue
+            if self.state is None:
+                continue
+            #Undo the escaping
+            if self.escape:
+                self.escape = False
+                if c > 1:
+                    self.state = None
+                    continue
+                c += ESCAPE
+            elif c == ESCAPE:
+                self.escape = True
+                continue
+            if self.state == 'header':
+                self.header.append(c)
+                if len(self.header) < 3:
+                    continue
+                self.state = 'payload'
+            else:
+                self.payload.append(c)
+            #Check for a complete report
+            if len(self.payload) == self.header[1] | self.header[2] << 8:
+                reports.append((self.header[0], bytes(self.payload)))
+                self.state = None
+        return reports
+
+
+class FrameStats(object):
+    """Accumulates the per-frame decode reports sent by the device"""
+
+    def __init__(self):
+        self.types = {}
+        self.failed = 0
+
+    def add(self, payload):
+        ptype, status, length, decode, draw = frame_report(payload)
+        if status != STATUS_OK:
+            self.failed += 1
+            return status
+        s = self.types.setdefault(ptype, [0, 0, 0, 0, 0])
+        s[0] += 1
+        s[1] += length
+        s[2] += decode
+        s[3] = max(s[3], decode)
+        s[4] += draw
+        return status
+
+    def summary(self):
+        lines = []
+        for ptype in sorted(self.types):
+            n, length, decode, peak, draw = self.types[ptype]
+            lines.append('%-6s %6d frames %7.0f bytes  decode %8.0f cycles/frame'
+                         ' (max %d, %.2f ms, %.1f MB/s, %.0f cycles/byte)'
+                         '  draw %8.0f cycles/frame' %
+                         (PKT_NAMES.get(ptype, hex(ptype)), n,
+                          float(length) / n, float(decode) / n, peak,
+                          1000.0 * decode / n / CPU_HZ,
+                          mbps(n * FRAME_BYTES, decode),
+                          float(decode) / max(length, 1),
+                          float(draw) / n))
+        if self.failed:
+            lines.append('%d frames rejected by the device' % self.failed)
+        return '\n'.join(lines)
+
+
+class LatencyStats(object):
+    """Where the time goes between a picture being captured and the device
+    drawing it, from the stamps sent before frames and the latency reports
+    the device answers them with"""
+
+    #The stages, in order: ffmpeg writing the picture to the sender reading
+    #it, the sender reading it to writing the frame to the port, the stamp
+    #reaching the device and the report coming back, the rest of the frame
+    #arriving after the stamp, decoding, waiting to be drawn and drawing; and
+    #the whole
+    STAGES = ('ffmpeg', 'sender', 'link', 'receive', 'decode', 'wait', 'draw',
+              'total')
+
+    def __init__(self):
+        self.seq = 0
+        self.sent = {}
+        self.times = dict((stage, []) for stage in self.STAGES)
+        self.dropped = 0
+
+    def stamp(self, captured, read):
+        """Return the stamp packet to send straight before a frame.  captured
+        is the time the picture was written, or None if it is not known, and
+        read the time the sender read it."""
+        now = time.time()
+        self.sent[self.seq] = (captured, read, now)
+        data = packet(PKT_STAMP, stamp_payload(self.seq, now * 1e6))
+        self.seq += 1
+        return data
+
+    def add(self, arrived, payload):
+        """Take a latency report that arrived at a time"""
+        seq, us, receive, decode, wait, draw = latency_report(payload)
+        if seq not in self.sent:
+            return
+        captured, read, sent = self.sent.pop(seq)
+        if not draw:
+            self.dropped += 1
+            return
+        board = float(receive + decode + wait + draw) / CPU_HZ
+        stages = {'sender': sent - read,
+                  'link': arrived - sent - board,
+                  'receive': float(receive) / CPU_HZ,
+                  'decode': float(decode) / CPU_HZ,
+                  'wait': float(wait) / CPU_HZ,
+                  'draw': float(draw) / CPU_HZ,
+                  'total': arrived - (captured or read)}
+        if captured:
+            stages['ffmpeg'] = read - captured
+        for stage in stages:
+            self.times[stage].append(stages[stage])
+
+    def summary(self):
+        lines = ['%-7s %9s %9s %9s %9s' % ('stage', 'p50 ms', 'p90 ms',
+                                           'p99 ms', 'max ms')]
+        for stage in self.STAGES:
+            times = sorted(self.times[stage])
+            if not times:
+                continue
+            lines.append('%-7s' % stage + ''.join(
+                ' %9.2f' % (1000.0 * times[min(len(times) - 1,
+                                               int(p * len(times)))])
+                for p in (0.5, 0.9, 0.99, 1)))
+        lines.append('%d frames drawn' % len(self.times['total']))
+        if self.dropped:
+            lines.append('%d frames not drawn' % self.dropped)
+        return '\n'.join(lines)
+
+
+class ReportReader(threading.Thread):
+    """Background thread that reads reports from the device.  Frames the
+    device could not decode make it ask the encoder for a keyframe, and the
+    decode times of the rest are passed on to the encoder."""
+
+    def __init__(self, ser, encoder):
+        threading.Thread.__init__(self)
+        self.daemon = True
+        self.ser = ser
+        self.encoder = encoder
+        self.parser = ReportParser()
+        self.stats = FrameStats()
+        #The latest frame cache counters, from cache_report()
+        self.cache = None
+        #The startup timeline, from boot_report(), if the board was reset
+        self.boot = None
+        #The stage times of stamped frames
+        self.latency = LatencyStats()
+        #Profile reports by probe, from profile_report()
+        self.profile = {}
+
+    def run(self):
+        try:
+            while 1:
+                data = self.ser.read(max(1, self.ser.inWaiting()))
+                for rtype, payload in self.parser.feed(data):
+                    if rtype == RPT_FRAME:
+                        if self.stats.add(payload) != STATUS_OK:
+                            self.encoder.request_keyframe()
+                        else:
+                            ptype, status, length, decode, draw = \
+                                frame_report(payload)
+                            self.encoder.decoded(ptype, length, decode)
+                    elif rtype == RPT_CACHE:
+                        self.cache = cache_report(payload)
+                    elif rtype == RPT_BOOT:
+                        self.boot = boot_report(bytearray(payload))
+                    elif rtype == RPT_LATENCY:
+                        self.latency.add(time.time(), payload)
+                    elif rtype == RPT_PROFILE:
+                        report = profile_report(payload)
+                        self.profile[report[0]] = report
+        except Exception:
+            #The port was closed underneath us
+            return
@@ -0,0 +1,310 @@
+//*****************************************************************************
+//
+// huffcodec.c - Decoder for Huffman coded frames.
+//
+// Pixel nibbles in most video are far from evenly spread, with dark values
+// much more common than bright ones, so a frame is sent as a static Huffman
+// code per nibble.  The host builds the code once per clip and sends it in a
+// table packet:
+//
+//   byte 0         table number, 0 for pixels or 1 for residuals
+//   bytes 1-16     code length of each nibble value, 0 if it is unused
+//
+// Codes are canonical: shorter codes come first, and codes of the same
+// length are in order of nibble value.
+//
+// A Huffman frame is a flags byte followed by the codes of all 12288 pixel
+// nibbles in frame order, packed most significant bit first with the last
+// byte padded with zero bits.  If HUFF_FLAG_DELTA is set the nibbles are the
+// exclusive or of the frame with the reference frame, which is mostly zero
+// for slowly changing video.
+//
+// Decoding looks up the next eight bits in a 256 entry table that gives all
+// the whole codes they contain, up to four, so common short codes decode
+// several nibbles per lookup.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <string.h>
+#include "video.h"
+#include "huffcodec.h"
+
+//*****************************************************************************
+//
+// Layout of a decode table entry: the nibbles decoded, first nibble most
+// significant, the number of them, and the number of bits they take.  An
+// entry with no nibbles marks bits that start no valid code.
+//
+//*****************************************************************************
+#define HUFF_ENTRY_NIBBLES      4
+#define HUFF_ENTRY_COUNT_S      16
+#define HUFF_ENTRY_BITS_S       24
+
+//*****************************************************************************
+//
+// The decode tables, and the code length of each nibble for the tails of
+// frames.
+//
+//*****************************************************************************
+static uint32_t g_ppulHuffTable[HUFF_TABLES][1 << HUFF_MAX_LENGTH];
+static unsigned char g_ppucHuffLength[HUFF_TABLES][HUFF_SYMBOLS];
+
+//*****************************************************************************
+//
+// Decodes the first code in the top ulAvail bits of an eight bit window,
+// given the number of codes of each length and the nibbles in code order.
+// Returns the nibble and sets *pulLength, or returns -1 if no code fits.
+//
+//*****************************************************************************
+static long
+HuffCodeFind(unsigned long ulWindow, unsigned long ulAvail,
+             const unsigned char *pucCount, const unsigned char *pucSymbol,
+             unsigned long *pulLength)
+{
+    unsigned long ulLength, ulCode, ulFirst, ulIndex;
+
+    ulCode = 0;
+    ulFirst = 0;
+    ulIndex = 0;
+    for(ulLength = 1; ulLength <= ulAvail; ulLength++)
+    {
+        ulCode |= (ulWindow >> (HUFF_MAX_LENGTH - ulLength)) & 1;
+        if((ulCode - ulFirst) < pucCount[ulLength])
+        {
+            *pulLength = ulLength;
+            return(pucSymbol[ulIndex + ulCode - ulFirst]);
+        }
+        ulIndex += pucCount[ulLength];
+        ulFirst = (ulFirst + pucCount[ulLength]) << 1;
+        ulCode <<= 1;
+    }
+
+    return(-1);
+}
+
+//*****************************************************************************
+//
+//! Loads a Huffman table.
+//!
+//! \param pucData is a pointer to the table packet.
+//! \param ulLength is the number of bytes in the packet.
+//!
+//! \return Returns 0 on success or -1 if the packet is malformed or the code
+//! lengths do not form a prefix code, in which case the table is left
+//! unchanged.
+//
+//*****************************************************************************
+long
+HuffTableLoad(const unsigned char *pucData, unsigned long ulLength)
+{
+    unsigned char pucCount[HUFF_MAX_LENGTH + 1], pucSymbol[HUFF_SYMBOLS];
+    unsigned long ulTable, ulLen, ulSym, ulIndex, ulUsed, ulCount;
+    unsigned long ulNibbles, ulCodeLen;
+    long lLeft, lSym;
+
+    if(ulLength != (1 + HUFF_SYMBOLS))
+    {
+        return(-1);
+    }
+    ulTable = pucData[0];
+    pucData++;
+    if(ulTable >= HUFF_TABLES)
+    {
+        return(-1);
+    }
+
+    //
+    // Count the codes of each length and check that they fit in the code
+    // space.
+    //
+    memset(pucCount, 0, sizeof(pucCount));
+    for(ulSym = 0; ulSym < HUFF_SYMBOLS; ulSym++)
+    {
+        if(pucData[ulSym] > HUFF_MAX_LENGTH)
+        {
+            return(-1);
+        }
+        pucCount[pucData[ulSym]]++;
+    }
+    pucCount[0] = 0;
+    lLeft = 1;
+    for(ulLen = 1; ulLen <= HUFF_MAX_LENGTH; ulLen++)
+    {
+        lLeft = (lLeft << 1) - pucCount[ulLen];
+        if(lLeft < 0)
+        {
+            return(-1);
+        }
+    }
+
+    //
+    // List the nibbles in code order.
+    //
+    ulIndex = 0;
+    for(ulLen = 1; ulLen <= HUFF_MAX_LENGTH; ulLen++)
+    {
+        for(ulSym = 0; ulSym < HUFF_SYMBOLS; ulSym++)
+        {
+            if(pucData[ulSym] == ulLen)
+            {
+                pucSymbol[ulIndex++] = ulSym;
+            }
+        }
+    }
+    memcpy(g_ppucHuffLength[ulTable], pucData, HUFF_SYMBOLS);
+
+    //
+    // Fill each entry with as many whole codes as its eight bits hold.
+    //
+    for(ulIndex = 0; ulIndex < (1 << HUFF_MAX_LENGTH); ulIndex++)
+    {
+        ulNibbles = 0;
+        ulCount = 0;
+        ulUsed = 0;
+        while(ulCount < HUFF_ENTRY_NIBBLES)
+        {
+            lSym = HuffCodeFind((ulIndex << ulUsed) & 0xFF,
+                                HUFF_MAX_LENGTH - ulUsed, pucCount, pucSymbol,
+                                &ulCodeLen);
+            if(lSym < 0)
+            {
+                break;
+            }
+            ulNibbles = (ulNibbles << 4) | lSym;
+            ulCount++;
+            ulUsed += ulCodeLen;
+        }
+        g_ppulHuffTable[ulTable][ulIndex] =
+            ((ulUsed << HUFF_ENTRY_BITS_S) | (ulCount << HUFF_ENTRY_COUNT_S) |
+             ulNibbles);
+    }
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Decodes a Huffman frame.
+//!
+//! \param pucData is a pointer to the encoded frame.
+//! \param ulLength is the number of bytes of encoded data.
+//! \param pucRef is the reference frame for residual frames, or 0 if none is
+//! available.
+//! \param pucFrame is the frame slot to decode into; it must not be the same
+//! as \e pucRef and must be word aligned.
+//!
+//! The table the frame uses must have been loaded with HuffTableLoad().
+//!
+//! \return Returns 0 on success or -1 if the encoded data is malformed or is
+//! a residual frame and \e pucRef is 0, in which case the contents of
+//! \e pucFrame are undefined.
+//
+//*****************************************************************************
+long
+HuffDecode(const unsigned char *pucData, unsigned long ulLength,
+           const unsigned char *pucRef, unsigned char *pucFrame)
+{
+    const unsigned char *pucEnd;
+    const uint32_t *pulTable, *pulRef;
+    unsigned char *pucDst;
+    uint32_t *pulDst;
+    unsigned long ulTable, ulBuf, ulBits, ulOut, ulOutBits, ulLeft;
+    unsigned long ulEntry, ulNibbles, ulCount, ulUsed;
+
+    if(ulLength < 1)
+    {
+        return(-1);
+    }
+    ulTable = pucData[0] & HUFF_FLAG_DELTA;
+    if((pucData[0] & ~HUFF_FLAG_DELTA) || (ulTable && !pucRef))
+    {
+        return(-1);
+    }
+    pulTable = g_ppulHuffTable[ulTable];
+    pucEnd = pucData + ulLength;
+    pucData++;
+
+    ulBuf = 0;
+    ulBits = 0;
+    ulOut = 0;
+    ulOutBits = 0;
+    pucDst = pucFrame;
+    for(ulLeft = FRAME_BYTES * 2; ulLeft; ulLeft -= ulCount)
+    {
+        //
+        // Keep at least a byte of input in the bit buffer while there is any
+        // left, and look up the next eight bits, padded with zeros at the
+        // end of the data.
+        //
+        while((ulBits <= 24) && (pucData != pucEnd))
+        {
+            ulBuf = (ulBuf << 8) | *pucData++;
+            ulBits += 8;
+        }
+        if(ulBits >= HUFF_MAX_LENGTH)
+        {
+            ulEntry = pulTable[(ulBuf >> (ulBits - HUFF_MAX_LENGTH)) & 0xFF];
+        }
+        else
+        {
+            ulEntry = pulTable[(ulBuf << (HUFF_MAX_LENGTH - ulBits)) & 0xFF];
+        }
+        ulNibbles = ulEntry & 0xFFFF;
+        ulCount = (ulEntry >> HUFF_ENTRY_COUNT_S) & 0xFF;
+        ulUsed = ulEntry >> HUFF_ENTRY_BITS_S;
+        if(ulCount == 0)
+        {
+            return(-1);
+        }
+
+        //
+        // At the end of the frame or the data, take only the first code.
+        //
+        if((ulCount > ulLeft) || (ulUsed > ulBits))
+        {
+            ulNibbles >>= 4 * (ulCount - 1);
+            ulUsed = g_ppucHuffLength[ulTable][ulNibbles];
+            ulCount = 1;
+            if(ulUsed > ulBits)
+            {
+                return(-1);
+            }
+        }
+        ulBits -= ulUsed;
+
+        //
+        // Append the nibbles to the output, writing out whole bytes.
+        //
+        ulOut = (ulOut << (4 * ulCount)) | ulNibbles;
+        ulOutBits += 4 * ulCount;
+        while(ulOutBits >= 8)
+        {
+            ulOutBits -= 8;
+            *pucDst++ = ulOut >> ulOutBits;
+        }
+    }
+
+    //
+    // Anything more than the padding of the last byte is an error.
+    //
+    if((pucData != pucEnd) || (ulBits >= 8))
+    {
+        return(-1);
+    }
+
+    //
+    // Undo the residual.
+    //
+    if(ulTable)
+    {
+        pulDst = (uint32_t *)pucFrame;
+        pulRef = (const uint32_t *)pucRef;
+        for(ulLeft = 0; ulLeft < (FRAME_BYTES / 4); ulLeft++)
+        {
+            *pulDst++ ^= *pulRef++;
+        }
+    }
+
+    return(0);
+}
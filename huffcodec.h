@@ -0,0 +1,38 @@
+//*****************************************************************************
+//
+// huffcodec.h - Decoder for Huffman coded frames.
+//
+//*****************************************************************************
+
+#ifndef __HUFFCODEC_H__
+#define __HUFFCODEC_H__
+
+//*****************************************************************************
+//
+// Code limits.  Every pixel nibble is one symbol, and codes are at most
+// eight bits long so that one table lookup always finds a whole code.
+//
+//*****************************************************************************
+#define HUFF_SYMBOLS            16
+#define HUFF_MAX_LENGTH         8
+#define HUFF_TABLES             2
+
+//*****************************************************************************
+//
+// Flags carried in the first byte of a Huffman frame.  The flags also select
+// the table: table 0 codes pixels, table 1 codes residuals.
+//
+//*****************************************************************************
+#define HUFF_FLAG_DELTA         0x01        // Residual against the reference
+
+//*****************************************************************************
+//
+// Prototypes for the Huffman codec APIs.
+//
+//*****************************************************************************
+extern long HuffTableLoad(const unsigned char *pucData,
+                          unsigned long ulLength);
+extern long HuffDecode(const unsigned char *pucData, unsigned long ulLength,
+                       const unsigned char *pucRef, unsigned char *pucFrame);
+
+#endif // __HUFFCODEC_H__
@@ -0,0 +1,124 @@
+#Table builder and encoder for the Huffman coded frames decoded by
+#huffcodec.c on the device
+import heapq
+from hostframe import FRAME_BYTES
+
+#Code limits, matching huffcodec.h
+SYMBOLS = 16
+MAX_LENGTH = 8
+
+#Tables, selected by the frame flags
+TABLE_PIXELS = 0
+TABLE_DELTA = 1
+FLAG_DELTA = 0x01
+
+
+def histogram(data, counts=None):
+    """Add the nibble counts of packed pixel data to counts"""
+    counts = counts or [0] * SYMBOLS
+    for b in bytearray(data):
+        counts[b >> 4] += 1
+        counts[b & 0xF] += 1
+    return counts
+
+
+def residual(frame, ref):
+    """Exclusive or of two packed frames"""
+    return bytearray(a ^ b for a, b in zip(bytearray(frame), bytearray(ref)))
+
+
+def huffman(counts):
+    """Unlimited Huffman code lengths for a list of counts"""
+    heap = [(c, s, [s]) for s, c in enumerate(counts)]
+    heapq.heapify(heap)
+    lengths = [0] * len(counts)
+    while len(heap) > 1:
+        c1, s1, m1 = heapq.heappop(heap)
+        c2, s2, m2 = heapq.heappop(heap)
+        for s in m1 + m2:
+            lengths[s] += 1
+        heapq.heappush(heap, (c1 + c2, min(s1, s2), m1 + m2))
+    return lengths
+
+
+def code_lengths(counts):
+    """Code lengths of at most MAX_LENGTH bits for every nibble, including
+    ones not seen yet, flattening the counts until the code fits"""
+    counts = [c + 1 for c in counts]
+    while True:
+        lengths = huffman(counts)
+        if max(lengths) <= MAX_LENGTH:
+            return lengths
+        counts = [(c + 1) // 2 for c in counts]
+
+
+def byte_codes(lengths):
+    """Canonical codes as bit strings for each of the 256 pixel pair bytes"""
+    codes = {}
+    code = 0
+    prev = 0
+    for s in sorted(range(SYMBOLS), key=lambda s: (lengths[s], s)):
+        code <<= lengths[s] - prev
+        prev = lengths[s]
+        codes[s] = format(code, '0%db' % lengths[s])
+        code += 1
+    return [codes[b >> 4] + codes[b & 0xF] for b in range(256)]
+
+
+class HuffEncoder(object):
+    """Holds the static tables for a clip and which of them the device has"""
+
+    def __init__(self):
+        self.lengths = [None, None]
+        self.codes = [None, None]
+        self.sent = [False, False]
+
+    def set_table(self, table, counts):
+        self.lengths[table] = code_lengths(counts)
+        self.codes[table] = byte_codes(self.lengths[table])
+        self.sent[table] = False
+
+    def pretrain(self, frames):
+        """Build both tables from the whole clip"""
+        pixels = [0] * SYMBOLS
+        delta = [0] * SYMBOLS
+        prev = None
+        for frame in frames:
+            histogram(frame, pixels)
+            if prev is not None:
+                histogram(residual(frame, prev), delta)
+            prev = frame
+        self.set_table(TABLE_PIXELS, pixels)
+        self.set_table(TABLE_DELTA, delta)
+
+    def code(self, table, data):
+        """Huffman code packed pixel data with one of the tables"""
+        if self.lengths[table] is None:
+            #Without a clip to train on, use the first data coded
+            self.set_table(table, histogram(data))
+        bits = ''.join(self.codes[table][b] for b in bytearray(data))
+        bits += '0' * (-len(bits) % 8)
+        return bytearray([FLAG_DELTA if table == TABLE_DELTA else 0] +
+                         [int(bits[i:i + 8], 2) for i in range(0, len(bits), 8)])
+
+    def encode(self, frame, ref=None, resend=False, limit=None):
+        """Encode a frame, as a residual against ref if given and smaller.
+        Returns (table packets to send first, frame payload, whether the
+        frame stands alone), or None if the frame would be longer than
+        limit.  With resend the tables are sent again."""
+        if resend:
+            self.sent = [False, False]
+        payload = self.code(TABLE_PIXELS, frame)
+        table = TABLE_PIXELS
+        if ref is not None:
+            delta = self.code(TABLE_DELTA, residual(frame, ref))
+            if len(delta) < len(payload):
+                payload = delta
+                table = TABLE_DELTA
+        if limit is not None and len(payload) > limit:
+            return None
+        tables = []
+        if not self.sent[table]:
+            tables.append(bytearray([table] + self.lengths[table]))
+            self.sent[table] = True
+        return tables, payload, table == TABLE_PIXELS
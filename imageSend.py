@@ -1,14 +1,52 @@
 #Import necessary libraries
-import serial, time, os, sys
+import serial, time, os, sys, argparse, threading
 from subprocess import call, Popen
+import hostframe, hostlink, planecodec, scalecodec
+from ratecontrol import RateController
+from streamenc import StreamEncoder, CODECS
 
 #Set serial baud rate
 baud = 1500000
-flag = 0
 #Initialize number of dropped frames
 dropped = 0
 proc = 0
 comPort='COM9'
+#Parse the command line
+parser = argparse.ArgumentParser(description='Stream video to the LM3S6965 OLED display')
+parser.add_argument('mode', nargs='?', help='f to play a file, c to use the camera')
+parser.add_argument('filename', nargs='?', help='video file to play in mode f')
+parser.add_argument('--port', default=comPort, help='serial port of the board')
+parser.add_argument('--codec', choices=CODECS, default='block',
+                    help='frame encoding (default block)')
+parser.add_argument('--keyint', type=int, default=60,
+                    help='frames between raw keyframes, 0 to only send them on request')
+parser.add_argument('--draw-planes', type=int, default=1,
+                    help='with --codec planes, bit-planes received between redraws')
+parser.add_argument('--scale', choices=sorted(scalecodec.SIZES), default='64x48',
+                    help='with --codec scaled, the size frames are sent at')
+parser.add_argument('--filter', action='store_true',
+                    help='with --codec scaled, interpolate rather than repeat pixels')
+parser.add_argument('--refresh', action='store_true',
+                    help='with --codec block, refresh a band of every frame rather than send keyframes')
+parser.add_argument('--scroll', action='store_true',
+                    help='send frames that are the last one moved up as scroll frames')
+parser.add_argument('--cache', action='store_true',
+                    help='keep frames that come round again on the device and show them from there')
+parser.add_argument('--fps', type=float,
+                    help='send frames at this steady rate, dropping detail to stay within the link rate')
+parser.add_argument('--pts', action='store_true',
+                    help='time every frame so the board shows it on time, in step with the sound')
+parser.add_argument('--latency', type=int, default=100,
+                    help='with --pts, milliseconds the board holds frames to smooth out the link (default 100)')
+parser.add_argument('--stamp', action='store_true',
+                    help='stamp every frame and print where the time goes from capture to display')
+parser.add_argument('--profile', action='store_true',
+                    help='on exit print the cycles spent in the firmware\'s hot paths (needs firmware built with PROFILE=1)')
+parser.add_argument('--bitrate', type=int,
+                    help='link bits per second the stream must fit in (default the baud rate)')
+args = parser.parse_args()
+#Fields are half the size of frames, so twice as many are sent
+fps = args.fps or (34 if args.codec == 'field' else 17)
 #Move into the imageConv directory
 os.chdir('./imageConv')
 #Delete all existing pnm images
@@ -16,98 +54,95 @@ for file in os.listdir("./"):
         if file.endswith(".pgm"):
                 os.remove(file)
 #Convert the specified input file
-if len(sys.argv) > 1:
-    if sys.argv[1] == 'f':
-        if len(sys.argv) > 2:
-            ret =call('ffmpeg -i '+sys.argv[2]+' -s 128x96 -r 17 -threads 8 -loglevel panic out%05d.pgm')
-        else:
-            ret = 1
-    elif sys.argv[1] == 'c':
-        proc = Popen('ffmpeg -f dshow -i video="FaceTime HD Camera (Built-in)" -s 128x96  -loglevel panic -updatefirst 1 out%05d.pgm')
-        ret =0
+if args.mode == 'f':
+    if args.filename:
+        ret =call('ffmpeg -i '+args.filename+' -s 128x96 -r '+str(fps)+' -threads 8 -loglevel panic out%05d.pgm')
     else:
         ret = 1
+elif args.mode == 'c':
+    proc = Popen('ffmpeg -f dshow -i video="FaceTime HD Camera (Built-in)" -s 128x96  -loglevel panic -updatefirst 1 out%05d.pgm')
+    ret =0
 else:
     ret = 1
 
 #Check if the conversion was successful
 if ret ==0 :
+        #Control the rate when a frame rate or bit rate is asked for
+        rate = None
+        if args.fps or args.bitrate:
+            rate = RateController(fps, args.bitrate or baud)
+        #Create the encoder that tracks the device's reference frame
+        encoder = StreamEncoder(args.codec, args.keyint, args.draw_planes,
+                                args.scale, args.filter, rate, args.refresh,
+                                args.scroll, args.cache, args.latency)
+        #Let codecs that train on the whole clip do so before playback starts
+        if args.mode == 'f' and encoder.needs_clip:
+            clip = [hostframe.read_pgm(file) for file in hostframe.list_frames()]
+            encoder.pretrain([hostframe.pack(pixels) for pixels in clip if pixels])
+        reader = None
         #Catch keyboard interrupts
         try:
                 #Start the serial connection
-                ser = serial.Serial(comPort,baud)
-                #Blank the write array
-                toWrite = ''
+                ser = serial.Serial(args.port,baud)
+                #Collect decode reports sent back by the board
+                reader = hostlink.ReportReader(ser, encoder)
+                reader.start()
+                #Start the firmware's probes from zero
+                if args.profile:
+                    hostlink.read_profile(ser, reader, True)
+                started = time.time()
+                #Time the next frame is due when pacing frames
+                due = time.time()
+                #Frames into the stream, which times them with --pts
+                count = 0
                 #Loop until interrupt
                 while 1:
                         #Check if we are playing a file
-                        if sys.argv[1] == 'f':
-                            #Run a player to view video output/ play sound if it exists
-                            Popen('ffplay -autoexit -loglevel panic '+sys.argv[2])
-                        #Loop through all pgm files in directory
-                        for file in os.listdir("./"):
-                                if file.endswith(".pgm"):
-                                        #Open the file
-                                        f = open(file,'rb')
-                                        for x in range(0,3):
-                                                f.readline()
-                                        #Add start byte to serial array
-                                        toWrite+=chr(0xFF)
-                                        #Loop though each pixel
-                                        for x in range(0,96):
-                                                for y in range(0,64):
-                                                        #Read pixel A [l]
-                                                        pixA = f.read(1)
-                                                        #Detect dropped frame
-                                                        if len(pixA)>0:
-                                                            l = ord(pixA)
-                                                        else:
-                                                            flag =1
-                                                            break
-                                                        #Set pixel A to luminence value
-                                                        nibH = int(l)
-                                                        #Read pixel B [l]
-                                                        pixB = f.read(1)
-                                                        #Detect dropped frame
-                                                        if len(pixB)>0:
-                                                            l = ord(pixB)
-                                                        else:
-                                                            flag =1
-                                                            break
-                                                        #Set pixel B to luminence value
-                                                        nibL = int(l)
-                                                        #Combine nibles to form two pixel byte
-                                                        byte = nibH &0xf0 | (nibL >>4)
-                                                        #Remove start byte if it occurs
-                                                        if byte ==0xFF:
-                                                                byte = 0xEE
-                                                        #Add byte to serial array
-                                                        toWrite+=chr(byte)
-                                                        if flag:
-                                                            break
-                                                if flag:
-                                                    flag =0
-                                                    f.close()
-                                                    dropped +=1
-                                                    break
-                                        #Send the serial array
-                                        ser.write(toWrite)
-                                        #Blank the serial array
-                                        toWrite = ''
-                                        #Close the file
-                                        f.close()
+                        if args.mode == 'f':
+                            #Run a player to view video output/ play sound if it exists,
+                            #held back by the latency the board shows timed frames with
+                            player = 'ffplay -autoexit -loglevel panic '+args.filename
+                            if args.pts:
+                                threading.Timer(args.latency / 1000.0, Popen, [player]).start()
+                            else:
+                                Popen(player)
+                        #Loop through all pgm files in directory in frame order
+                        for file in hostframe.list_frames():
+                                #Read the luminance of each pixel
+                                pixels = hostframe.read_pgm(file)
+                                read = time.time()
+                                pts = 1000.0 * count / fps if args.pts else None
+                                count += 1
+                                #Detect dropped frame
+                                if pixels is None:
+                                    dropped +=1
+                                    continue
+                                #Send less while more than a bit-plane is
+                                #still waiting to go out
+                                encoder.congested = (hostlink.backlog(ser) >
+                                                     planecodec.PLANE_BYTES)
+                                #Combine nibbles to form two pixel bytes, encode
+                                #and send the frame
+                                data = encoder.packet(hostframe.pack(pixels), pts)
+                                #Send frames at a steady rate, catching up
+                                #by at most a frame after a stall; timed
+                                #frames must not get ahead of the board
+                                if rate or args.pts:
+                                    due = max(due + 1.0 / fps, time.time() - 1.0 / fps)
+                                    delay = due - time.time()
+                                    if delay > 0:
+                                        time.sleep(delay)
+                                #Stamp the frame with when ffmpeg wrote the
+                                #picture, which only the camera writes as it
+                                #goes, and when it was read
+                                if args.stamp and data:
+                                    captured = os.path.getmtime(file) if args.mode == 'c' else None
+                                    data = reader.latency.stamp(captured, read) + data
+                                ser.write(data)
         #If a keyboard interrupt occurs, handle it
         except KeyboardInterrupt:
-            #Close the open file
-            f.close()
-            #Blank the serial array
-            toWrite = ''
-            #Add start byte
-            toWrite+=chr(0xFF)
             #Create black screen
-            for x in range(0,96):
-                    for y in range(0,64):
-                            toWrite+=chr(0)
+            toWrite = hostlink.packet(hostlink.PKT_RAW, hostframe.black())
             #Send black screen
             ser.write(toWrite)
 
@@ -124,11 +159,43 @@ if ret ==0 :
                 proc.kill()
             sys.exit('Error: Serial Error. Please check that the board is connected');
 
-        #Close the serial connection
+        #Let the last reports arrive, then read the firmware's probes and close
+        #the serial connection
+        time.sleep(0.2)
+        profile = args.profile and hostlink.read_profile(ser, reader)
         ser.close()
+        #Print the decode statistics reported by the board
+        if reader and reader.stats.types:
+            print(reader.stats.summary())
+        if reader and reader.cache:
+            print('Frame cache: %d shown, %d not held, %d stored, %d dropped, '
+                  '%d frames in %d bytes' % reader.cache)
+        #Print the startup timeline if the board was reset while sending
+        if reader and reader.boot:
+            print('Board started: ' + ', '.join(
+                '%s %.1f ms' % (step, 1000.0 * cycles / hostlink.CPU_HZ)
+                for step, cycles in zip(hostlink.BOOT_STEPS, reader.boot)))
+        #Print the cycles the firmware spent in its hot paths
+        if args.profile:
+            if profile:
+                print('%-18s %9s %8s %8s %8s %7s' % ('probe', 'runs', 'min', 'mean', 'max', 'ms/s'))
+                for name, (runs, fewest, most, total) in zip(hostlink.PROFILE_PROBES, profile):
+                    print('%-18s %9d %8d %8.0f %8d %7.1f' %
+                          (name, runs, fewest, float(total) / max(runs, 1), most,
+                           1000.0 * total / hostlink.CPU_HZ / max(time.time() - started, 1e-3)))
+            else:
+                print('No profile: the board was not built with PROFILE=1')
+        #Print where the time went for stamped frames
+        if reader and args.stamp:
+            print(reader.latency.summary())
+        #Print the packet types the auto codec chose
+        if encoder.chosen:
+            print('Chose '+encoder.choices())
         #Print exit message
         if dropped:
             print('Frames dropped:'+str(dropped))
+        if rate and rate.skipped:
+            print('Frames skipped to stay within the link rate:'+str(rate.skipped))
         print('Closed -- exit')
 #If the conversion was not successful, exit and print an error
 else:
@@ -0,0 +1,188 @@
+//*****************************************************************************
+//
+// latency.c - Times of the stages a stamped frame goes through on the board.
+//
+// To find where the time between a picture being captured and it showing on
+// the display goes, the host can send a stamp packet before a frame's first
+// packet
+//
+//   bytes 0-3     sequence number
+//   bytes 4-7     the host's time the frame was sent, in microseconds
+//
+// and the board answers once the frame is drawn, or dropped, with a
+// LINK_RPT_LATENCY report of the time each stage took:
+//
+//   bytes 0-3     sequence number, as sent
+//   bytes 4-7     the host's time, as sent
+//   bytes 8-11    cycles from the stamp arriving to the frame arriving
+//   bytes 12-15   cycles decoding the frame
+//   bytes 16-19   cycles the frame waited to be drawn, for its time or
+//                 behind the packets before it
+//   bytes 20-23   cycles drawing the frame, to the last byte leaving the SSI
+//
+// Bytes 16-23 are zero for frames that were not drawn.  The host times the
+// report coming back, so the time spent reaching the board is what remains
+// of the round trip.
+//
+//*****************************************************************************
+
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "my_ssi.h"
+#include "cyclecount.h"
+#include "video.h"
+#include "link.h"
+#include "latency.h"
+
+//*****************************************************************************
+//
+// The stamp for the next frame and the cycle count it arrived at, and whether
+// one was sent.
+//
+//*****************************************************************************
+static tBoolean g_bLatencyStamped;
+static unsigned char g_pucLatencyStamp[8];
+static unsigned long g_ulLatencyStamp;
+
+//*****************************************************************************
+//
+// The stamped frame waiting to be drawn: whether there is one, and the cycle
+// counts at which it arrived and was decoded.
+//
+//*****************************************************************************
+static tBoolean g_bLatencyWait;
+static unsigned long g_ulLatencyReceived;
+static unsigned long g_ulLatencyDecoded;
+
+//*****************************************************************************
+//
+// Sends the report for the stamped frame, with the time it took to draw it
+// if it was drawn.
+//
+//*****************************************************************************
+static void
+LatencyReport(unsigned long ulWait, unsigned long ulDraw)
+{
+    unsigned char pucReport[24];
+    unsigned long pulCount[4];
+    unsigned long ulIdx;
+
+    g_bLatencyWait = false;
+    pulCount[0] = g_ulLatencyReceived - g_ulLatencyStamp;
+    pulCount[1] = g_ulLatencyDecoded - g_ulLatencyReceived;
+    pulCount[2] = ulWait;
+    pulCount[3] = ulDraw;
+    for(ulIdx = 0; ulIdx < 8; ulIdx++)
+    {
+        pucReport[ulIdx] = g_pucLatencyStamp[ulIdx];
+    }
+    for(ulIdx = 0; ulIdx < 4; ulIdx++)
+    {
+        pucReport[(ulIdx * 4) + 8] = pulCount[ulIdx];
+        pucReport[(ulIdx * 4) + 9] = pulCount[ulIdx] >> 8;
+        pucReport[(ulIdx * 4) + 10] = pulCount[ulIdx] >> 16;
+        pucReport[(ulIdx * 4) + 11] = pulCount[ulIdx] >> 24;
+    }
+    LinkReport(LINK_RPT_LATENCY, pucReport, sizeof(pucReport));
+}
+
+//*****************************************************************************
+//
+//! Takes the stamp for the next frame from a stamp packet.
+//!
+//! \param pucData is a pointer to the stamp packet.
+//! \param ulLength is the number of bytes in the packet.
+//! \param ulReceived is the cycle count at which the packet arrived.
+//!
+//! A malformed packet is ignored.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LatencyStamp(const unsigned char *pucData, unsigned long ulLength,
+             unsigned long ulReceived)
+{
+    unsigned long ulIdx;
+
+    if(ulLength != sizeof(g_pucLatencyStamp))
+    {
+        return;
+    }
+    for(ulIdx = 0; ulIdx < sizeof(g_pucLatencyStamp); ulIdx++)
+    {
+        g_pucLatencyStamp[ulIdx] = pucData[ulIdx];
+    }
+    g_ulLatencyStamp = ulReceived;
+    g_bLatencyStamped = true;
+}
+
+//*****************************************************************************
+//
+//! Times the frame packet just decoded, if the host stamped it.
+//!
+//! \param ulReceived is the cycle count at which the packet arrived.
+//!
+//! This must be called straight after every frame packet is decoded.  A
+//! packet that leaves no frame to draw is reported at once.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LatencyDecoded(unsigned long ulReceived)
+{
+    if(!g_bLatencyStamped)
+    {
+        return;
+    }
+    g_bLatencyStamped = false;
+    g_ulLatencyDecoded = CycleCountGet();
+    g_ulLatencyReceived = ulReceived;
+    g_bLatencyWait = true;
+    if(!VideoPending())
+    {
+        LatencyReport(0, 0);
+    }
+}
+
+//*****************************************************************************
+//
+//! Reports the stamped frame, if it is the one just drawn.
+//!
+//! \param ulStart is the cycle count at which drawing started.
+//!
+//! This is called by VideoPresent() once the frame has been written to the
+//! SSI.  The display drivers return with the last few bytes still in the SSI
+//! transmit FIFO, so a stamped frame is timed to the SSI going idle.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LatencyDrawn(unsigned long ulStart)
+{
+    if(g_bLatencyWait)
+    {
+        while(SSIBusy(SSI0_BASE))
+        {
+        }
+        LatencyReport(ulStart - g_ulLatencyDecoded, CycleCountGet() - ulStart);
+    }
+}
+
+//*****************************************************************************
+//
+//! Reports the stamped frame as not drawn, if it is the one just dropped.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LatencySkipped(void)
+{
+    if(g_bLatencyWait)
+    {
+        LatencyReport(0, 0);
+    }
+}
@@ -0,0 +1,21 @@
+//*****************************************************************************
+//
+// latency.h - Times of the stages a stamped frame goes through on the board.
+//
+//*****************************************************************************
+
+#ifndef __LATENCY_H__
+#define __LATENCY_H__
+
+//*****************************************************************************
+//
+// Prototypes for the latency measurement APIs.
+//
+//*****************************************************************************
+extern void LatencyStamp(const unsigned char *pucData, unsigned long ulLength,
+                         unsigned long ulReceived);
+extern void LatencyDecoded(unsigned long ulReceived);
+extern void LatencyDrawn(unsigned long ulStart);
+extern void LatencySkipped(void);
+
+#endif // __LATENCY_H__
@@ -0,0 +1,462 @@
+//*****************************************************************************
+//
+// link.c - Packet framing for the serial video link.
+//
+// Received bytes are handed to LinkRxChar() from the UART interrupt handler,
+// which strips the framing and stores the payload in a receive ring.  Each
+// payload is kept in one piece, word aligned, wherever it fits after the
+// packets still waiting, going back to the start of the ring when it does not
+// fit at the end.  While the main loop works on one completed packet the
+// following ones keep arriving, so the link is never stalled by decoding, and
+// as many small packets can wait as fit, which lets frames wait for their
+// time to be shown.  A packet that finds no room is dropped and counted as a
+// link error.  The cycle count at which each packet's last byte arrived is
+// kept with it, so a packet that waited can still be timed.
+//
+// Reports to the host are queued in a small transmit ring and drained into
+// the UART FIFO by the transmit interrupt.
+//
+//*****************************************************************************
+
+#include "inc/hw_ints.h"
+#include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "cyclecount.h"
+#include "my_uart.h"
+#include "link.h"
+
+//*****************************************************************************
+//
+// The size of the receive ring, room for two of the largest packets, the most
+// packets that can wait in it and the size of the transmit ring.  The
+// transmit ring size must be a power of two.
+//
+//*****************************************************************************
+#define LINK_RX_BYTES           (2 * ((LINK_MAX_PAYLOAD + 3) & ~3))
+#define LINK_RX_PACKETS         16
+#define LINK_TX_SIZE            256
+
+//*****************************************************************************
+//
+// States of the receive parser.
+//
+//*****************************************************************************
+#define LINK_STATE_IDLE         0           // Waiting for a sync byte
+#define LINK_STATE_TYPE         1           // Expecting the packet type
+#define LINK_STATE_LEN_LO       2           // Expecting the length low byte
+#define LINK_STATE_LEN_HI       3           // Expecting the length high byte
+#define LINK_STATE_PAYLOAD      4           // Receiving payload bytes
+
+//*****************************************************************************
+//
+// The receive ring and the type, offset, length and arrival cycle count of
+// each packet waiting in it.  g_ulRxHead is only written by the interrupt
+// handler and g_ulRxTail only by the main loop; both count packets and are
+// never wrapped, so their difference is the number of packets waiting to be
+// processed.  g_ulRxWrite is the offset in the ring just past the newest
+// packet.
+//
+//*****************************************************************************
+static unsigned long g_pulRxRing[LINK_RX_BYTES / 4];
+static unsigned char g_pucRxType[LINK_RX_PACKETS];
+static unsigned long g_pulRxOffset[LINK_RX_PACKETS];
+static unsigned long g_pulRxLength[LINK_RX_PACKETS];
+static unsigned long g_pulRxTime[LINK_RX_PACKETS];
+static volatile unsigned long g_ulRxHead;
+static volatile unsigned long g_ulRxTail;
+static unsigned long g_ulRxWrite;
+
+//*****************************************************************************
+//
+// Receive parser state.
+//
+//*****************************************************************************
+static unsigned long g_ulRxState;
+static tBoolean g_bRxEscape;
+static unsigned char g_ucRxType;
+static unsigned long g_ulRxOffset;
+static unsigned long g_ulRxLength;
+static unsigned long g_ulRxCount;
+static unsigned char *g_pucRxData;
+static volatile unsigned long g_ulRxErrors;
+
+//*****************************************************************************
+//
+// The bytes of the receive ring a payload takes.  Every packet takes at least
+// a word, so a ring with packets waiting never looks empty.
+//
+//*****************************************************************************
+#define LINK_RX_SPACE(ulLength) (((ulLength) + 3 + !(ulLength)) & ~3)
+
+//*****************************************************************************
+//
+// Transmit ring, indexed the same way as the receive packets.
+//
+//*****************************************************************************
+static unsigned char g_pucTxBuffer[LINK_TX_SIZE];
+static volatile unsigned long g_ulTxHead;
+static volatile unsigned long g_ulTxTail;
+
+//*****************************************************************************
+//
+//! Resets the link to its idle state.
+//!
+//! Any partially received packet, any packets waiting to be processed and any
+//! queued reports are discarded.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LinkInit(void)
+{
+    g_ulRxHead = 0;
+    g_ulRxTail = 0;
+    g_ulRxState = LINK_STATE_IDLE;
+    g_bRxEscape = false;
+    g_ulRxErrors = 0;
+    g_ulRxWrite = 0;
+    g_pucRxData = (unsigned char *)g_pulRxRing;
+    g_ulTxHead = 0;
+    g_ulTxTail = 0;
+}
+
+//*****************************************************************************
+//
+// Finds room in the receive ring for a payload, after the packets waiting.
+// Returns the offset of the room or -1 if there is none.
+//
+//*****************************************************************************
+static long
+LinkRxPlace(unsigned long ulLength)
+{
+    unsigned long ulTail, ulRead, ulSpace;
+
+    //
+    // The main loop may release packets meanwhile, which only makes more
+    // room, so the tail is read once.
+    //
+    ulTail = g_ulRxTail;
+    if((g_ulRxHead - ulTail) >= LINK_RX_PACKETS)
+    {
+        return(-1);
+    }
+    if(g_ulRxHead == ulTail)
+    {
+        return(0);
+    }
+
+    //
+    // Until the packets wrap the room is after the newest packet or before
+    // the oldest; after it is between the newest and the oldest.
+    //
+    ulRead = g_pulRxOffset[ulTail % LINK_RX_PACKETS];
+    ulSpace = LINK_RX_SPACE(ulLength);
+    if(g_ulRxWrite > ulRead)
+    {
+        if((g_ulRxWrite + ulSpace) <= LINK_RX_BYTES)
+        {
+            return(g_ulRxWrite);
+        }
+        return((ulSpace <= ulRead) ? 0 : -1);
+    }
+    return(((g_ulRxWrite + ulSpace) <= ulRead) ? (long)g_ulRxWrite : -1);
+}
+
+//*****************************************************************************
+//
+//! Feeds one received character into the packet parser.
+//!
+//! \param ucChar is the character read from the UART.
+//!
+//! This function is called from the UART interrupt handler for every received
+//! character.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LinkRxChar(unsigned char ucChar)
+{
+    unsigned long ulSlot;
+    long lOffset;
+
+    //
+    // A sync byte always starts a new packet.  If one arrives in the middle
+    // of a packet the partial packet is abandoned.
+    //
+    if(ucChar == LINK_SYNC)
+    {
+        if(g_ulRxState != LINK_STATE_IDLE)
+        {
+            g_ulRxErrors++;
+        }
+        g_ulRxState = LINK_STATE_TYPE;
+        g_bRxEscape = false;
+        return;
+    }
+
+    //
+    // Ignore everything up to the next sync byte.
+    //
+    if(g_ulRxState == LINK_STATE_IDLE)
+    {
+        return;
+    }
+
+    //
+    // Undo the escaping of 0xFE and 0xFF.
+    //
+    if(g_bRxEscape)
+    {
+        g_bRxEscape = false;
+        if(ucChar > 1)
+        {
+            g_ulRxErrors++;
+            g_ulRxState = LINK_STATE_IDLE;
+            return;
+        }
+        ucChar += LINK_ESCAPE;
+    }
+    else if(ucChar == LINK_ESCAPE)
+    {
+        g_bRxEscape = true;
+        return;
+    }
+
+    switch(g_ulRxState)
+    {
+        case LINK_STATE_TYPE:
+        {
+            g_ucRxType = ucChar;
+            g_ulRxState = LINK_STATE_LEN_LO;
+            return;
+        }
+
+        case LINK_STATE_LEN_LO:
+        {
+            g_ulRxLength = ucChar;
+            g_ulRxState = LINK_STATE_LEN_HI;
+            return;
+        }
+
+        case LINK_STATE_LEN_HI:
+        {
+            g_ulRxLength |= (unsigned long)ucChar << 8;
+            if(g_ulRxLength > LINK_MAX_PAYLOAD)
+            {
+                g_ulRxErrors++;
+                g_ulRxState = LINK_STATE_IDLE;
+                return;
+            }
+            lOffset = LinkRxPlace(g_ulRxLength);
+            if(lOffset < 0)
+            {
+                g_ulRxErrors++;
+                g_ulRxState = LINK_STATE_IDLE;
+                return;
+            }
+            g_ulRxOffset = lOffset;
+            g_ulRxCount = 0;
+            g_pucRxData = (unsigned char *)g_pulRxRing + lOffset;
+            g_ulRxState = LINK_STATE_PAYLOAD;
+            if(g_ulRxLength != 0)
+            {
+                return;
+            }
+            break;
+        }
+
+        default:
+        {
+            g_pucRxData[g_ulRxCount++] = ucChar;
+            if(g_ulRxCount < g_ulRxLength)
+            {
+                return;
+            }
+            break;
+        }
+    }
+
+    //
+    // The packet is complete.  Hand it to the main loop.
+    //
+    g_ulRxState = LINK_STATE_IDLE;
+    ulSlot = g_ulRxHead % LINK_RX_PACKETS;
+    g_pucRxType[ulSlot] = g_ucRxType;
+    g_pulRxOffset[ulSlot] = g_ulRxOffset;
+    g_pulRxLength[ulSlot] = g_ulRxLength;
+    g_pulRxTime[ulSlot] = CycleCountGet();
+    g_ulRxWrite = g_ulRxOffset + LINK_RX_SPACE(g_ulRxLength);
+    g_ulRxHead++;
+}
+
+//*****************************************************************************
+//
+//! Returns the oldest received packet, if any.
+//!
+//! \param pucType is a pointer to storage for the packet type.
+//! \param pulLength is a pointer to storage for the payload length.
+//!
+//! The returned payload remains valid until LinkPacketRelease() is called.
+//!
+//! \return Returns a pointer to the payload, or 0 if no packet is waiting.
+//
+//*****************************************************************************
+unsigned char *
+LinkPacketGet(unsigned char *pucType, unsigned long *pulLength)
+{
+    unsigned long ulSlot;
+
+    if(g_ulRxHead == g_ulRxTail)
+    {
+        return(0);
+    }
+
+    ulSlot = g_ulRxTail % LINK_RX_PACKETS;
+    *pucType = g_pucRxType[ulSlot];
+    *pulLength = g_pulRxLength[ulSlot];
+    return((unsigned char *)g_pulRxRing + g_pulRxOffset[ulSlot]);
+}
+
+//*****************************************************************************
+//
+//! Returns when the packet returned by LinkPacketGet() was received.
+//!
+//! \return Returns the cycle count at which the last byte of the packet
+//! arrived, or the current cycle count if no packet is waiting.
+//
+//*****************************************************************************
+unsigned long
+LinkPacketTime(void)
+{
+    if(g_ulRxHead == g_ulRxTail)
+    {
+        return(CycleCountGet());
+    }
+    return(g_pulRxTime[g_ulRxTail % LINK_RX_PACKETS]);
+}
+
+//*****************************************************************************
+//
+//! Releases the packet returned by LinkPacketGet().
+//!
+//! The room in the receive ring holding the packet becomes available to the
+//! interrupt handler again.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LinkPacketRelease(void)
+{
+    if(g_ulRxHead != g_ulRxTail)
+    {
+        g_ulRxTail++;
+    }
+}
+
+//*****************************************************************************
+//
+//! Returns the number of packets lost so far.
+//!
+//! A packet is lost if it was truncated by a sync byte, carried a bad escape
+//! sequence or length, or arrived while the receive ring was full.
+//! Callers compare successive values to find out whether anything has been
+//! lost in between.
+//!
+//! \return Returns the running count of lost packets.
+//
+//*****************************************************************************
+unsigned long
+LinkErrorCountGet(void)
+{
+    return(g_ulRxErrors);
+}
+
+//*****************************************************************************
+//
+//! Moves queued report bytes into the UART transmit FIFO.
+//!
+//! This function is called from the UART interrupt handler when the transmit
+//! interrupt is asserted.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LinkTxService(void)
+{
+    while((g_ulTxTail != g_ulTxHead) && UARTSpaceAvail(UART0_BASE))
+    {
+        UARTCharPutNonBlocking(UART0_BASE,
+                               g_pucTxBuffer[g_ulTxTail % LINK_TX_SIZE]);
+        g_ulTxTail++;
+    }
+}
+
+//*****************************************************************************
+//
+// Appends one escaped byte to the transmit ring.  The caller has already
+// checked that there is room for it.
+//
+//*****************************************************************************
+static void
+LinkTxPut(unsigned char ucChar)
+{
+    if(ucChar >= LINK_ESCAPE)
+    {
+        g_pucTxBuffer[g_ulTxHead++ % LINK_TX_SIZE] = LINK_ESCAPE;
+        ucChar -= LINK_ESCAPE;
+    }
+    g_pucTxBuffer[g_ulTxHead++ % LINK_TX_SIZE] = ucChar;
+}
+
+//*****************************************************************************
+//
+//! Sends a report packet to the host.
+//!
+//! \param ucType is the report type.
+//! \param pucData is a pointer to the report payload.
+//! \param ulLength is the number of payload bytes.
+//!
+//! The report is queued and sent in the background by the UART transmit
+//! interrupt.  If there is not enough room in the transmit ring the report is
+//! silently discarded; reports are advisory and must never stall the video
+//! path.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+LinkReport(unsigned char ucType, const unsigned char *pucData,
+           unsigned long ulLength)
+{
+    unsigned long ulIdx;
+
+    //
+    // Make sure the worst case escaped packet fits.
+    //
+    if((LINK_TX_SIZE - (g_ulTxHead - g_ulTxTail)) < (1 + (2 * (3 + ulLength))))
+    {
+        return;
+    }
+
+    g_pucTxBuffer[g_ulTxHead++ % LINK_TX_SIZE] = LINK_SYNC;
+    LinkTxPut(ucType);
+    LinkTxPut(ulLength & 0xFF);
+    LinkTxPut(ulLength >> 8);
+    for(ulIdx = 0; ulIdx < ulLength; ulIdx++)
+    {
+        LinkTxPut(pucData[ulIdx]);
+    }
+
+    //
+    // Prime the transmit FIFO.  Once it is running the transmit interrupt
+    // keeps it topped up.
+    //
+    IntDisable(INT_UART0);
+    LinkTxService();
+    IntEnable(INT_UART0);
+}
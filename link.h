@@ -0,0 +1,96 @@
+//*****************************************************************************
+//
+// link.h - Packet framing for the serial video link.
+//
+// Every packet on the wire, in either direction, has the form
+//
+//     0xFF <type> <length low> <length high> <payload ...>
+//
+// The 0xFF sync byte never appears anywhere else in the stream; any 0xFE or
+// 0xFF following the sync byte is sent as the escape byte 0xFE followed by
+// 0x00 or 0x01 respectively.  The length counts payload bytes after the
+// escapes have been removed.
+//
+//*****************************************************************************
+
+#ifndef __LINK_H__
+#define __LINK_H__
+
+//*****************************************************************************
+//
+// Framing bytes.
+//
+//*****************************************************************************
+#define LINK_SYNC               0xFF
+#define LINK_ESCAPE             0xFE
+
+//*****************************************************************************
+//
+// The largest payload the receiver will accept.  This is one raw frame plus
+// room for a small header.
+//
+//*****************************************************************************
+#define LINK_MAX_PAYLOAD        (6144 + 64)
+
+//*****************************************************************************
+//
+// Packet types sent from the host to the device.
+//
+//*****************************************************************************
+#define LINK_PKT_RAW            0x00        // Uncompressed 4bpp frame
+#define LINK_PKT_BLOCK          0x01        // 8x8 skip/copy/raw inter frame
+#define LINK_PKT_TILE           0x02        // Tile uploads and a tile map
+#define LINK_PKT_VQ_CODEBOOK    0x03        // VQ codebook entries
+#define LINK_PKT_VQ             0x04        // VQ codebook index per 4x4 block
+#define LINK_PKT_LZ             0x05        // LZ77 literals and matches
+#define LINK_PKT_HUFF_TABLE     0x06        // Huffman code lengths
+#define LINK_PKT_HUFF           0x07        // Huffman coded pixels or residual
+#define LINK_PKT_PLANE          0x08        // One bit-plane of a frame
+#define LINK_PKT_DEPTH          0x09        // 1bpp or 2bpp frame and palette
+#define LINK_PKT_SCALED         0x0A        // Half size frame, scaled up
+#define LINK_PKT_FIELD          0x0B        // Even or odd rows of a frame
+#define LINK_PKT_REFRESH        0x0C        // Block frame, one band intra
+#define LINK_PKT_DRAW           0x0D        // Drawing commands
+#define LINK_PKT_TEXT           0x0E        // Text console characters
+#define LINK_PKT_SPRITE_IMAGE   0x0F        // Sprite image upload
+#define LINK_PKT_SPRITE         0x10        // Sprite positions
+#define LINK_PKT_SCROLL         0x11        // Rows added below a scroll
+#define LINK_PKT_LAYOUT         0x12        // Window rectangles
+#define LINK_PKT_WINDOW         0x13        // Changed cells of one window
+#define LINK_PKT_CLIP           0x14        // Clip storage command
+#define LINK_PKT_CACHE_STORE    0x15        // Keep the frame shown under an id
+#define LINK_PKT_CACHE_SHOW     0x16        // Show a kept frame
+#define LINK_PKT_TIME           0x17        // Presentation time of next frame
+#define LINK_PKT_SYNC           0x18        // Host clock, for a video wall
+#define LINK_PKT_STAMP          0x19        // Sequence number of next frame
+#define LINK_PKT_PROFILE        0x1A        // Read a profiling probe
+
+//*****************************************************************************
+//
+// Report types sent from the device back to the host.
+//
+//*****************************************************************************
+#define LINK_RPT_FRAME          0x80        // Per-frame decode statistics
+#define LINK_RPT_CLIP           0x81        // Clip storage command done
+#define LINK_RPT_CACHE          0x82        // Frame cache counters
+#define LINK_RPT_BOOT           0x83        // Startup timeline
+#define LINK_RPT_LATENCY        0x84        // Stage times of a stamped frame
+#define LINK_RPT_PROFILE        0x85        // Cycle counts of a probe
+
+//*****************************************************************************
+//
+// Prototypes for the link APIs.
+//
+//*****************************************************************************
+extern void LinkInit(void);
+extern void LinkRxChar(unsigned char ucChar);
+extern void LinkTxService(void);
+extern unsigned char *LinkPacketGet(unsigned char *pucType,
+                                    unsigned long *pulLength);
+extern unsigned long LinkPacketTime(void);
+extern void LinkPacketRelease(void);
+extern unsigned long LinkErrorCountGet(void);
+extern void LinkReport(unsigned char ucType, const unsigned char *pucData,
+                       unsigned long ulLength);
+
+#endif // __LINK_H__
@@ -0,0 +1,175 @@
+//*****************************************************************************
+//
+// lzcodec.c - Decoder for the LZ77 style frame codec.
+//
+// An LZ frame is a sequence of literal runs and matches in the style of LZ4.
+// Each sequence is
+//
+//   token          bits 7:4 literal count, bits 3:0 match length - 4
+//   extra bytes    if the literal count is 15, bytes added to it until one
+//                  is less than 255
+//   literals       the literal bytes
+//   offset         two bytes, little endian, distance back to the match
+//   extra bytes    as for the literal count, if the match length field is 15
+//
+// The final sequence of a frame has literals only and ends with the payload.
+//
+// Matches reach back into the frame being decoded and, beyond its start,
+// into the previous frame as if the two were stored end to end; an offset of
+// exactly FRAME_BYTES copies the same position of the previous frame.  A
+// match may not run from the previous frame into the current one.  Frames
+// that make no reference to the previous frame decode without one, so they
+// serve as keyframes.
+//
+// No memory is used beyond the two frame slots.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <string.h>
+#include "video.h"
+#include "lzcodec.h"
+
+//*****************************************************************************
+//
+// Adds the extension bytes of a literal count or match length to *pulCount.
+// Returns 0 on success or -1 if the data ends first.
+//
+//*****************************************************************************
+static long
+LZLengthRead(const unsigned char **ppucData, const unsigned char *pucEnd,
+             unsigned long *pulCount)
+{
+    unsigned char ucByte;
+
+    do
+    {
+        if(*ppucData == pucEnd)
+        {
+            return(-1);
+        }
+        ucByte = *(*ppucData)++;
+        *pulCount += ucByte;
+    }
+    while(ucByte == 255);
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Decodes an LZ frame.
+//!
+//! \param pucData is a pointer to the encoded frame.
+//! \param ulLength is the number of bytes of encoded data.
+//! \param pucRef is the previous frame, or 0 if none is available.
+//! \param pucFrame is the frame slot to decode into; it must not be the same
+//! as \e pucRef.
+//!
+//! \return Returns 0 on success or -1 if the encoded data is malformed or
+//! refers to the previous frame when \e pucRef is 0, in which case the
+//! contents of \e pucFrame are undefined.
+//
+//*****************************************************************************
+long
+LZDecode(const unsigned char *pucData, unsigned long ulLength,
+         const unsigned char *pucRef, unsigned char *pucFrame)
+{
+    const unsigned char *pucEnd, *pucSrc;
+    unsigned char *pucDst, *pucFrameEnd;
+    unsigned long ulToken, ulCount, ulOffset, ulPos;
+
+    pucEnd = pucData + ulLength;
+    pucDst = pucFrame;
+    pucFrameEnd = pucFrame + FRAME_BYTES;
+
+    while(pucData != pucEnd)
+    {
+        //
+        // Copy the literal run.
+        //
+        ulToken = *pucData++;
+        ulCount = ulToken >> 4;
+        if((ulCount == LZ_LENGTH_EXTEND) &&
+           (LZLengthRead(&pucData, pucEnd, &ulCount) != 0))
+        {
+            return(-1);
+        }
+        if((ulCount > (unsigned long)(pucEnd - pucData)) ||
+           (ulCount > (unsigned long)(pucFrameEnd - pucDst)))
+        {
+            return(-1);
+        }
+        memcpy(pucDst, pucData, ulCount);
+        pucDst += ulCount;
+        pucData += ulCount;
+
+        //
+        // The last sequence has no match.
+        //
+        if(pucData == pucEnd)
+        {
+            break;
+        }
+
+        //
+        // Read the match.
+        //
+        if((pucEnd - pucData) < 2)
+        {
+            return(-1);
+        }
+        ulOffset = pucData[0] | (pucData[1] << 8);
+        pucData += 2;
+        ulCount = ulToken & LZ_LENGTH_EXTEND;
+        if((ulCount == LZ_LENGTH_EXTEND) &&
+           (LZLengthRead(&pucData, pucEnd, &ulCount) != 0))
+        {
+            return(-1);
+        }
+        ulCount += LZ_MIN_MATCH;
+        ulPos = pucDst - pucFrame;
+        if((ulOffset == 0) || (ulCount > (FRAME_BYTES - ulPos)))
+        {
+            return(-1);
+        }
+
+        if(ulOffset <= ulPos)
+        {
+            //
+            // A match in the current frame may overlap its own output, which
+            // repeats the last ulOffset bytes; that has to go a byte at a
+            // time.
+            //
+            pucSrc = pucDst - ulOffset;
+            if(ulOffset >= ulCount)
+            {
+                memcpy(pucDst, pucSrc, ulCount);
+                pucDst += ulCount;
+            }
+            else
+            {
+                while(ulCount--)
+                {
+                    *pucDst++ = *pucSrc++;
+                }
+            }
+        }
+        else
+        {
+            //
+            // A match in the previous frame.
+            //
+            ulOffset -= ulPos;
+            if((pucRef == 0) || (ulOffset > FRAME_BYTES) ||
+               (ulCount > ulOffset))
+            {
+                return(-1);
+            }
+            memcpy(pucDst, pucRef + FRAME_BYTES - ulOffset, ulCount);
+            pucDst += ulCount;
+        }
+    }
+
+    return((pucDst == pucFrameEnd) ? 0 : -1);
+}
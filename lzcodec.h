@@ -0,0 +1,28 @@
+//*****************************************************************************
+//
+// lzcodec.h - Decoder for the LZ77 style frame codec.
+//
+//*****************************************************************************
+
+#ifndef __LZCODEC_H__
+#define __LZCODEC_H__
+
+//*****************************************************************************
+//
+// Sequence encoding.  Each token byte holds the literal count in bits 7:4
+// and the match length less LZ_MIN_MATCH in bits 3:0; a field of
+// LZ_LENGTH_EXTEND is continued in following bytes.
+//
+//*****************************************************************************
+#define LZ_MIN_MATCH            4
+#define LZ_LENGTH_EXTEND        15
+
+//*****************************************************************************
+//
+// Prototypes for the LZ codec APIs.
+//
+//*****************************************************************************
+extern long LZDecode(const unsigned char *pucData, unsigned long ulLength,
+                     const unsigned char *pucRef, unsigned char *pucFrame);
+
+#endif // __LZCODEC_H__
@@ -0,0 +1,100 @@
+#Encoder for the LZ77 style frame codec decoded by lzcodec.c on the device
+from hostframe import FRAME_BYTES
+
+#Sequence encoding, matching lzcodec.h
+MIN_MATCH = 4
+LENGTH_EXTEND = 15
+
+#Most earlier occurrences of a 4 byte string tried when looking for a match
+MAX_CHAIN = 8
+#Bytes compared at once when extending a match
+CHUNK = 32
+
+
+def extend(n):
+    """Continuation bytes for a literal count or match length field"""
+    out = bytearray()
+    while n >= 255:
+        out.append(255)
+        n -= 255
+    out.append(n)
+    return out
+
+
+def sequence(literals, offset=0, length=0):
+    """One token with its literals and, unless length is 0, a match"""
+    lit = min(len(literals), LENGTH_EXTEND)
+    match = min(length - MIN_MATCH, LENGTH_EXTEND) if length else 0
+    out = bytearray([lit << 4 | match])
+    if lit == LENGTH_EXTEND:
+        out += extend(len(literals) - LENGTH_EXTEND)
+    out += literals
+    if length:
+        out += bytearray([offset & 0xFF, offset >> 8])
+        if match == LENGTH_EXTEND:
+            out += extend(length - MIN_MATCH - LENGTH_EXTEND)
+    return out
+
+
+def match_length(buf, src, pos, limit):
+    """Number of bytes, up to limit, for which buf matches at src and pos"""
+    n = 0
+    while n + CHUNK <= limit and buf[src + n:src + n + CHUNK] == buf[pos + n:pos + n + CHUNK]:
+        n += CHUNK
+    while n < limit and buf[src + n] == buf[pos + n]:
+        n += 1
+    return n
+
+
+class LZEncoder(object):
+    """Greedy LZ77 encoder searching the current and previous frame"""
+
+    def encode(self, frame, ref=None):
+        """Encode a frame, with matches into ref if it is given.  Without ref
+        the frame decodes on its own."""
+        if ref is None:
+            base = 0
+            buf = bytes(frame)
+        else:
+            #The decoder sees the previous frame followed by the current one
+            base = FRAME_BYTES
+            buf = bytes(ref) + bytes(frame)
+        end = len(buf)
+        chains = {}
+        for i in range(base - MIN_MATCH + 1):
+            chains.setdefault(buf[i:i + MIN_MATCH], []).append(i)
+
+        out = bytearray()
+        start = pos = base
+        while pos <= end - MIN_MATCH:
+            key = buf[pos:pos + MIN_MATCH]
+            chain = chains.setdefault(key, [])
+            best = 0
+            src = 0
+            #The same position in the previous frame is the most likely match
+            candidates = chain[-MAX_CHAIN:]
+            if base and (pos - base) not in candidates:
+                candidates.append(pos - base)
+            for s in reversed(candidates):
+                #Matches may not run out of the previous frame
+                limit = end - pos
+                if s < base:
+                    limit = min(limit, base - s)
+                n = match_length(buf, s, pos, limit)
+                if n > best:
+                    best = n
+                    src = s
+                    if n == limit:
+                        break
+            if best < MIN_MATCH:
+                chain.append(pos)
+                pos += 1
+                continue
+            out += sequence(buf[start:pos], pos - src, best)
+            for i in range(pos, min(pos + best, end - MIN_MATCH + 1)):
+                chains.setdefault(buf[i:i + MIN_MATCH], []).append(i)
+            pos += best
+            start = pos
+        if start < end:
+            out += sequence(buf[start:end])
+        return out
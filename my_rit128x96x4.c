@@ -13,6 +13,7 @@
 //
 //*****************************************************************************
 
+#include <stdint.h>
 #include "inc/hw_ssi.h"
 #include "inc/hw_memmap.h"
 #include "inc/hw_sysctl.h"
@@ -22,6 +23,9 @@
 #include "my_ssi.h"
 #include "driverlib/sysctl.h"
 #include "my_rit128x96x4.h"
+#include "rowkernel.h"
+#include "cyclecount.h"
+#include "profile.h"
 
 //*****************************************************************************
 //
@@ -50,6 +54,24 @@ static volatile unsigned long g_ulSSIFlags;
 //*****************************************************************************
 static unsigned char g_pucBuffer[8];
 
+//*****************************************************************************
+//
+// The controller has 128 rows of display RAM, of which the 96 from the
+// display start line on are shown, wrapping from the last RAM row to the
+// first.  Drawing maps display rows to RAM rows, so RIT128x96x4Scroll() can
+// write rows below the bottom of the display and move the start line down
+// over them.
+//
+// A window of rows that wraps is set in two parts; RITRowData() moves on to
+// the second after the rows that fit in the first.
+//
+//*****************************************************************************
+#define RIT_RAM_ROWS            128
+#define RIT_ROWS                96
+static unsigned long g_ulRITStartLine;
+static unsigned long g_ulRITWindowRows;
+static unsigned long g_ulRITWrapRows;
+
 //*****************************************************************************
 //
 // Define the SSD1329 128x96x4 Remap Setting(s).  This will be used in
@@ -264,6 +286,8 @@ RITWriteCommand(const unsigned char *pucBuffer, unsigned long ulCount)
 static void
 RITWriteData(const unsigned char *pucBuffer, unsigned long ulCount)
 {
+    ProfileBegin();
+
     //
     // Return if SSI port is not enabled for RIT display.
     //
@@ -311,14 +335,151 @@ RITWriteData(const unsigned char *pucBuffer, unsigned long ulCount)
     }
     //Enable the SSI interrupts
     SSIIntEnable(SSI0_BASE, SSI_TXFF);
+
+    ProfileEnd(PROFILE_RIT_WRITE);
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Write one data byte repeated to the SSD1329 controller.
+//!
+//! The bytes are fed to the SSI transmit FIFO as fast as it drains, without
+//! waiting for the SSI to go idle between them, so filling display RAM runs
+//! at the full SSI clock rate.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITWriteFill(unsigned char ucData, unsigned long ulCount)
+{
+    //
+    // Return if SSI port is not enabled for RIT display.
+    //
+    if(!HWREGBITW(&g_ulSSIFlags, FLAG_SSI_ENABLED))
+    {
+        return;
+    }
+
+    //
+    // Wait until the SSI is not busy, meaning that all previous commands
+    // have been transmitted.
+    //
+    while(SSIBusy(SSI0_BASE))
+    {
+    }
+
+    //
+    // See if command mode is enabled.
+    //
+    if(!HWREGBITW(&g_ulSSIFlags, FLAG_DC_HIGH))
+    {
+        //
+        // Set the command/control bit to enable data mode.
+        //
+        GPIOPinWrite(GPIO_OLEDDC_BASE, GPIO_OLEDDC_PIN, GPIO_OLEDDC_PIN);
+        HWREGBITW(&g_ulSSIFlags, FLAG_DC_HIGH) = 1;
+    }
+
+    //
+    // SSIDataPut() only waits for room in the FIFO.
+    //
+    while(ulCount != 0)
+    {
+        SSIDataPut(SSI0_BASE, ucData);
+        ulCount--;
+    }
+
+    //Enable the SSI interrupts
+    SSIIntEnable(SSI0_BASE, SSI_TXFF);
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Sets a window to draw rows of pixels into, in display rows, and selects
+//! horizontal increment.
+//!
+//! \param ulX is the first column of the window, which must be even.
+//! \param ulY is the first row of the window; rows below the display are
+//! the RAM rows not shown.
+//! \param ulWidth is the width of the window in columns, which must be even.
+//! \param ulRows is the height of the window in rows.
+//!
+//! Rows must then be written with RITRowData().
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITRowWindow(unsigned long ulX, unsigned long ulY, unsigned long ulWidth,
+             unsigned long ulRows)
+{
+    ulY = (ulY + g_ulRITStartLine) % RIT_RAM_ROWS;
+    g_ulRITWindowRows = ulRows;
+    g_ulRITWrapRows = 0;
+    if((ulY + ulRows) > RIT_RAM_ROWS)
+    {
+        g_ulRITWindowRows = RIT_RAM_ROWS - ulY;
+        g_ulRITWrapRows = ulRows - g_ulRITWindowRows;
+    }
+
+    g_pucBuffer[0] = 0x15;
+    g_pucBuffer[1] = ulX / 2;
+    g_pucBuffer[2] = (ulX + ulWidth - 2) / 2;
+    RITWriteCommand(g_pucBuffer, 3);
+    g_pucBuffer[0] = 0x75;
+    g_pucBuffer[1] = ulY;
+    g_pucBuffer[2] = ulY + g_ulRITWindowRows - 1;
+    RITWriteCommand(g_pucBuffer, 3);
+    RITWriteCommand(g_pucRIT128x96x4HorizontalInc,
+                    sizeof(g_pucRIT128x96x4HorizontalInc));
+}
+
+//*****************************************************************************
+//
+//! \internal
+//!
+//! Writes one row of pixels to the window set by RITRowWindow().
+//!
+//! \param pucRow is a pointer to the row.
+//! \param ulCount is the number of bytes in the row.
+//!
+//! \return None.
+//
+//*****************************************************************************
+static void
+RITRowData(const unsigned char *pucRow, unsigned long ulCount)
+{
+    RITWriteData(pucRow, ulCount);
+
+    //
+    // Continue a window that wraps from the first RAM row.
+    //
+    if((--g_ulRITWindowRows == 0) && g_ulRITWrapRows)
+    {
+        g_pucBuffer[0] = 0x75;
+        g_pucBuffer[1] = 0;
+        g_pucBuffer[2] = g_ulRITWrapRows - 1;
+        RITWriteCommand(g_pucBuffer, 3);
+        g_ulRITWindowRows = g_ulRITWrapRows;
+        g_ulRITWrapRows = 0;
+    }
 }
 
 //*****************************************************************************
 //
 //! Clears the OLED display.
 //!
-//! This function will clear the display RAM.  All pixels in the display will
-//! be turned off.
+//! This function will clear the display RAM, including the rows not shown.
+//! All pixels in the display will be turned off.
+//!
+//! The whole of display RAM is written as one stream of zero bytes, which
+//! keeps the SSI busy for the whole clear; writing it a few bytes at a time,
+//! waiting for the SSI to go idle between writes, takes noticeably longer.
 //!
 //! \return None.
 //
@@ -328,13 +489,6 @@ RIT128x96x4Clear(void)
 {
     static const unsigned char pucCommand1[] = { 0x15, 0, 63 };
     static const unsigned char pucCommand2[] = { 0x75, 0, 127 };
-    unsigned long ulRow, ulColumn;
-
-    //
-    // Clear out the buffer used for sending bytes to the display.
-    //
-    *(unsigned long *)&g_pucBuffer[0] = 0;
-    *(unsigned long *)&g_pucBuffer[4] = 0;
 
     //
     // Set the window to fill the entire display.
@@ -345,24 +499,9 @@ RIT128x96x4Clear(void)
                     sizeof(g_pucRIT128x96x4HorizontalInc));
 
     //
-    // Loop through the rows
+    // Each byte is two pixels.
     //
-    for(ulRow = 0; ulRow < 96; ulRow++)
-    {
-        //
-        // Loop through the columns.  Each byte is two pixels,
-        // and the buffer hold 8 bytes, so 16 pixels are cleared
-        // at a time.
-        //
-        for(ulColumn = 0; ulColumn < 128; ulColumn += 8 * 2)
-        {
-            //
-            // Write 8 clearing bytes to the display, which will
-            // clear 16 pixels across.
-            //
-            RITWriteData(g_pucBuffer, sizeof(g_pucBuffer));
-        }
-    }
+    RITWriteFill(0, RIT_RAM_ROWS * 64);
 }
 
 //*****************************************************************************
@@ -430,6 +569,37 @@ void
 RIT128x96x4ImageDraw(const unsigned char *pucImage, unsigned long ulX,
                      unsigned long ulY, unsigned long ulWidth,
                      unsigned long ulHeight)
+{
+    RIT128x96x4ImageDrawStride(pucImage, ulWidth / 2, ulX, ulY, ulWidth,
+                               ulHeight);
+}
+
+//*****************************************************************************
+//
+//! Displays part of a larger image on the OLED display.
+//!
+//! \param pucImage is a pointer to the first byte of the region to display.
+//! \param ulStride is the distance in bytes between the starts of successive
+//! rows of the image.
+//! \param ulX is the horizontal position to display this region, specified in
+//! columns from the left edge of the display.
+//! \param ulY is the vertical position to display this region, specified in
+//! rows from the top of the display.
+//! \param ulWidth is the width of the region, specified in columns.
+//! \param ulHeight is the height of the region, specified in rows.
+//!
+//! This function behaves like RIT128x96x4ImageDraw() except that the rows of
+//! the region need not be contiguous, so a window can be drawn straight out of
+//! a full 128x96 frame buffer by passing a stride of 64.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4ImageDrawStride(const unsigned char *pucImage,
+                           unsigned long ulStride, unsigned long ulX,
+                           unsigned long ulY, unsigned long ulWidth,
+                           unsigned long ulHeight)
 {
     //
     // Check the arguments.
@@ -445,31 +615,303 @@ RIT128x96x4ImageDraw(const unsigned char *pucImage, unsigned long ulX,
     // Setup a window starting at the specified column and row, and ending
     // at the column + width and row+height.
     //
+    RITRowWindow(ulX, ulY, ulWidth, ulHeight);
+
+    //
+    // Loop while there are more rows to display.
+    //
+    while(ulHeight--)
+    {
+        //
+        // Write this row of image data.
+        //
+        RITRowData(pucImage, (ulWidth / 2));
+
+        //
+        // Advance to the next row of the image.
+        //
+        pucImage += ulStride;
+    }
+}
+
+//*****************************************************************************
+//
+//! Displays every second row of part of a larger image on the OLED display.
+//!
+//! \param pucImage is a pointer to the first byte of the first row to display.
+//! \param ulStride is the distance in bytes between the starts of the rows of
+//! the image that are displayed.
+//! \param ulX is the horizontal position to display this region, specified in
+//! columns from the left edge of the display.
+//! \param ulY is the display row the first row is drawn on.
+//! \param ulWidth is the width of the region, specified in columns.
+//! \param ulRows is the number of rows to display.
+//!
+//! The rows are drawn on display rows \e ulY, \e ulY + 2 and so on, leaving
+//! the rows in between as they were.  Each row is written through its own
+//! one row window, since the controller only advances to the next row.  To
+//! draw one field of a 128x96 frame buffer pass a stride of 128.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4ImageDrawInterlaced(const unsigned char *pucImage,
+                               unsigned long ulStride, unsigned long ulX,
+                               unsigned long ulY, unsigned long ulWidth,
+                               unsigned long ulRows)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(ulX < 128);
+    ASSERT((ulX & 1) == 0);
+    ASSERT(ulY < 96);
+    ASSERT((ulX + ulWidth) <= 128);
+    ASSERT((ulY + (ulRows * 2) - 1) <= 96);
+    ASSERT((ulWidth & 1) == 0);
+
+    //
+    // The columns are the same for every row.
+    //
     g_pucBuffer[0] = 0x15;
     g_pucBuffer[1] = ulX / 2;
     g_pucBuffer[2] = (ulX + ulWidth - 2) / 2;
     RITWriteCommand(g_pucBuffer, 3);
-    g_pucBuffer[0] = 0x75;
-    g_pucBuffer[1] = ulY;
-    g_pucBuffer[2] = ulY + ulHeight - 1;
-    RITWriteCommand(g_pucBuffer, 3);
     RITWriteCommand(g_pucRIT128x96x4HorizontalInc,
                     sizeof(g_pucRIT128x96x4HorizontalInc));
 
     //
     // Loop while there are more rows to display.
     //
-    while(ulHeight--)
+    while(ulRows--)
     {
         //
-        // Write this row of image data.
+        // Set a window of just this row and write its image data.
         //
+        g_pucBuffer[0] = 0x75;
+        g_pucBuffer[1] = (ulY + g_ulRITStartLine) % RIT_RAM_ROWS;
+        g_pucBuffer[2] = g_pucBuffer[1];
+        RITWriteCommand(g_pucBuffer, 3);
         RITWriteData(pucImage, (ulWidth / 2));
 
         //
-        // Advance to the next row of the image.
+        // Advance to the next row of the field.
+        //
+        pucImage += ulStride;
+        ulY += 2;
+    }
+}
+
+//*****************************************************************************
+//
+// Rows of a scaled image, widened to the full 128 columns.
+//
+//*****************************************************************************
+static unsigned long g_ppulRITRow[3][16];
+
+//*****************************************************************************
+//
+// The row kernels used to widen rows, and the table that doubles each byte
+// of two pixels into four, built by RIT128x96x4Init().
+//
+//*****************************************************************************
+ROW_KERNEL_TABLE(RITDoubleTable, 4, 2)
+ROW_KERNEL(RITRowCopy, 4, 1, COPY)
+ROW_KERNEL(RITRowDouble, 4, 2, COPY)
+static uint32_t g_pulRITDouble[256];
+
+//*****************************************************************************
+//
+// Averages the eight pixels in each of two words, rounding down.
+//
+//*****************************************************************************
+#define RIT_NIBBLE_AVERAGE(a, b)                                              \
+    (((a) & (b)) + ((((a) ^ (b)) & 0xEEEEEEEE) >> 1))
+
+//*****************************************************************************
+//
+// Widens one row of an image to 128 columns.  A 64 column row has every
+// pixel doubled or, if bFilter is set, every second pixel replaced by the
+// average of its neighbours.  Copies and plain doubling are done by row
+// kernels; the filter needs the pixel after each pair, so has its own loop.
+//
+//*****************************************************************************
+static void
+RITRowWiden(const unsigned char *pucSrc, unsigned long ulWidth,
+            unsigned char *pucDst, tBoolean bFilter)
+{
+    unsigned long ulIdx, ulDouble, ulShift;
+
+    if(ulWidth == 128)
+    {
+        RITRowCopy((uint32_t *)pucDst, pucSrc, 0, 16);
+        return;
+    }
+    if(!bFilter)
+    {
+        RITRowDouble((uint32_t *)pucDst, pucSrc, g_pulRITDouble, 16);
+        return;
+    }
+
+    for(ulIdx = 0; ulIdx < 32; ulIdx += 2)
+    {
+        //
+        // Double the four pixels in two source bytes, first pixel in the
+        // most significant nibble.
+        //
+        ulDouble = (pucSrc[ulIdx] << 8) | pucSrc[ulIdx + 1];
+        ulDouble = (((ulDouble & 0xF000) << 16) | ((ulDouble & 0xF000) << 12) |
+                    ((ulDouble & 0x0F00) << 12) | ((ulDouble & 0x0F00) << 8) |
+                    ((ulDouble & 0x00F0) << 8) | ((ulDouble & 0x00F0) << 4) |
+                    ((ulDouble & 0x000F) << 4) | (ulDouble & 0x000F));
+
+        //
+        // Averaging with the same pixels moved on by one, with the first
+        // pixel of the next pair at the end, blends each copy with the pixel
+        // after it.
         //
-        pucImage += (ulWidth / 2);
+        ulShift = ((ulDouble << 4) |
+                   ((ulIdx < 30) ? (pucSrc[ulIdx + 2] >> 4) :
+                    (ulDouble & 0xF)));
+        ulDouble = RIT_NIBBLE_AVERAGE(ulDouble, ulShift);
+
+        *pucDst++ = ulDouble >> 24;
+        *pucDst++ = ulDouble >> 16;
+        *pucDst++ = ulDouble >> 8;
+        *pucDst++ = ulDouble;
+    }
+}
+
+//*****************************************************************************
+//
+//! Displays an image scaled up to fill the OLED display.
+//!
+//! \param pucImage is a pointer to the image data, stored as for
+//! RIT128x96x4ImageDraw().
+//! \param ulWidth is the width of the image, 64 or 128 columns.
+//! \param ulHeight is the height of the image, 48 or 96 rows.
+//! \param bFilter is \b true to fill in the added pixels by averaging their
+//! neighbours, or \b false to repeat the pixel before each.
+//!
+//! Images with half the width or height of the display are doubled in that
+//! direction a row at a time as they are written, so no full size copy of the
+//! image is needed.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4ImageDrawScaled(const unsigned char *pucImage,
+                           unsigned long ulWidth, unsigned long ulHeight,
+                           tBoolean bFilter)
+{
+    unsigned long *pulRow, *pulNext, *pulSwap;
+    unsigned long ulRow, ulIdx;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT((ulWidth == 64) || (ulWidth == 128));
+    ASSERT((ulHeight == 48) || (ulHeight == 96));
+
+    //
+    // Setup a window covering the whole display.
+    //
+    RITRowWindow(0, 0, 128, RIT_ROWS);
+
+    pulRow = g_ppulRITRow[0];
+    pulNext = g_ppulRITRow[1];
+    RITRowWiden(pucImage, ulWidth, (unsigned char *)pulRow, bFilter);
+
+    for(ulRow = 0; ulRow < ulHeight; ulRow++)
+    {
+        RITRowData((unsigned char *)pulRow, 64);
+
+        //
+        // Widen the next row while this one is still at hand for the
+        // vertical filter.
+        //
+        if((ulRow + 1) < ulHeight)
+        {
+            pucImage += ulWidth / 2;
+            RITRowWiden(pucImage, ulWidth, (unsigned char *)pulNext, bFilter);
+        }
+
+        //
+        // Half height images repeat each row or, if filtering, follow it
+        // with the average of it and the next.
+        //
+        if(ulHeight == 48)
+        {
+            if(bFilter && ((ulRow + 1) < ulHeight))
+            {
+                for(ulIdx = 0; ulIdx < 16; ulIdx++)
+                {
+                    g_ppulRITRow[2][ulIdx] =
+                        RIT_NIBBLE_AVERAGE(pulRow[ulIdx], pulNext[ulIdx]);
+                }
+                RITRowData((unsigned char *)g_ppulRITRow[2], 64);
+            }
+            else
+            {
+                RITRowData((unsigned char *)pulRow, 64);
+            }
+        }
+
+        pulSwap = pulRow;
+        pulRow = pulNext;
+        pulNext = pulSwap;
+    }
+}
+
+//*****************************************************************************
+//
+//! Scrolls the OLED display up.
+//!
+//! \param pucImage is a pointer to the rows uncovered at the bottom of the
+//! display, 128 columns each, stored as for RIT128x96x4ImageDraw().
+//! \param ulRows is the number of rows to scroll by, at most 96.
+//!
+//! The new rows are written to display RAM rows that are not shown, below
+//! the bottom of the display, and the display start line is then moved down
+//! over them, so a scroll costs only the new rows and a few commands rather
+//! than redrawing the display.  There are 32 rows not shown, so larger
+//! scrolls are done in steps.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+RIT128x96x4Scroll(const unsigned char *pucImage, unsigned long ulRows)
+{
+    unsigned long ulStep, ulRow;
+
+    //
+    // Check the arguments.
+    //
+    ASSERT(ulRows <= RIT_ROWS);
+
+    while(ulRows)
+    {
+        ulStep = ulRows;
+        if(ulStep > (RIT_RAM_ROWS - RIT_ROWS))
+        {
+            ulStep = RIT_RAM_ROWS - RIT_ROWS;
+        }
+        ulRows -= ulStep;
+
+        RITRowWindow(0, RIT_ROWS, 128, ulStep);
+        for(ulRow = 0; ulRow < ulStep; ulRow++)
+        {
+            RITRowData(pucImage, 64);
+            pucImage += 64;
+        }
+        g_ulRITStartLine = (g_ulRITStartLine + ulStep) % RIT_RAM_ROWS;
+
+        g_pucBuffer[0] = 0xA1;
+        g_pucBuffer[1] = g_ulRITStartLine;
+        RITWriteCommand(g_pucBuffer, 2);
     }
 }
 
@@ -531,6 +973,7 @@ RIT128x96x4Enable(unsigned long ulFrequency)
 void
 RIT128x96x4Init(unsigned long ulFrequency)
 {
+    unsigned char pucLevel[16];
     unsigned long ulIdx;
 
     //
@@ -568,6 +1011,15 @@ RIT128x96x4Init(unsigned long ulFrequency)
     //
     RIT128x96x4Clear();
 
+    //
+    // Build the table for doubling rows of scaled images.
+    //
+    for(ulIdx = 0; ulIdx < 16; ulIdx++)
+    {
+        pucLevel[ulIdx] = ulIdx;
+    }
+    RITDoubleTable(g_pulRITDouble, pucLevel);
+
     //
     // Initialize the SSD1329 controller.  Loop through the initialization
     // sequence array, sending each command "string" to the controller.
@@ -581,6 +1033,11 @@ RIT128x96x4Init(unsigned long ulFrequency)
         RITWriteCommand(g_pucRIT128x96x4Init + ulIdx + 1,
                         g_pucRIT128x96x4Init[ulIdx] - 1);
     }
+
+    //
+    // The sequence puts the display start line at the first RAM row.
+    //
+    g_ulRITStartLine = 0;
 }
 
 //*****************************************************************************
@@ -611,6 +1068,13 @@ RIT128x96x4DisplayOn(void)
         RITWriteCommand(g_pucRIT128x96x4Init + ulIdx + 1,
                         g_pucRIT128x96x4Init[ulIdx] - 1);
     }
+
+    //
+    // Put back the display start line the sequence reset.
+    //
+    g_pucBuffer[0] = 0xA1;
+    g_pucBuffer[1] = g_ulRITStartLine;
+    RITWriteCommand(g_pucBuffer, 2);
 }
 
 //*****************************************************************************
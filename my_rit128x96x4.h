@@ -21,6 +21,24 @@ extern void RIT128x96x4ImageDraw(const unsigned char *pucImage,
                                    unsigned long ulY,
                                    unsigned long ulWidth,
                                    unsigned long ulHeight);
+extern void RIT128x96x4ImageDrawStride(const unsigned char *pucImage,
+                                       unsigned long ulStride,
+                                       unsigned long ulX,
+                                       unsigned long ulY,
+                                       unsigned long ulWidth,
+                                       unsigned long ulHeight);
+extern void RIT128x96x4ImageDrawInterlaced(const unsigned char *pucImage,
+                                           unsigned long ulStride,
+                                           unsigned long ulX,
+                                           unsigned long ulY,
+                                           unsigned long ulWidth,
+                                           unsigned long ulRows);
+extern void RIT128x96x4ImageDrawScaled(const unsigned char *pucImage,
+                                       unsigned long ulWidth,
+                                       unsigned long ulHeight,
+                                       tBoolean bFilter);
+extern void RIT128x96x4Scroll(const unsigned char *pucImage,
+                              unsigned long ulRows);
 extern void RIT128x96x4Init(unsigned long ulFrequency);
 extern void RIT128x96x4Enable(unsigned long ulFrequency);
 extern void RIT128x96x4DisplayOn(void);
@@ -24,6 +24,8 @@
 #include "driverlib/debug.h"
 #include "driverlib/interrupt.h"
 #include "driverlib/ssi.h"
+#include "cyclecount.h"
+#include "profile.h"
 
 
 //Prototype functions not needed in API
@@ -43,6 +45,7 @@ volatile unsigned char ssiBusy = 1;
 void SSIIntHandler(void)
 {
     unsigned long ulStatus;
+    ProfileBegin();
 
     //
     // Disable the SSI_TXFF interrupt
@@ -66,6 +69,8 @@ void SSIIntHandler(void)
     //busy.
     ssiBusy = (HWREG(SSI0_BASE + SSI_O_SR) & SSI_SR_BSY) ? true : false;
 
+    ProfileEnd(PROFILE_SSI_INT);
+
 }
 //*****************************************************************************
 //
@@ -308,6 +308,82 @@ UARTCharGetNonBlocking(unsigned long ulBase)
     }
 }
 
+//*****************************************************************************
+//
+//! Determines if there is any space in the transmit FIFO.
+//!
+//! \param ulBase is the base address of the UART port.
+//!
+//! This function returns a flag indicating whether or not there is space
+//! available in the transmit FIFO.
+//!
+//! \return Returns \b true if there is space available in the transmit FIFO,
+//! and \b false if there is no space available in the transmit FIFO.
+//
+//*****************************************************************************
+tBoolean
+UARTSpaceAvail(unsigned long ulBase)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(UARTBaseValid(ulBase));
+
+    //
+    // Return the availability of space.
+    //
+    return((HWREG(ulBase + UART_O_FR) & UART_FR_TXFF) ? false : true);
+}
+
+//*****************************************************************************
+//
+//! Sends a character to the specified port.
+//!
+//! \param ulBase is the base address of the UART port.
+//! \param ucData is the character to be transmitted.
+//!
+//! Writes the character \e ucData to the transmit FIFO for the specified port.
+//! This function does not block, so if there is no space available, then a
+//! \b false is returned, and the application will have to retry the function
+//! later.
+//!
+//! \return Returns \b true if the character was successfully placed in the
+//! transmit FIFO, and \b false if there was no space available in the transmit
+//! FIFO.
+//
+//*****************************************************************************
+tBoolean
+UARTCharPutNonBlocking(unsigned long ulBase, unsigned char ucData)
+{
+    //
+    // Check the arguments.
+    //
+    ASSERT(UARTBaseValid(ulBase));
+
+    //
+    // See if there is space in the transmit FIFO.
+    //
+    if(!(HWREG(ulBase + UART_O_FR) & UART_FR_TXFF))
+    {
+        //
+        // Write this character to the transmit FIFO.
+        //
+        HWREG(ulBase + UART_O_DR) = ucData;
+
+        //
+        // Success.
+        //
+        return(true);
+    }
+    else
+    {
+        //
+        // There is no space in the transmit FIFO, so return a failure.
+        //
+        return(false);
+    }
+}
+
 //*****************************************************************************
 //
 //! Enables individual UART interrupt sources.
@@ -154,6 +154,9 @@ extern void UARTEnable(unsigned long ulBase);
 extern void UARTDisable(unsigned long ulBase);
 extern tBoolean UARTCharsAvail(unsigned long ulBase);
 extern long UARTCharGetNonBlocking(unsigned long ulBase);
+extern tBoolean UARTSpaceAvail(unsigned long ulBase);
+extern tBoolean UARTCharPutNonBlocking(unsigned long ulBase,
+                                       unsigned char ucData);
 extern void UARTIntEnable(unsigned long ulBase, unsigned long ulIntFlags);
 extern void UARTIntDisable(unsigned long ulBase, unsigned long ulIntFlags);
 extern unsigned long UARTIntStatus(unsigned long ulBase, tBoolean bMasked);
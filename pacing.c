@@ -0,0 +1,327 @@
+//*****************************************************************************
+//
+// pacing.c - Frames shown at the times the host gives them.
+//
+// Frames are drawn as soon as they are decoded unless the host times them,
+// so playback otherwise runs at whatever pace packets arrive and jitter on
+// the link shows as jerky motion.  The host can send a time packet before a
+// frame
+//
+//   bytes 0-3     presentation time of the next frame, in milliseconds
+//   bytes 4-5     latency, in milliseconds
+//
+// The first timed frame sets the clock: it is drawn the latency after it is
+// decoded, and every later frame at its time relative to that one, counted
+// by SysTick.  While a decoded frame waits to be drawn the packets after it
+// wait in the link's receive ring, so the latency works as a jitter buffer:
+// frames that arrive up to the latency late are still drawn on time.
+//
+// A frame drawn more than PACING_LATE_MS after its time is dropped instead,
+// its changed cells being drawn with the next frame, so playback catches up
+// rather than staying behind.  If PACING_LATE_FRAMES frames in a row are too
+// late, or a frame is far from its time, as when the host starts a new
+// stream, the clock is set again from the next frame.  Frames that keep
+// arriving earlier than the latency, because the board's clock runs slow
+// against the host's, move the clock a millisecond at a time.
+//
+// Boards side by side in a video wall must each draw a frame at the same
+// moment, which setting the clock from when frames happen to be decoded does
+// not do.  Instead the host sends each board sync packets
+//
+//   bytes 0-3     the host's clock, in milliseconds
+//
+// every so often, and times frames by the same clock.  The arrival of the
+// sync packet that came quickest gives the tick count less the host's clock,
+// and every timed frame is drawn the latency after its time by the host's
+// clock, so the boards agree to within a tick or two of each other.  The
+// estimate goes down at once to a quicker sync packet, and up a millisecond
+// for each slower one, which follows the board's clock drifting against the
+// host's.  A frame far from its time, as from a host sending no sync packets,
+// goes back to setting the clock from frames.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/systick.h"
+#include "cyclecount.h"
+#include "video.h"
+#include "pacing.h"
+
+//*****************************************************************************
+//
+// Milliseconds since PacingInit(), counted by the SysTick interrupt.
+//
+//*****************************************************************************
+static volatile unsigned long g_ulPacingTicks;
+
+//*****************************************************************************
+//
+// Processor cycles in a tick.
+//
+//*****************************************************************************
+static unsigned long g_ulPacingCycles;
+
+//*****************************************************************************
+//
+// The time and latency sent for the next frame, and whether one was sent.
+//
+//*****************************************************************************
+static tBoolean g_bPacingTimed;
+static unsigned long g_ulPacingTime;
+static unsigned long g_ulPacingLatency;
+
+//*****************************************************************************
+//
+// The tick count less the host's time, whether it is set, and the count of
+// frames in a row that were too late.
+//
+//*****************************************************************************
+static tBoolean g_bPacingClock;
+static unsigned long g_ulPacingOffset;
+static unsigned long g_ulPacingLate;
+
+//*****************************************************************************
+//
+// The tick count less the host's clock from sync packets, and whether it has
+// been found.
+//
+//*****************************************************************************
+static tBoolean g_bPacingSynced;
+static unsigned long g_ulPacingSync;
+
+//*****************************************************************************
+//
+// Whether a decoded frame is waiting to be drawn, and the tick it is due.
+//
+//*****************************************************************************
+static tBoolean g_bPacingWait;
+static unsigned long g_ulPacingDue;
+
+//*****************************************************************************
+//
+//! Starts the millisecond clock.
+//!
+//! This must be called after the system clock is set.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PacingInit(void)
+{
+    g_ulPacingTicks = 0;
+    g_bPacingTimed = false;
+    g_bPacingClock = false;
+    g_ulPacingLate = 0;
+    g_bPacingWait = false;
+    g_bPacingSynced = false;
+
+    g_ulPacingCycles = SysCtlClockGet() / PACING_TICK_HZ;
+    SysTickPeriodSet(g_ulPacingCycles);
+    SysTickIntEnable();
+    SysTickEnable();
+}
+
+//*****************************************************************************
+//
+//! Counts milliseconds.
+//!
+//! This is the SysTick interrupt handler.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SysTickIntHandler(void)
+{
+    g_ulPacingTicks++;
+}
+
+//*****************************************************************************
+//
+//! Takes the time of the next frame from a time packet.
+//!
+//! \param pucData is a pointer to the time packet.
+//! \param ulLength is the number of bytes in the packet.
+//!
+//! A malformed packet is ignored, leaving the next frame untimed.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PacingTime(const unsigned char *pucData, unsigned long ulLength)
+{
+    if(ulLength != 6)
+    {
+        return;
+    }
+    g_ulPacingTime = (pucData[0] | (pucData[1] << 8) | (pucData[2] << 16) |
+                      ((unsigned long)pucData[3] << 24));
+    g_ulPacingLatency = pucData[4] | (pucData[5] << 8);
+    g_bPacingTimed = true;
+}
+
+//*****************************************************************************
+//
+//! Takes the host's clock from a sync packet.
+//!
+//! \param pucData is a pointer to the sync packet.
+//! \param ulLength is the number of bytes in the packet.
+//! \param ulReceived is the cycle count at which the packet arrived.
+//!
+//! A malformed packet is ignored.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PacingSync(const unsigned char *pucData, unsigned long ulLength,
+           unsigned long ulReceived)
+{
+    unsigned long ulSync;
+    long lSlower;
+
+    if(ulLength != 4)
+    {
+        return;
+    }
+
+    //
+    // The packet may have waited in the receive ring behind a frame, so its
+    // tick is found from when it arrived.
+    //
+    ulSync = (g_ulPacingTicks -
+              ((CycleCountGet() - ulReceived) / g_ulPacingCycles) -
+              (pucData[0] | (pucData[1] << 8) | (pucData[2] << 16) |
+               ((unsigned long)pucData[3] << 24)));
+    lSlower = (long)(ulSync - g_ulPacingSync);
+    if(!g_bPacingSynced || (lSlower <= 0) || (lSlower > PACING_RESYNC_MS))
+    {
+        g_ulPacingSync = ulSync;
+        g_bPacingSynced = true;
+    }
+    else
+    {
+        g_ulPacingSync++;
+    }
+}
+
+//*****************************************************************************
+//
+//! Schedules the frame just decoded, if the host timed it.
+//!
+//! This must be called after every frame packet is decoded, whether or not
+//! it produced a frame, since a time applies to the next packet only.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PacingDecoded(void)
+{
+    unsigned long ulNow;
+    long lEarly;
+
+    if(!g_bPacingTimed)
+    {
+        return;
+    }
+    g_bPacingTimed = false;
+    if(!VideoPending())
+    {
+        return;
+    }
+
+    //
+    // Frames timed by the host's clock are all drawn the latency after their
+    // time by it.
+    //
+    if(g_bPacingSynced)
+    {
+        g_ulPacingOffset = g_ulPacingSync + g_ulPacingLatency;
+        g_bPacingClock = true;
+    }
+
+    ulNow = g_ulPacingTicks;
+    lEarly = (long)(g_ulPacingTime + g_ulPacingOffset - ulNow);
+    if(!g_bPacingClock || (lEarly < -PACING_RESYNC_MS) ||
+       (lEarly > (long)(g_ulPacingLatency + PACING_RESYNC_MS)))
+    {
+        g_ulPacingOffset = ulNow + g_ulPacingLatency - g_ulPacingTime;
+        g_bPacingClock = true;
+        g_bPacingSynced = false;
+    }
+    else if(!g_bPacingSynced && (lEarly > (long)g_ulPacingLatency))
+    {
+        g_ulPacingOffset--;
+    }
+
+    g_ulPacingDue = g_ulPacingTime + g_ulPacingOffset;
+    g_bPacingWait = true;
+}
+
+//*****************************************************************************
+//
+//! Returns whether a decoded frame is waiting for its time.
+//!
+//! No packets should be decoded while one is, since the next frame would
+//! replace it.
+//!
+//! \return Returns non-zero if a frame is waiting.
+//
+//*****************************************************************************
+unsigned long
+PacingWaiting(void)
+{
+    return(g_bPacingWait);
+}
+
+//*****************************************************************************
+//
+//! Draws the frame most recently decoded when it is due.
+//!
+//! Untimed frames are drawn straight away.  A timed frame is left waiting
+//! until its time, and dropped if it is too late.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+PacingPresent(void)
+{
+    long lEarly;
+
+    if(!g_bPacingWait)
+    {
+        VideoPresent();
+        return;
+    }
+    lEarly = (long)(g_ulPacingDue - g_ulPacingTicks);
+    if(lEarly > 0)
+    {
+        return;
+    }
+    g_bPacingWait = false;
+
+    //
+    // Once too many frames in a row are late the stream is behind for good,
+    // so the late frame is drawn and the clock set again from the next.
+    //
+    if(lEarly >= -PACING_LATE_MS)
+    {
+        g_ulPacingLate = 0;
+        VideoPresent();
+    }
+    else if(++g_ulPacingLate < PACING_LATE_FRAMES)
+    {
+        VideoSkip();
+    }
+    else
+    {
+        g_ulPacingLate = 0;
+        g_bPacingClock = false;
+        VideoPresent();
+    }
+}
@@ -0,0 +1,37 @@
+//*****************************************************************************
+//
+// pacing.h - Frames shown at the times the host gives them.
+//
+//*****************************************************************************
+
+#ifndef __PACING_H__
+#define __PACING_H__
+
+//*****************************************************************************
+//
+// The SysTick rate, which is the resolution of presentation times, the time
+// past which a frame is too late to draw, the number of frames in a row that
+// may be too late before the clock is set again, and the time a frame may be
+// early beyond the latency before the clock is set again.
+//
+//*****************************************************************************
+#define PACING_TICK_HZ          1000
+#define PACING_LATE_MS          40
+#define PACING_LATE_FRAMES      4
+#define PACING_RESYNC_MS        1000
+
+//*****************************************************************************
+//
+// Prototypes for the pacing APIs.
+//
+//*****************************************************************************
+extern void PacingInit(void);
+extern void PacingTime(const unsigned char *pucData, unsigned long ulLength);
+extern void PacingSync(const unsigned char *pucData, unsigned long ulLength,
+                       unsigned long ulReceived);
+extern void PacingDecoded(void);
+extern unsigned long PacingWaiting(void);
+extern void PacingPresent(void);
+extern void SysTickIntHandler(void);
+
+#endif // __PACING_H__
@@ -0,0 +1,84 @@
+//*****************************************************************************
+//
+// planecodec.c - Decoder for progressive bit-plane frames.
+//
+// A frame can be sent as its four bit-planes, most significant first, so a
+// coarse version of a new scene appears after a quarter of the data.  Each
+// plane packet is
+//
+//   byte 0          plane number in bits 1:0, PLANE_FLAG_DRAW in bit 7
+//   1536 bytes      one bit per pixel in frame order, the leftmost pixel of
+//                   each group of eight in the most significant bit, each
+//                   byte exclusive ored with PLANE_SCRAMBLE
+//
+// Plane 3 starts a new frame.  Each later plane is combined with the frame
+// built from the planes before it.  The bits below the newest plane are
+// filled with the middle of their range, so a pixel whose top bit is set
+// shows as 12 rather than 8 until the lower planes arrive.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include "video.h"
+#include "planecodec.h"
+
+//*****************************************************************************
+//
+// The bit 0 of each of four pixels for a nibble of plane bits, as stored in
+// two bytes of a frame slot read as a little endian half word.
+//
+//*****************************************************************************
+static const uint16_t g_pusPlaneExpand[16] =
+{
+    0x0000, 0x0100, 0x1000, 0x1100, 0x0001, 0x0101, 0x1001, 0x1101,
+    0x0010, 0x0110, 0x1010, 0x1110, 0x0011, 0x0111, 0x1011, 0x1111
+};
+
+//*****************************************************************************
+//
+//! Decodes a plane packet.
+//!
+//! \param pucData is a pointer to the plane packet.
+//! \param ulLength is the number of bytes in the packet.
+//! \param pucRef is the frame built from the previous planes; it is not used
+//! for plane 3.
+//! \param pucFrame is the frame slot to decode into; it must be word aligned.
+//!
+//! \return Returns 0 on success or -1 if the packet is malformed.
+//
+//*****************************************************************************
+long
+PlaneDecode(const unsigned char *pucData, unsigned long ulLength,
+            const unsigned char *pucRef, unsigned char *pucFrame)
+{
+    const uint32_t *pulRef;
+    uint32_t *pulDst;
+    uint32_t ulKeep, ulFill, ulBits;
+    unsigned long ulPlane, ulCount;
+
+    if(ulLength != (1 + PLANE_BYTES))
+    {
+        return(-1);
+    }
+    ulPlane = pucData[0] & PLANE_NUMBER_M;
+    pucData++;
+
+    //
+    // Work out which bits of every pixel come from the earlier planes and
+    // which are filled in.
+    //
+    ulKeep = ((0xF << (ulPlane + 1)) & 0xF) * 0x11111111;
+    ulFill = ulPlane ? ((1 << (ulPlane - 1)) * 0x11111111) : 0;
+
+    pulDst = (uint32_t *)pucFrame;
+    pulRef = (const uint32_t *)(ulKeep ? pucRef : pucFrame);
+    for(ulCount = PLANE_BYTES; ulCount; ulCount--)
+    {
+        ulBits = *pucData++ ^ PLANE_SCRAMBLE;
+        ulBits = (g_pusPlaneExpand[ulBits >> 4] |
+                  ((uint32_t)g_pusPlaneExpand[ulBits & 0xF] << 16));
+        *pulDst++ = (*pulRef++ & ulKeep) | ulFill | (ulBits << ulPlane);
+    }
+
+    return(0);
+}
@@ -0,0 +1,44 @@
+//*****************************************************************************
+//
+// planecodec.h - Decoder for progressive bit-plane frames.
+//
+//*****************************************************************************
+
+#ifndef __PLANECODEC_H__
+#define __PLANECODEC_H__
+
+//*****************************************************************************
+//
+// Plane geometry.  Each of the four bit-planes of a frame holds one bit per
+// pixel, a byte for every eight pixels.
+//
+//*****************************************************************************
+#define PLANE_COUNT             4
+#define PLANE_BYTES             (FRAME_BYTES / 4)
+
+//*****************************************************************************
+//
+// The first byte of a plane packet: the plane number, 3 for the most
+// significant bit of each pixel, and flags.
+//
+//*****************************************************************************
+#define PLANE_NUMBER_M          0x03        // Plane number
+#define PLANE_FLAG_DRAW         0x80        // Draw the frame after this plane
+
+//*****************************************************************************
+//
+// Plane bytes are sent exclusive ored with this pattern so that solid areas,
+// which would otherwise be runs of 0xFF, do not need escaping on the link.
+//
+//*****************************************************************************
+#define PLANE_SCRAMBLE          0x55
+
+//*****************************************************************************
+//
+// Prototypes for the plane codec APIs.
+//
+//*****************************************************************************
+extern long PlaneDecode(const unsigned char *pucData, unsigned long ulLength,
+                        const unsigned char *pucRef, unsigned char *pucFrame);
+
+#endif // __PLANECODEC_H__
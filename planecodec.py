@@ -0,0 +1,51 @@
+#Encoder for the progressive bit-plane frames decoded by planecodec.c on the
+#device
+from hostframe import FRAME_BYTES
+
+#Plane geometry and flags, matching planecodec.h
+PLANE_COUNT = 4
+PLANE_BYTES = FRAME_BYTES // 4
+FLAG_DRAW = 0x80
+#Keeps solid areas from turning into runs of escaped 0xFF bytes on the link
+SCRAMBLE = 0x55
+
+#Bit of each plane for every pixel byte, left pixel in bit 1
+PAIR_BITS = [[(v >> (4 + k) & 1) << 1 | (v >> k & 1) for v in range(256)]
+             for k in range(PLANE_COUNT)]
+
+
+def plane(frame, k):
+    """Bit-plane k of a packed frame, eight pixels per byte, scrambled"""
+    bits = PAIR_BITS[k]
+    data = bytearray(frame)
+    return bytearray((bits[data[i]] << 6 | bits[data[i + 1]] << 4 |
+                      bits[data[i + 2]] << 2 | bits[data[i + 3]]) ^ SCRAMBLE
+                     for i in range(0, FRAME_BYTES, 4))
+
+
+def partial(frame, k):
+    """The frame the device shows once planes down to k have arrived: lower
+    bits are filled with the middle of their range"""
+    keep = ((0xF << k) & 0xF) * 0x11
+    fill = ((1 << k) >> 1) * 0x11
+    return bytearray((v & keep) | fill for v in bytearray(frame))
+
+
+class PlaneEncoder(object):
+    """Splits frames into bit-planes, drawing after every draw_every planes"""
+
+    def __init__(self, draw_every=1):
+        self.draw_every = max(1, draw_every)
+
+    def encode(self, frame, count=PLANE_COUNT):
+        """Plane packets for the top count planes of a frame, most significant
+        first, and the frame the device will show after them.  The last plane
+        sent is always drawn."""
+        packets = []
+        for n in range(count):
+            k = PLANE_COUNT - 1 - n
+            flags = k
+            if (n + 1) % self.draw_every == 0 or n == count - 1:
+                flags |= FLAG_DRAW
+            packets.append(bytearray([flags]) + plane(frame, k))
+        return packets, partial(frame, PLANE_COUNT - count)
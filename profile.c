@@ -0,0 +1,144 @@
+//*****************************************************************************
+//
+// profile.c - Cycle counts of the firmware's hot paths.
+//
+// Each probe in profile.h keeps the number of times it ran and the fewest,
+// most and total cycles it took, counted by the DWT cycle counter.  Times
+// include any interrupts taken meanwhile.  The host reads the table one probe
+// at a time with profile packets
+//
+//   byte 0        probe
+//   byte 1        non-zero to clear the probe once it is read
+//
+// each of which is answered with a LINK_RPT_PROFILE report
+//
+//   byte 0        probe
+//   byte 1        number of probes
+//   bytes 2-3     zero
+//   bytes 4-7     times the probe ran
+//   bytes 8-11    fewest cycles
+//   bytes 12-15   most cycles
+//   bytes 16-23   total cycles
+//
+// Without PROFILE defined none of this is built and profile packets are
+// ignored.
+//
+//*****************************************************************************
+
+#include "inc/hw_types.h"
+#include "driverlib/interrupt.h"
+#include "link.h"
+#include "profile.h"
+
+#ifdef PROFILE
+
+//*****************************************************************************
+//
+// A probe's counts.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned long ulCount;
+    unsigned long ulMin;
+    unsigned long ulMax;
+    unsigned long long ullTotal;
+}
+tProfileProbe;
+
+//*****************************************************************************
+//
+// The counts of every probe.
+//
+//*****************************************************************************
+static tProfileProbe g_psProfile[PROFILES];
+
+//*****************************************************************************
+//
+//! Adds a run of a probe.
+//!
+//! \param ulProbe is the probe, one of the \b PROFILE_ values.
+//! \param ulCycles is the cycles the run took.
+//!
+//! This is called by ProfileEnd(), from interrupt handlers as well as the
+//! main loop, so each probe must only be used from one of them.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ProfileAdd(unsigned long ulProbe, unsigned long ulCycles)
+{
+    tProfileProbe *psProbe;
+
+    psProbe = &g_psProfile[ulProbe];
+    if(!psProbe->ulCount || (ulCycles < psProbe->ulMin))
+    {
+        psProbe->ulMin = ulCycles;
+    }
+    if(ulCycles > psProbe->ulMax)
+    {
+        psProbe->ulMax = ulCycles;
+    }
+    psProbe->ullTotal += ulCycles;
+    psProbe->ulCount++;
+}
+
+//*****************************************************************************
+//
+//! Sends the counts of a probe to the host.
+//!
+//! \param pucData is a pointer to the profile packet.
+//! \param ulLength is the number of bytes in the packet.
+//!
+//! A malformed packet is ignored.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+ProfileReport(const unsigned char *pucData, unsigned long ulLength)
+{
+    unsigned char pucReport[24];
+    unsigned long pulCount[5];
+    tProfileProbe sProbe;
+    unsigned long ulIdx;
+
+    if((ulLength != 2) || (pucData[0] >= PROFILES))
+    {
+        return;
+    }
+
+    //
+    // Probes in interrupt handlers must not change part way through the copy.
+    //
+    IntMasterDisable();
+    sProbe = g_psProfile[pucData[0]];
+    if(pucData[1])
+    {
+        g_psProfile[pucData[0]].ulCount = 0;
+        g_psProfile[pucData[0]].ulMax = 0;
+        g_psProfile[pucData[0]].ullTotal = 0;
+    }
+    IntMasterEnable();
+
+    pulCount[0] = sProbe.ulCount;
+    pulCount[1] = sProbe.ulCount ? sProbe.ulMin : 0;
+    pulCount[2] = sProbe.ulMax;
+    pulCount[3] = (unsigned long)sProbe.ullTotal;
+    pulCount[4] = (unsigned long)(sProbe.ullTotal >> 32);
+    pucReport[0] = pucData[0];
+    pucReport[1] = PROFILES;
+    pucReport[2] = 0;
+    pucReport[3] = 0;
+    for(ulIdx = 0; ulIdx < 5; ulIdx++)
+    {
+        pucReport[(ulIdx * 4) + 4] = pulCount[ulIdx];
+        pucReport[(ulIdx * 4) + 5] = pulCount[ulIdx] >> 8;
+        pucReport[(ulIdx * 4) + 6] = pulCount[ulIdx] >> 16;
+        pucReport[(ulIdx * 4) + 7] = pulCount[ulIdx] >> 24;
+    }
+    LinkReport(LINK_RPT_PROFILE, pucReport, sizeof(pucReport));
+}
+
+#endif // PROFILE
@@ -0,0 +1,66 @@
+//*****************************************************************************
+//
+// profile.h - Cycle counts of the firmware's hot paths.
+//
+// The probes are only built in when PROFILE is defined, by building with
+// "make PROFILE=1"; otherwise every macro here expands to nothing and the
+// firmware carries no trace of them.  A probe times the code from
+// ProfileBegin(), which declares a variable and so must come at the start of
+// a block, to ProfileEnd() in the same block:
+//
+//     {
+//         ProfileBegin();
+//         ...
+//         ProfileEnd(PROFILE_DECODE);
+//     }
+//
+// Paths that leave the block early are not counted.  The cycle counter must
+// have been started with CycleCountInit(), and cyclecount.h included.
+//
+//*****************************************************************************
+
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+//*****************************************************************************
+//
+// The probes.
+//
+//*****************************************************************************
+#define PROFILE_UART_INT        0           // UARTIntHandler()
+#define PROFILE_SSI_INT         1           // SSIIntHandler()
+#define PROFILE_RIT_WRITE       2           // RITWriteData()
+#define PROFILE_DECODE          3           // VideoPacketDecode()
+#define PROFILE_PRESENT         4           // VideoPresent(), when it draws
+#define PROFILES                5
+
+#ifdef PROFILE
+
+//*****************************************************************************
+//
+// Starts and ends a probe.
+//
+//*****************************************************************************
+#define ProfileBegin()                                                        \
+    unsigned long ulProfileStart = CycleCountGet()
+#define ProfileEnd(ulProbe)                                                   \
+    ProfileAdd((ulProbe), CycleCountGet() - ulProfileStart)
+
+//*****************************************************************************
+//
+// Prototypes for the profiling APIs.
+//
+//*****************************************************************************
+extern void ProfileAdd(unsigned long ulProbe, unsigned long ulCycles);
+extern void ProfileReport(const unsigned char *pucData,
+                          unsigned long ulLength);
+
+#else
+
+#define ProfileBegin()
+#define ProfileEnd(ulProbe)
+#define ProfileReport(pucData, ulLength)
+
+#endif // PROFILE
+
+#endif // __PROFILE_H__
@@ -23,17 +23,19 @@
 #include <stdbool.h>
 #include "my_uart.h"
 #include "my_ssi.h"
+#include "cyclecount.h"
+#include "link.h"
+#include "video.h"
+#include "clip.h"
+#include "boot.h"
+#include "pacing.h"
+#include "latency.h"
+#include "profile.h"
 
 
 
-#define QUEUE_LEN 6144
 #define BAUD 1500000
 
-//Global memory and flags
-uint8_t g_queue[QUEUE_LEN];
-volatile uint16_t queueCount = 0;
-volatile bool pageRecieved = false;
-
 //*****************************************************************************
 //
 // The error routine that is called if the driver library encounters an error.
@@ -48,8 +50,9 @@ __error__(char *pcFilename, unsigned long ulLine)
 
 //*****************************************************************************
 //
-// The UART interrupt handler. Clears the generated interrupt and stores the
-// received data in a queue to be sent to the OLED display
+// The UART interrupt handler. Clears the generated interrupt, passes all
+// received data to the packet parser and refills the transmit FIFO with any
+// queued reports for the host.
 //
 //*****************************************************************************
 void
@@ -59,6 +62,7 @@ UARTIntHandler(void)
     // Variable to hold the interrupt status
     //
     unsigned long ulStatus;
+    ProfileBegin();
 
     //
     // Get the interrrupt status.
@@ -72,61 +76,83 @@ UARTIntHandler(void)
 
 
     //
-    // Read the next character from the UART and write it into
-    // g_queue buffer for sending to OLED display
+    // Drain the receive FIFO into the packet parser.  Each interrupt can
+    // carry several characters, so read until the FIFO is empty.
     //
-    g_queue[queueCount++] = UARTCharGetNonBlocking(UART0_BASE);
-
-    //Detect start byte sent from computer
-    if(g_queue[queueCount-1] == 0xFF)
+    while(UARTCharsAvail(UART0_BASE))
     {
-        queueCount = 0;
+        LinkRxChar(UARTCharGetNonBlocking(UART0_BASE));
     }
 
-		//Detect an entire frame has completed
-    if((queueCount >=QUEUE_LEN))
+    //Keep the back-channel to the host moving
+    if(ulStatus & UART_INT_TX)
     {
-        pageRecieved = true;
+        LinkTxService();
     }
 
+    ProfileEnd(PROFILE_UART_INT);
 
 }
 
 //*****************************************************************************
 //
 // Initializes UART, SSI, and OLED peripherals. Enables interrupts from UART
-// and from SSI. Waits for a full page of data to be recieived from UART and
-// then sends the page over SSI to the OLED display.
+// and from SSI. Waits for a packet to be recieived from UART, decodes it into
+// a frame slot and then sends the changed parts over SSI to the OLED display.
+//
+// The UART is made ready before the OLED, whose clear takes most of the
+// startup time, so packets the host sends meanwhile are received in the
+// background and decoded as soon as the display is ready.
 //
 //*****************************************************************************
 int
 main(void)
 {
+    unsigned char *pucPacket;
+    const unsigned char *pucRecord;
+    unsigned char ucType;
+    unsigned long ulLength;
+
     //
     // Set the clocking to run directly from the crystal.
     //
     SysCtlClockSet(SYSCTL_SYSDIV_4 | SYSCTL_USE_PLL | SYSCTL_OSC_MAIN |
                    SYSCTL_XTAL_8MHZ);
 
+    //
+    // Start the cycle counter used to time startup, decoding and drawing.
+    //
+    CycleCountInit();
+    BootMark(BOOT_MARK_CLOCK);
+
     //
     // Enable processor interrupts.
     //
     IntMasterEnable();
 
     //
-    // Enable interrupts from SSI0 peripheral
+    // Reset the packet parser and the frame slots.
     //
-    IntEnable(INT_SSI0);
+    LinkInit();
+    VideoInit();
 
     //
-    // Initialize the OLED display.
+    // Start the clock frames the host times are drawn by.
     //
-    RIT128x96x4Init(1000000);
+    PacingInit();
 
     //
-    // Enable the UART peripheral
+    // Play the clip stored in flash, if there is one, until the host sends
+    // something.
+    //
+    ClipInit();
+
+    //
+    // Enable the UART peripheral, and the GPIO port of its pins, which the
+    // OLED driver has not enabled yet.
     //
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
 
     //
     // Set GPIO A0 and A1 as UART pins.
@@ -144,21 +170,89 @@ main(void)
     // Enable the UART interrupt.
     //
     IntEnable(INT_UART0);
-    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT | UART_INT_TX);
+    BootMark(BOOT_MARK_LINK);
+
+    //
+    // Enable interrupts from SSI0 peripheral
+    //
+    IntEnable(INT_SSI0);
 
-    //Loop forever waiting for an image to complete coming over from the UART
+    //
+    // Initialize the OLED display.
+    //
+    RIT128x96x4Init(1000000);
+    BootMark(BOOT_MARK_DISPLAY);
+
+    //Loop forever waiting for packets to complete coming over from the UART
     while(1)
     {
-		    //Wait for incoming image
-    		 if(pageRecieved)
-             {
-                //Display image received
-                RIT128x96x4ImageDraw(g_queue, 0,0, 128,96);
+        //Wait for incoming packet, leaving packets waiting while a decoded
+        //frame waits for its time
+        pucPacket = PacingWaiting() ? 0 : LinkPacketGet(&ucType, &ulLength);
+        if(pucPacket)
+        {
+            //The host takes over from a stored clip
+            ClipStop();
+            BootMark(BOOT_MARK_PACKET);
+
+            //Decode the packet into the back frame slot, or store it
+            if(ucType == LINK_PKT_CLIP)
+            {
+                ClipCommand(pucPacket, ulLength);
+            }
+            else if(ucType == LINK_PKT_TIME)
+            {
+                PacingTime(pucPacket, ulLength);
+            }
+            else if(ucType == LINK_PKT_SYNC)
+            {
+                PacingSync(pucPacket, ulLength, LinkPacketTime());
+            }
+            else if(ucType == LINK_PKT_STAMP)
+            {
+                LatencyStamp(pucPacket, ulLength, LinkPacketTime());
+            }
+            else if(ucType == LINK_PKT_PROFILE)
+            {
+                ProfileReport(pucPacket, ulLength);
+            }
+            else
+            {
+                ProfileBegin();
+                VideoPacketDecode(ucType, pucPacket, ulLength);
+                ProfileEnd(PROFILE_DECODE);
+                LatencyDecoded(LinkPacketTime());
+                PacingDecoded();
+            }
 
+            //Hand the packet's room in the receive ring back to the UART
+            //handler
+            LinkPacketRelease();
 
-                //Reset pageRecieved to false
-                pageRecieved = false;
-             }
+            //Display the changed parts of the decoded frame, when it is due
+            PacingPresent();
+        }
+        else if(PacingWaiting())
+        {
+            //Draw the frame waiting once its time comes
+            PacingPresent();
+        }
+        else
+        {
+            //Play the next record of a stored clip when it is due
+            //Clips are paced by their own frame interval, so any times,
+            //stamps or probe reads in them are ignored
+            pucRecord = ClipNext(&ucType, &ulLength);
+            if(pucRecord && (ucType != LINK_PKT_TIME) &&
+               (ucType != LINK_PKT_SYNC) && (ucType != LINK_PKT_STAMP) &&
+               (ucType != LINK_PKT_PROFILE))
+            {
+                BootMark(BOOT_MARK_PACKET);
+                VideoPacketDecode(ucType, pucRecord, ulLength);
+                VideoPresent();
+            }
+        }
 
     }
 		//
@@ -0,0 +1,102 @@
+#Rate control that keeps the stream within what the serial link can carry
+import hostlink
+from hostframe import STRIDE, HEIGHT
+
+#Bits on the wire per byte: start, 8 data, stop
+BITS_PER_BYTE = 10
+
+#Frames worth of bytes the stream may run ahead of the link before frames
+#are skipped
+BUFFER_FRAMES = 2
+
+#Largest difference between nibbles that is treated as no change
+MAX_THRESHOLD = 4
+
+#Factor the expected frame size at a threshold that is not in use falls by
+#each frame
+DECAY = 0.95
+
+#Size of the cells that are sent or left unchanged as a whole, matching the
+#cells the device redraws
+CELL_SIZE = 8
+
+
+def within(threshold):
+    """Lookup from frame byte << 8 | reference byte to whether both pixels
+    differ by no more than threshold"""
+    table = bytearray(65536)
+    for f in range(256):
+        for r in range(256):
+            table[f << 8 | r] = (abs((f >> 4) - (r >> 4)) <= threshold and
+                                 abs((f & 0xF) - (r & 0xF)) <= threshold)
+    return table
+
+
+class RateController(object):
+    """Decides per frame how small a change to a cell may be ignored, from the
+    size frames came out at each threshold and how far the stream has run
+    ahead of the link, and skips frames the link has no time left for"""
+
+    def __init__(self, fps, bitrate):
+        #Bytes the link carries in one frame time
+        self.budget = float(bitrate) / BITS_PER_BYTE / fps
+        #Bytes sent beyond the link's share so far
+        self.fullness = 0.0
+        #Expected bytes of a frame at each threshold
+        self.sizes = [0.0] * (MAX_THRESHOLD + 1)
+        self.threshold = 0
+        self.skipped = 0
+        self.tables = {}
+
+    def start(self):
+        """Account for the link time of one frame and choose its threshold;
+        returns False if the frame should be skipped"""
+        self.fullness = max(0.0, self.fullness - self.budget)
+        if self.fullness > BUFFER_FRAMES * self.budget:
+            self.skipped += 1
+            return False
+        #The lowest threshold expected to fit in what is left of the budget
+        room = self.budget - self.fullness
+        self.threshold = MAX_THRESHOLD
+        for threshold, size in enumerate(self.sizes):
+            if size <= room:
+                self.threshold = threshold
+                break
+        return True
+
+    def quantise(self, frame, ref):
+        """The frame with every 8x8 cell that changed by no more than the
+        threshold left as it is in ref, so the cell costs nothing to send"""
+        if not self.threshold or ref is None:
+            return frame
+        table = self.tables.get(self.threshold)
+        if table is None:
+            table = self.tables[self.threshold] = within(self.threshold)
+        frame = bytearray(frame)
+        ref = bytearray(ref)
+        out = bytearray(frame)
+        for y in range(0, HEIGHT, CELL_SIZE):
+            for x in range(0, STRIDE, CELL_SIZE // 2):
+                rows = [(y + r) * STRIDE + x for r in range(CELL_SIZE)]
+                if all(table[frame[i] << 8 | ref[i]]
+                       for o in rows for i in range(o, o + CELL_SIZE // 2)):
+                    for o in rows:
+                        out[o:o + CELL_SIZE // 2] = ref[o:o + CELL_SIZE // 2]
+        return out
+
+    def update(self, packets, quantised):
+        """Account for the packets sent for a frame; quantised is True if the
+        threshold applied to it"""
+        size = sum(hostlink.wire_size(t, p) for t, p in packets)
+        self.fullness += size
+        if not quantised:
+            return
+        #A higher threshold never costs more, nor a lower one less.  Other
+        #estimates slowly forget, so lower thresholds are tried again once
+        #the content may have become easier.
+        for threshold in range(MAX_THRESHOLD + 1):
+            if threshold < self.threshold:
+                self.sizes[threshold] = max(self.sizes[threshold] * DECAY, size)
+            elif threshold > self.threshold:
+                self.sizes[threshold] = min(self.sizes[threshold], size)
+        self.sizes[self.threshold] = size
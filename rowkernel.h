@@ -0,0 +1,140 @@
+//*****************************************************************************
+//
+// rowkernel.h - Specialised kernels that expand rows of pixels into the
+// frame layout a word at a time.
+//
+// Frames are stored two 4-bit pixels per byte, leftmost pixel in the high
+// nibble.  Several decode paths produce such rows from other forms: fewer
+// bits per pixel through a palette, half width doubled, or written over the
+// previous contents with exclusive or.  Rather than one loop that tests the
+// depth, scale and operation for every pixel, ROW_KERNEL() defines a
+// function for one combination, so each variant is a short loop that makes a
+// whole output word per iteration:
+//
+//   bits  scale  input per word  word from
+//   1     1      1 byte          table[byte]
+//   1     2      1 nibble        table[nibble]
+//   2     1      2 bytes         table[byte] | table[byte] << 16
+//   2     2      1 byte          table[byte]
+//   4     1      4 bytes         the input word itself
+//   4     2      2 bytes         table[byte] | table[byte] << 16
+//
+// The table for a kernel is built by the function ROW_KERNEL_TABLE()
+// defines, from the grey level of each input pixel value.  Table entries are
+// the output bytes as stored in memory, read as a little endian word; where
+// an entry is half a word only its low half word is used.  Kernels with four
+// bit input and no scaling use no table, and read their input a word at a
+// time, so it must be word aligned.
+//
+// Output is a whole number of words, eight output pixels each.
+//
+//*****************************************************************************
+
+#ifndef __ROWKERNEL_H__
+#define __ROWKERNEL_H__
+
+//*****************************************************************************
+//
+// Entries in the table for a kernel with a given input depth and scale.
+//
+//*****************************************************************************
+#define ROW_KERNEL_TABLE_SIZE(BITS, SCALE)                                    \
+    (((BITS) == 1) && ((SCALE) == 2) ? 16 : 256)
+
+//*****************************************************************************
+//
+// Forms output word ulIdx from the input at pucSrc.  One variant for each
+// input depth and scale.
+//
+//*****************************************************************************
+#define ROW_KERNEL_FETCH_1_1(pucSrc, pulTable, ulIdx)                         \
+    (pulTable[pucSrc[ulIdx]])
+#define ROW_KERNEL_FETCH_1_2(pucSrc, pulTable, ulIdx)                         \
+    (pulTable[(pucSrc[(ulIdx) >> 1] >> ((~(ulIdx) & 1) << 2)) & 0xF])
+#define ROW_KERNEL_FETCH_2_1(pucSrc, pulTable, ulIdx)                         \
+    (pulTable[pucSrc[2 * (ulIdx)]] |                                          \
+     (pulTable[pucSrc[(2 * (ulIdx)) + 1]] << 16))
+#define ROW_KERNEL_FETCH_2_2(pucSrc, pulTable, ulIdx)                         \
+    (pulTable[pucSrc[ulIdx]])
+#define ROW_KERNEL_FETCH_4_1(pucSrc, pulTable, ulIdx)                         \
+    (((const uint32_t *)(pucSrc))[ulIdx])
+#define ROW_KERNEL_FETCH_4_2(pucSrc, pulTable, ulIdx)                         \
+    ROW_KERNEL_FETCH_2_1(pucSrc, pulTable, ulIdx)
+
+//*****************************************************************************
+//
+// Writes an output word.  COPY replaces what was there, XOR flips the bits
+// of the pixels already there.
+//
+//*****************************************************************************
+#define ROW_KERNEL_STORE_COPY(pulDst, ulWord)                                 \
+    *(pulDst) = (ulWord)
+#define ROW_KERNEL_STORE_XOR(pulDst, ulWord)                                  \
+    *(pulDst) ^= (ulWord)
+
+//*****************************************************************************
+//
+// Defines a kernel
+//
+//   static void NAME(uint32_t *pulDst, const unsigned char *pucSrc,
+//                    const uint32_t *pulTable, unsigned long ulWords)
+//
+// that writes ulWords words of output to pulDst from the input at pucSrc,
+// with BITS of 1, 2 or 4 bits per input pixel, SCALE of 1, or 2 to double
+// every pixel, and OP of COPY or XOR.
+//
+//*****************************************************************************
+#define ROW_KERNEL(NAME, BITS, SCALE, OP)                                     \
+    static void                                                               \
+    NAME(uint32_t *pulDst, const unsigned char *pucSrc,                       \
+         const uint32_t *pulTable, unsigned long ulWords)                     \
+    {                                                                         \
+        unsigned long ulIdx;                                                  \
+                                                                              \
+        (void)pulTable;                                                       \
+        for(ulIdx = 0; ulIdx < ulWords; ulIdx++)                              \
+        {                                                                     \
+            ROW_KERNEL_STORE_##OP(pulDst + ulIdx,                             \
+                                  ROW_KERNEL_FETCH_##BITS##_##SCALE(          \
+                                      pucSrc, pulTable, ulIdx));              \
+        }                                                                     \
+    }
+
+//*****************************************************************************
+//
+// Defines a function
+//
+//   static void NAME(uint32_t *pulTable, const unsigned char *pucLevel)
+//
+// that builds the table for kernels with BITS bits per input pixel and
+// SCALE, where pucLevel holds the 4-bit grey level of each of the 1 << BITS
+// input values.  Output pixel n of an entry is in byte n / 2, in the high
+// nibble for even n, and comes from input pixel n / SCALE of the index.
+//
+//*****************************************************************************
+#define ROW_KERNEL_TABLE(NAME, BITS, SCALE)                                   \
+    static void                                                               \
+    NAME(uint32_t *pulTable, const unsigned char *pucLevel)                   \
+    {                                                                         \
+        unsigned long ulIn, ulPixel, ulPixels, ulOut, ulShift;                \
+        uint32_t ulEntry;                                                     \
+                                                                              \
+        ulPixels = ((ROW_KERNEL_TABLE_SIZE(BITS, SCALE) == 16) ? 4 :          \
+                    (8 / (BITS))) * (SCALE);                                  \
+        for(ulIn = 0; ulIn < ROW_KERNEL_TABLE_SIZE(BITS, SCALE); ulIn++)      \
+        {                                                                     \
+            ulEntry = 0;                                                      \
+            for(ulOut = 0; ulOut < ulPixels; ulOut++)                         \
+            {                                                                 \
+                ulPixel = ulOut / (SCALE);                                    \
+                ulShift = (((ulPixels / (SCALE)) - 1 - ulPixel) * (BITS));    \
+                ulEntry |= ((uint32_t)                                        \
+                            pucLevel[(ulIn >> ulShift) &                      \
+                                     ((1 << (BITS)) - 1)] <<                  \
+                            ((8 * (ulOut / 2)) + ((ulOut & 1) ? 0 : 4)));     \
+            }                                                                 \
+            pulTable[ulIn] = ulEntry;                                         \
+        }                                                                     \
+    }
+
+#endif // __ROWKERNEL_H__
@@ -0,0 +1,90 @@
+#Encoder for the scaled frames that the device scales up as it draws them
+from hostframe import WIDTH, HEIGHT
+
+#Scaled frame flags, matching video.h
+HALF_X = 0x01
+HALF_Y = 0x02
+FILTER = 0x04
+
+#Frame sizes selectable on the command line
+SIZES = {'64x48': HALF_X | HALF_Y, '64x96': HALF_X, '128x48': HALF_Y}
+
+
+def unpack(frame, width):
+    """Rows of 4-bit pixels from packed data"""
+    data = bytearray(frame)
+    pixels = []
+    for b in data:
+        pixels.append(b >> 4)
+        pixels.append(b & 0xF)
+    return [pixels[i:i + width] for i in range(0, len(pixels), width)]
+
+
+def pack(rows):
+    """Packed data from rows of 4-bit pixels"""
+    out = bytearray()
+    for row in rows:
+        for i in range(0, len(row), 2):
+            out.append(row[i] << 4 | row[i + 1])
+    return out
+
+
+def average(a, b):
+    """The rounded down average the device uses"""
+    return (a + b) >> 1
+
+
+def widen(row, filter):
+    """Double a row of pixels as the device does"""
+    out = []
+    for i, p in enumerate(row):
+        out.append(p)
+        if filter:
+            out.append(average(p, row[i + 1] if i + 1 < len(row) else p))
+        else:
+            out.append(p)
+    return out
+
+
+def shrink(frame, flags):
+    """Average a full size packed frame down to the size flags select"""
+    rows = unpack(frame, WIDTH)
+    if flags & HALF_X:
+        rows = [[(r[i] + r[i + 1] + 1) >> 1 for i in range(0, WIDTH, 2)]
+                for r in rows]
+    if flags & HALF_Y:
+        rows = [[(a + b + 1) >> 1 for a, b in zip(rows[i], rows[i + 1])]
+                for i in range(0, HEIGHT, 2)]
+    return pack(rows)
+
+
+def expand(small, flags):
+    """The full size frame the device shows for a scaled frame"""
+    filter = bool(flags & FILTER)
+    width = WIDTH // 2 if flags & HALF_X else WIDTH
+    rows = unpack(small, width)
+    if flags & HALF_X:
+        rows = [widen(r, filter) for r in rows]
+    if flags & HALF_Y:
+        out = []
+        for i, r in enumerate(rows):
+            out.append(r)
+            if filter and i + 1 < len(rows):
+                out.append([average(a, b) for a, b in zip(r, rows[i + 1])])
+            else:
+                out.append(r)
+        rows = out
+    return pack(rows)
+
+
+class ScaleEncoder(object):
+    """Sends frames at reduced size for the device to scale up"""
+
+    def __init__(self, size='64x48', filter=False):
+        self.flags = SIZES[size] | (FILTER if filter else 0)
+
+    def encode(self, frame):
+        """Encode a frame, returning the payload and the frame the device will
+        show"""
+        small = shrink(frame, self.flags)
+        return bytearray([self.flags]) + small, expand(small, self.flags)
@@ -0,0 +1,25 @@
+#Encoder for the scroll frames that the device shows by moving the display's
+#start line and drawing only the rows uncovered at the bottom
+from hostframe import STRIDE, HEIGHT
+
+#Largest scroll looked for, in rows; scrolling further saves little over
+#sending the frame
+MAX_ROWS = HEIGHT // 2
+
+
+class ScrollEncoder(object):
+    """Finds frames that are the reference moved up by whole rows"""
+
+    def encode(self, frame, ref):
+        """Return the scroll packet for a packed frame that is ref moved up
+        with new rows below it, or None if it is not one.  Frames equal to
+        ref are left to the other codecs, which send them for less."""
+        data = bytearray(frame)
+        ref = bytearray(ref)
+        if data == ref:
+            return None
+        for rows in range(1, MAX_ROWS + 1):
+            size = rows * STRIDE
+            if data[:-size] == ref[size:]:
+                return bytearray([rows]) + data[-size:]
+        return None
@@ -0,0 +1,333 @@
+//*****************************************************************************
+//
+// sprite.c - Sprites composited over a background frame.
+//
+// For animated indicators and simple games the host uploads small images
+// once, in sprite image packets
+//
+//   byte 0        image number
+//   byte 1        width in pixels, 1 to SPRITE_MAX_SIZE
+//   byte 2        height in pixels, 1 to SPRITE_MAX_SIZE
+//   byte 3        the transparent grey level
+//   rest          the rows of pixels, two per byte, each row padded to a
+//                 whole byte
+//
+// and then sends each frame as the list of sprites to show, in sprite
+// packets
+//
+//   byte 0        flags (SPRITE_FLAG_*)
+//   rest          for each sprite, back to front: image number, x and y of
+//                 its top left corner, each plus SPRITE_OFFSET
+//
+// which is three bytes a sprite.  The sprites are composited over a
+// background frame, which a packet with SPRITE_FLAG_BACKGROUND takes from the
+// frame on display.
+//
+// Only the cells covered by sprites that changed are redrawn.  The list is
+// compared with the one before entry by entry; for each entry that differs,
+// or whose image was loaded again, the cells under both the old and the new
+// sprite are restored from the background and the sprites over them drawn
+// again in order.  Elsewhere every pixel is covered by the same sprites in
+// the same order as before, so it is already right.
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "video.h"
+#include "sprite.h"
+
+//*****************************************************************************
+//
+// A sprite image.
+//
+//*****************************************************************************
+typedef struct
+{
+    unsigned char ucWidth;
+    unsigned char ucHeight;
+    unsigned char ucTransparent;
+    unsigned char pucPixels[SPRITE_IMAGE_BYTES];
+}
+tSpriteImage;
+
+//*****************************************************************************
+//
+// The images, masks of those loaded and of those loaded since the last sprite
+// packet, the background and the list of sprites on display, three bytes each
+// as sent, with the size each was drawn at.
+//
+//*****************************************************************************
+static tSpriteImage g_psSpriteImage[SPRITE_IMAGES];
+static unsigned long g_ulSpriteLoaded;
+static unsigned long g_ulSpriteReloaded;
+static unsigned char g_pucSpriteBackground[FRAME_BYTES];
+static unsigned char g_pucSpriteList[SPRITE_COUNT * 3];
+static unsigned char g_ppucSpriteSize[SPRITE_COUNT][2];
+static unsigned long g_ulSpriteCount;
+
+//*****************************************************************************
+//
+// Marks the cells under a sprite, given as it is sent, of a given size as
+// dirty.
+//
+//*****************************************************************************
+static void
+SpriteMark(const unsigned char *pucSprite, unsigned long ulWidth,
+           unsigned long ulHeight, unsigned short *pusDirty)
+{
+    long lX0, lY0, lX1, lY1;
+    unsigned short usMask;
+
+    lX0 = (long)pucSprite[1] - SPRITE_OFFSET;
+    lY0 = (long)pucSprite[2] - SPRITE_OFFSET;
+    lX1 = lX0 + ulWidth - 1;
+    lY1 = lY0 + ulHeight - 1;
+    if((lX1 < 0) || (lY1 < 0) || (lX0 >= FRAME_WIDTH) ||
+       (lY0 >= FRAME_HEIGHT))
+    {
+        return;
+    }
+    lX0 = (lX0 < 0) ? 0 : lX0;
+    lY0 = (lY0 < 0) ? 0 : lY0;
+    lX1 = (lX1 >= FRAME_WIDTH) ? (FRAME_WIDTH - 1) : lX1;
+    lY1 = (lY1 >= FRAME_HEIGHT) ? (FRAME_HEIGHT - 1) : lY1;
+
+    usMask = (((2 << (lX1 / VIDEO_CELL_SIZE)) - 1) &
+              ~((1 << (lX0 / VIDEO_CELL_SIZE)) - 1));
+    for(lY0 /= VIDEO_CELL_SIZE; lY0 <= (lY1 / VIDEO_CELL_SIZE); lY0++)
+    {
+        pusDirty[lY0] |= usMask;
+    }
+}
+
+//*****************************************************************************
+//
+// Draws the pixels of a sprite, given as it is sent, that lie in dirty cells
+// and are not transparent.
+//
+//*****************************************************************************
+static void
+SpriteDraw(const unsigned char *pucSprite, unsigned char *pucFrame,
+           const unsigned short *pusDirty)
+{
+    const tSpriteImage *psImage;
+    const unsigned char *pucRow;
+    unsigned char *pucByte;
+    unsigned long ulRow, ulColumn, ulPixel, ulStride;
+    long lX, lY;
+
+    psImage = &g_psSpriteImage[pucSprite[0]];
+    ulStride = (psImage->ucWidth + 1) / 2;
+    for(ulRow = 0; ulRow < psImage->ucHeight; ulRow++)
+    {
+        lY = (long)pucSprite[2] - SPRITE_OFFSET + ulRow;
+        if((lY < 0) || (lY >= FRAME_HEIGHT) ||
+           !pusDirty[lY / VIDEO_CELL_SIZE])
+        {
+            continue;
+        }
+        pucRow = psImage->pucPixels + (ulRow * ulStride);
+        for(ulColumn = 0; ulColumn < psImage->ucWidth; ulColumn++)
+        {
+            lX = (long)pucSprite[1] - SPRITE_OFFSET + ulColumn;
+            if((lX < 0) || (lX >= FRAME_WIDTH) ||
+               !(pusDirty[lY / VIDEO_CELL_SIZE] &
+                 (1 << (lX / VIDEO_CELL_SIZE))))
+            {
+                continue;
+            }
+            ulPixel = pucRow[ulColumn / 2];
+            ulPixel = (ulColumn & 1) ? (ulPixel & 0xF) : (ulPixel >> 4);
+            if(ulPixel == psImage->ucTransparent)
+            {
+                continue;
+            }
+            pucByte = pucFrame + (lY * FRAME_STRIDE) + (lX / 2);
+            if(lX & 1)
+            {
+                *pucByte = (*pucByte & 0xF0) | ulPixel;
+            }
+            else
+            {
+                *pucByte = (*pucByte & 0x0F) | (ulPixel << 4);
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Loads a sprite image.
+//!
+//! \param pucData is a pointer to the sprite image packet.
+//! \param ulLength is the number of bytes in the packet.
+//!
+//! A malformed packet that names a valid image leaves that image unloaded.
+//!
+//! \return Returns 0 on success or -1 if the packet is malformed.
+//
+//*****************************************************************************
+long
+SpriteImageLoad(const unsigned char *pucData, unsigned long ulLength)
+{
+    tSpriteImage *psImage;
+
+    if((ulLength < 4) || (pucData[0] >= SPRITE_IMAGES))
+    {
+        return(-1);
+    }
+    g_ulSpriteLoaded &= ~(1UL << pucData[0]);
+    g_ulSpriteReloaded |= 1UL << pucData[0];
+    if((pucData[1] == 0) || (pucData[1] > SPRITE_MAX_SIZE) ||
+       (pucData[2] == 0) || (pucData[2] > SPRITE_MAX_SIZE) ||
+       (pucData[3] > 15) ||
+       (ulLength != (4UL + (((pucData[1] + 1) / 2) * pucData[2]))))
+    {
+        return(-1);
+    }
+
+    psImage = &g_psSpriteImage[pucData[0]];
+    psImage->ucWidth = pucData[1];
+    psImage->ucHeight = pucData[2];
+    psImage->ucTransparent = pucData[3];
+    memcpy(psImage->pucPixels, pucData + 4, ulLength - 4);
+    g_ulSpriteLoaded |= 1UL << pucData[0];
+    g_ulSpriteReloaded |= 1UL << pucData[0];
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Forgets every sprite image, so sprite packets are refused until the images
+//! they use are loaded again.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+SpriteForget(void)
+{
+    g_ulSpriteLoaded = 0;
+}
+
+//*****************************************************************************
+//
+//! Composites the sprites of a sprite packet.
+//!
+//! \param pucData is a pointer to the sprite packet.
+//! \param ulLength is the number of bytes in the packet.
+//! \param pucFrame is the frame to composite into, which must already hold
+//! the previous frame.  Unless the packet has \b SPRITE_FLAG_BACKGROUND set,
+//! that must be the sprite frame decoded last.
+//! \param pusDirty is an array of \b VIDEO_BANDS masks, which must be clear;
+//! the bit for every cell redrawn is set.
+//!
+//! The packet is checked before anything is changed, so a packet that is
+//! refused leaves the sprites as they were.
+//!
+//! \return Returns 0 on success, 1 if the packet uses an image that is not
+//! loaded or -1 if the packet is malformed.
+//
+//*****************************************************************************
+long
+SpriteDecode(const unsigned char *pucData, unsigned long ulLength,
+             unsigned char *pucFrame, unsigned short *pusDirty)
+{
+    const unsigned char *pucOld, *pucNew;
+    unsigned long ulCount, ulIdx, ulBand, ulRow, ulOffset;
+    long lResult;
+
+    if((ulLength == 0) || (((ulLength - 1) % 3) != 0) ||
+       (((ulLength - 1) / 3) > SPRITE_COUNT))
+    {
+        return(-1);
+    }
+    ulCount = (ulLength - 1) / 3;
+    lResult = 0;
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        if(pucData[1 + (ulIdx * 3)] >= SPRITE_IMAGES)
+        {
+            return(-1);
+        }
+        if(!(g_ulSpriteLoaded & (1UL << pucData[1 + (ulIdx * 3)])))
+        {
+            lResult = 1;
+        }
+    }
+    if(lResult)
+    {
+        return(lResult);
+    }
+
+    if(pucData[0] & SPRITE_FLAG_BACKGROUND)
+    {
+        memcpy(g_pucSpriteBackground, pucFrame, FRAME_BYTES);
+        g_ulSpriteCount = 0;
+    }
+
+    //
+    // Find the cells under entries that changed.
+    //
+    for(ulIdx = 0; (ulIdx < ulCount) || (ulIdx < g_ulSpriteCount); ulIdx++)
+    {
+        pucOld = g_pucSpriteList + (ulIdx * 3);
+        pucNew = pucData + 1 + (ulIdx * 3);
+        if((ulIdx < ulCount) && (ulIdx < g_ulSpriteCount) &&
+           !memcmp(pucNew, pucOld, 3) &&
+           !(g_ulSpriteReloaded & (1UL << pucNew[0])))
+        {
+            continue;
+        }
+        if(ulIdx < g_ulSpriteCount)
+        {
+            SpriteMark(pucOld, g_ppucSpriteSize[ulIdx][0],
+                       g_ppucSpriteSize[ulIdx][1], pusDirty);
+        }
+        if(ulIdx < ulCount)
+        {
+            SpriteMark(pucNew, g_psSpriteImage[pucNew[0]].ucWidth,
+                       g_psSpriteImage[pucNew[0]].ucHeight, pusDirty);
+        }
+    }
+
+    //
+    // Restore those cells from the background, then draw the sprites over
+    // them back to front.
+    //
+    for(ulBand = 0; ulBand < VIDEO_BANDS; ulBand++)
+    {
+        for(ulIdx = 0; ulIdx < VIDEO_CELL_COLS; ulIdx++)
+        {
+            if(!(pusDirty[ulBand] & (1 << ulIdx)))
+            {
+                continue;
+            }
+            for(ulRow = 0; ulRow < VIDEO_CELL_SIZE; ulRow++)
+            {
+                ulOffset = ((((ulBand * VIDEO_CELL_SIZE) + ulRow) *
+                             FRAME_STRIDE) + (ulIdx * (VIDEO_CELL_SIZE / 2)));
+                memcpy(pucFrame + ulOffset, g_pucSpriteBackground + ulOffset,
+                       VIDEO_CELL_SIZE / 2);
+            }
+        }
+    }
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        SpriteDraw(pucData + 1 + (ulIdx * 3), pucFrame, pusDirty);
+    }
+
+    memcpy(g_pucSpriteList, pucData + 1, ulCount * 3);
+    for(ulIdx = 0; ulIdx < ulCount; ulIdx++)
+    {
+        g_ppucSpriteSize[ulIdx][0] =
+            g_psSpriteImage[g_pucSpriteList[ulIdx * 3]].ucWidth;
+        g_ppucSpriteSize[ulIdx][1] =
+            g_psSpriteImage[g_pucSpriteList[ulIdx * 3]].ucHeight;
+    }
+    g_ulSpriteCount = ulCount;
+    g_ulSpriteReloaded = 0;
+
+    return(0);
+}
@@ -0,0 +1,54 @@
+//*****************************************************************************
+//
+// sprite.h - Sprites composited over a background frame.
+//
+//*****************************************************************************
+
+#ifndef __SPRITE_H__
+#define __SPRITE_H__
+
+//*****************************************************************************
+//
+// Sprite images.  An image is up to SPRITE_MAX_SIZE pixels square, stored as
+// rows of two pixels per byte laid out as in a frame, with one grey level
+// that is transparent.
+//
+//*****************************************************************************
+#define SPRITE_IMAGES           32
+#define SPRITE_MAX_SIZE         16
+#define SPRITE_IMAGE_BYTES      (SPRITE_MAX_SIZE * SPRITE_MAX_SIZE / 2)
+
+//*****************************************************************************
+//
+// The most sprites shown at once.
+//
+//*****************************************************************************
+#define SPRITE_COUNT            16
+
+//*****************************************************************************
+//
+// Sprite positions are sent with this added, so a sprite can move off the
+// left and top edges of the display as well as the right and bottom.
+//
+//*****************************************************************************
+#define SPRITE_OFFSET           SPRITE_MAX_SIZE
+
+//*****************************************************************************
+//
+// Flags carried in the first byte of a sprite packet.
+//
+//*****************************************************************************
+#define SPRITE_FLAG_BACKGROUND  0x01        // Shown frame is background
+
+//*****************************************************************************
+//
+// Prototypes for the sprite APIs.
+//
+//*****************************************************************************
+extern long SpriteImageLoad(const unsigned char *pucData,
+                            unsigned long ulLength);
+extern void SpriteForget(void);
+extern long SpriteDecode(const unsigned char *pucData, unsigned long ulLength,
+                         unsigned char *pucFrame, unsigned short *pusDirty);
+
+#endif // __SPRITE_H__
@@ -0,0 +1,97 @@
+#Sprites composited by the device over a background frame, matching sprite.h
+#on the device
+import hostframe, hostlink
+from hostframe import WIDTH, HEIGHT, STRIDE
+
+#Image limits
+IMAGES = 32
+MAX_SIZE = 16
+#Most sprites shown at once
+COUNT = 16
+#Added to sprite positions so they can leave the top and left edges
+OFFSET = MAX_SIZE
+
+#Flags in the first byte of a sprite packet
+FLAG_BACKGROUND = 0x01
+
+
+class SpriteLayer(object):
+    """Sends sprites over a background frame: each image once, then the
+    list of sprites for every frame.  After request_keyframe() the next
+    frame sends the background and every image it uses again."""
+
+    def __init__(self, background):
+        self.background = bytearray(background)
+        self.images = {}
+        self.sent = set()
+        self.reset = True
+
+    def request_keyframe(self):
+        self.reset = True
+
+    def decoded(self, ptype, length, cycles):
+        pass
+
+    def image(self, number, width, height, pixels, transparent=0):
+        """Set an image from its rows of 4-bit levels; pixels of the
+        transparent level show what is under the sprite"""
+        if not (0 <= number < IMAGES and 0 < width <= MAX_SIZE and
+                0 < height <= MAX_SIZE):
+            raise ValueError('bad sprite image %d (%dx%d)' % (number, width,
+                                                            height))
+        stride = (width + 1) // 2
+        data = bytearray(stride * height)
+        for y in range(height):
+            for x in range(width):
+                data[y * stride + x // 2] |= (pixels[y * width + x] <<
+                                              (0 if x & 1 else 4))
+        self.images[number] = (width, height, transparent, data)
+        self.sent.discard(number)
+
+    def show(self, sprites):
+        """Return the (type, payload) packets that show a list of (image, x,
+        y) sprites, back to front"""
+        if len(sprites) > COUNT:
+            raise ValueError('too many sprites: %d' % len(sprites))
+        packets = []
+        flags = 0
+        if self.reset:
+            packets.append((hostlink.PKT_RAW, self.background))
+            flags = FLAG_BACKGROUND
+            self.sent = set()
+            self.reset = False
+        payload = bytearray([flags])
+        for number, x, y in sprites:
+            if number not in self.sent:
+                width, height, transparent, data = self.images[number]
+                packets.append((hostlink.PKT_SPRITE_IMAGE,
+                                bytearray([number, width, height,
+                                           transparent]) + data))
+                self.sent.add(number)
+            payload += bytearray([number, max(0, min(255, x + OFFSET)),
+                                  max(0, min(255, y + OFFSET))])
+        packets.append((hostlink.PKT_SPRITE, payload))
+        return packets
+
+    def render(self, sprites):
+        """The frame the device shows for a list of sprites"""
+        frame = bytearray(self.background)
+        for number, x, y in sprites:
+            width, height, transparent, data = self.images[number]
+            x = max(0, min(255, x + OFFSET)) - OFFSET
+            y = max(0, min(255, y + OFFSET)) - OFFSET
+            stride = (width + 1) // 2
+            for row in range(height):
+                for col in range(width):
+                    level = data[row * stride + col // 2]
+                    level = level & 0xF if col & 1 else level >> 4
+                    px, py = x + col, y + row
+                    if (level == transparent or not 0 <= px < WIDTH or
+                            not 0 <= py < HEIGHT):
+                        continue
+                    i = py * STRIDE + px // 2
+                    if px & 1:
+                        frame[i] = (frame[i] & 0xF0) | level
+                    else:
+                        frame[i] = (frame[i] & 0x0F) | level << 4
+        return frame
@@ -0,0 +1,93 @@
+#Sprite demo: balls bouncing over a background and a blinking indicator,
+#sent as sprite positions rather than frames
+import sys, argparse
+import serial
+import hostframe, hostlink, sprite
+
+#Set serial baud rate
+baud = 1500000
+comPort = 'COM9'
+
+parser = argparse.ArgumentParser(description='Animate sprites on the LM3S6965 OLED display')
+parser.add_argument('--port', default=comPort, help='serial port of the board')
+parser.add_argument('--fps', type=float, default=30,
+                    help='frames per second (default 30)')
+parser.add_argument('--frames', type=int, default=0,
+                    help='frames to send, 0 to run until interrupted')
+parser.add_argument('--balls', type=int, default=6,
+                    help='number of bouncing balls (default 6)')
+parser.add_argument('--dump', metavar='FILE',
+                    help='write the packets to FILE for bench/decbench rather '
+                    'than send them')
+args = parser.parse_args()
+
+#Image numbers
+BALL, LAMP_ON, LAMP_OFF = 0, 1, 2
+BALL_SIZE = 12
+
+
+def background():
+    """A grid over a gradient"""
+    pixels = bytearray(hostframe.WIDTH * hostframe.HEIGHT)
+    for y in range(hostframe.HEIGHT):
+        for x in range(hostframe.WIDTH):
+            level = 1 + (x + y) // 45
+            if x % 16 == 0 or y % 16 == 0:
+                level = 5
+            pixels[y * hostframe.WIDTH + x] = level << 4
+    return hostframe.pack(pixels)
+
+
+def disc(size, level, edge):
+    """A disc with a darker rim; the corners are transparent"""
+    pixels = []
+    r = size / 2.0
+    for y in range(size):
+        for x in range(size):
+            d = ((x + 0.5 - r) ** 2 + (y + 0.5 - r) ** 2) ** 0.5
+            pixels.append(0 if d > r else edge if d > r - 1.5 else level)
+    return pixels
+
+
+layer = sprite.SpriteLayer(background())
+layer.image(BALL, BALL_SIZE, BALL_SIZE, disc(BALL_SIZE, 15, 10))
+layer.image(LAMP_ON, 8, 8, disc(8, 15, 12))
+layer.image(LAMP_OFF, 8, 8, disc(8, 3, 6))
+balls = [[(17 * i) % 110, (29 * i) % 80, 1 + i % 3, 1 + (i + 1) % 2]
+         for i in range(min(args.balls, sprite.COUNT - 1))]
+
+
+def step(n):
+    """Move the balls on a frame and return the sprites to show"""
+    sprites = [(LAMP_ON if (n // 15) % 2 else LAMP_OFF, 118, 2)]
+    for ball in balls:
+        for axis, limit in ((0, hostframe.WIDTH), (1, hostframe.HEIGHT)):
+            ball[axis] += ball[axis + 2]
+            if not 0 <= ball[axis] <= limit - BALL_SIZE:
+                ball[axis + 2] = -ball[axis + 2]
+                ball[axis] += 2 * ball[axis + 2]
+        sprites.append((BALL, ball[0], ball[1]))
+    return sprites
+
+
+def packets(n):
+    """The packets that show frame n"""
+    return layer.show(step(n))
+
+
+if args.dump:
+    hostlink.write_records(args.dump, [packet for n in range(args.frames or 300)
+                                       for packet in packets(n)])
+    sys.exit(0)
+
+try:
+    ser = serial.Serial(args.port, baud)
+    stats, sent, n = hostlink.stream(ser, packets, args.fps, layer, args.frames)
+except KeyboardInterrupt:
+    sys.exit(0)
+except serial.SerialException:
+    sys.exit('Error: Serial Error. Please check that the board is connected')
+
+if stats.types:
+    print(stats.summary())
+print('Sent %d bytes, %.1f bytes/frame' % (sent, float(sent) / max(n, 1)))
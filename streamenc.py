@@ -0,0 +1,335 @@
+#Turns a sequence of packed frames into packets for the device
+import hostlink
+from hostframe import FRAME_BYTES
+from blockcodec import BlockEncoder, ROWS as BLOCK_ROWS
+from tilecodec import TileEncoder
+from lzcodec import LZEncoder
+from huffcodec import HuffEncoder
+from planecodec import PlaneEncoder, PLANE_COUNT
+from depthcodec import DepthEncoder
+from scalecodec import ScaleEncoder
+from fieldcodec import FieldEncoder
+from scrollcodec import ScrollEncoder
+from framecache import FrameCache
+from ratecontrol import BITS_PER_BYTE
+
+#Codecs that can be selected on the command line
+CODECS = ['raw', 'block', 'tile', 'vq', 'lz', 'huff', 'planes',
+          '1bpp', '2bpp', 'scaled', 'field', 'auto']
+
+#Device cycles taken by a byte on the serial link at 1.5 Mbaud
+LINK_CYCLES = float(hostlink.CPU_HZ) * BITS_PER_BYTE / 1500000
+
+#Decode cycles per payload byte for the codecs the auto codec chooses from,
+#until the device has reported its own
+DECODE_CYCLES = {hostlink.PKT_RAW: 1.0, hostlink.PKT_BLOCK: 2.0,
+                 hostlink.PKT_LZ: 8.0, hostlink.PKT_HUFF: 30.0}
+
+#Weight of each new device report in the decode cycles per byte
+DECODE_WEIGHT = 0.1
+
+#Codecs whose frames build on the reference frame as the device holds it, so
+#can be replaced by scroll frames and cached frames
+REF_CODECS = ('raw', 'block', 'lz', 'huff', 'auto')
+
+#Frames to wait after a keyframe before honouring another keyframe request,
+#since frames already in flight will also be reported as undecodable
+KEYFRAME_HOLDOFF = 4
+
+
+class StreamEncoder(object):
+    """Keeps the host's copy of the device reference frame and tile cache and
+    chooses the packet type for each frame"""
+
+    def __init__(self, codec='block', keyint=60, draw_planes=1,
+                 scale='64x48', filter=False, rate=None, refresh=False,
+                 scroll=False, cache=False, latency=100):
+        self.codec = codec
+        self.keyint = keyint
+        #With the block codec, refresh a band of blocks in every frame in
+        #place of keyframes
+        self.refresh = refresh
+        self.refresh_band = 0
+        #Send frames that are the last one moved up as scroll frames
+        self.scroll = scroll and codec in REF_CODECS
+        #Keep frames that come round again in the device's frame cache
+        self.cache = cache and codec in REF_CODECS
+        self.frames = FrameCache()
+        #Milliseconds the device holds frames given a time before drawing
+        #them, which absorbs jitter on the link
+        self.latency = latency
+        #Optional RateController that keeps the stream within the link rate
+        self.rate = rate
+        #Set by the sender while the port has a backlog
+        self.congested = False
+        self.ref = None
+        self.since_key = 0
+        self.want_key = False
+        #Whether the rate controller's threshold applied to the last frame
+        self.quantised = False
+        #With the auto codec, the decode cost per byte of each packet type
+        #and the frames and bytes sent of each
+        self.decode_cycles = dict(DECODE_CYCLES)
+        self.chosen = {}
+        self.block = BlockEncoder()
+        self.tile = TileEncoder()
+        self.lz = LZEncoder()
+        self.huff = HuffEncoder()
+        self.planes = PlaneEncoder(draw_planes)
+        self.depth = DepthEncoder(2 if codec == '2bpp' else 1)
+        self.scale = ScaleEncoder(scale, filter)
+        self.field = FieldEncoder()
+        self.scroller = ScrollEncoder()
+        #The device tile cache may hold anything until a reset frame is sent
+        self.tile_reset = True
+        #The VQ codec needs numpy, so only load it when it is used
+        self.vq = None
+        if codec == 'vq':
+            from vqcodec import VQEncoder
+            self.vq = VQEncoder()
+
+    def request_keyframe(self):
+        """Ask for the next frame to be self-contained; called when the device
+        reports it lost its reference frame or tile cache.  Refresh frames
+        rebuild the reference by themselves within two cycles."""
+        if self.since_key >= KEYFRAME_HOLDOFF and not self.refresh:
+            self.want_key = True
+            self.tile_reset = True
+        #The device empties its frame cache after a lost packet, and a frame
+        #it did not have shows the mirror is wrong
+        self.frames.reset()
+
+    @property
+    def needs_clip(self):
+        """True if pretrain() should be given the clip before encoding"""
+        return self.vq is not None or self.codec in ('huff', 'auto')
+
+    def pretrain(self, frames):
+        """Prepare codec state for a whole clip ahead of time, where the codec
+        benefits from it"""
+        if self.vq:
+            self.vq.pretrain(frames)
+        elif self.codec in ('huff', 'auto'):
+            self.huff.pretrain(frames)
+
+    def encode(self, frame, pts=None):
+        """Encode one packed frame, returning a list of (packet type, payload)
+        to send in order, which is empty if the frame is skipped.  With pts,
+        the device draws the frame pts milliseconds into the stream."""
+        packets = []
+        if self.rate and not self.rate.start():
+            return packets
+        self.quantised = False
+        ptype = hostlink.PKT_RAW
+        payload = frame
+        source = frame
+        cached = self.frames.lookup(frame) if self.cache else None
+        scroll = None
+        if self.scroll and self.ref is not None and not self.want_key:
+            scroll = self.scroller.encode(frame, self.ref)
+        if cached is not None:
+            #A cached frame stands alone and is shown as it was stored
+            ptype = hostlink.PKT_CACHE_SHOW
+            payload = bytearray([cached[0]])
+            frame = cached[1]
+            self.since_key = 0
+            self.want_key = False
+        elif scroll is not None:
+            #The rows kept are already on the display, so only the new ones
+            #are sent, and the frame is exactly what was asked for
+            ptype = hostlink.PKT_SCROLL
+            payload = scroll
+        if ptype in (hostlink.PKT_CACHE_SHOW, hostlink.PKT_SCROLL):
+            if self.codec == 'auto':
+                count = self.chosen.setdefault(ptype, [0, 0])
+                count[0] += 1
+                count[1] += hostlink.wire_size(ptype, payload)
+        elif self.codec == 'auto':
+            tables, ptype, payload, frame = self.choose(frame)
+            packets.extend(tables)
+        elif self.codec == 'block' and self.refresh:
+            #Every frame refreshes the next band, so the cost of recovering
+            #from a loss is spread evenly rather than sent as keyframes
+            if self.ref is not None:
+                lossy = self.quantise(frame)
+                block = self.block.encode(lossy, self.ref, self.refresh_band)
+                if len(block) < FRAME_BYTES:
+                    ptype = hostlink.PKT_REFRESH
+                    payload = bytearray([self.refresh_band]) + block
+                    frame = lossy
+                    self.refresh_band = (self.refresh_band + 1) % BLOCK_ROWS
+        elif self.codec == 'block':
+            if (self.ref is not None and not self.want_key and
+                    not (self.keyint and self.since_key >= self.keyint)):
+                lossy = self.quantise(frame)
+                block = self.block.encode(lossy, self.ref)
+                #Fall back to a raw frame when nothing was gained
+                if len(block) < FRAME_BYTES:
+                    ptype = hostlink.PKT_BLOCK
+                    payload = block
+                    frame = lossy
+        elif self.codec == 'tile':
+            #Tile frames do not use the reference frame, only the cache
+            tile = self.tile.encode(frame, self.tile_reset, FRAME_BYTES - 1)
+            if tile is not None:
+                ptype = hostlink.PKT_TILE
+                payload = tile
+                if self.tile_reset:
+                    self.tile_reset = False
+                    self.since_key = 0
+                    self.want_key = False
+        elif self.codec == 'vq':
+            #VQ frames are lossy, so the reference becomes the reconstruction
+            codebook, payload, frame = self.vq.encode(frame, self.want_key)
+            ptype = hostlink.PKT_VQ
+            if codebook:
+                packets.append((hostlink.PKT_VQ_CODEBOOK, codebook))
+                self.since_key = 0
+                self.want_key = False
+        elif self.codec == 'lz':
+            #LZ keyframes only refer back within the frame itself
+            key = (self.ref is None or self.want_key or
+                   (self.keyint and self.since_key >= self.keyint))
+            lossy = frame if key else self.quantise(frame)
+            lz = self.lz.encode(lossy, None if key else self.ref)
+            if len(lz) < FRAME_BYTES:
+                ptype = hostlink.PKT_LZ
+                payload = lz
+                frame = lossy
+                if key:
+                    self.since_key = 0
+                    self.want_key = False
+        elif self.codec == 'huff':
+            #Residual frames are only used when smaller than coded pixels
+            key = (self.ref is None or self.want_key or
+                   (self.keyint and self.since_key >= self.keyint))
+            lossy = frame if key else self.quantise(frame)
+            huff = self.huff.encode(lossy, None if key else self.ref,
+                                    self.want_key, FRAME_BYTES - 1)
+            if huff is not None:
+                tables, payload, intra = huff
+                frame = lossy
+                packets.extend((hostlink.PKT_HUFF_TABLE, t) for t in tables)
+                ptype = hostlink.PKT_HUFF
+                if intra:
+                    self.since_key = 0
+                    self.want_key = False
+        elif self.codec == 'planes':
+            #Every frame starts with its most significant plane, which stands
+            #alone; while the link is behind only that plane is sent
+            planes, frame = self.planes.encode(frame, 1 if self.congested
+                                               else PLANE_COUNT)
+            packets.extend((hostlink.PKT_PLANE, p) for p in planes[:-1])
+            ptype = hostlink.PKT_PLANE
+            payload = planes[-1]
+            self.since_key = 0
+            self.want_key = False
+        elif self.codec in ('1bpp', '2bpp'):
+            #Reduced depth frames stand alone, and lose grey levels
+            payload, frame = self.depth.encode(frame)
+            ptype = hostlink.PKT_DEPTH
+            self.since_key = 0
+            self.want_key = False
+        elif self.codec == 'scaled':
+            #Scaled frames stand alone, and lose detail
+            payload, frame = self.scale.encode(frame)
+            ptype = hostlink.PKT_SCALED
+            self.since_key = 0
+            self.want_key = False
+        elif self.codec == 'field':
+            #Each field replaces half the rows, so two in a row make a whole
+            #frame whatever the device held before
+            payload, frame = self.field.encode(frame, self.ref)
+            ptype = hostlink.PKT_FIELD
+            self.since_key = 0
+            self.want_key = False
+        if ptype == hostlink.PKT_RAW:
+            self.since_key = 0
+            self.want_key = False
+        self.since_key += 1
+        self.ref = frame
+        #A time applies to the packet straight after it
+        if pts is not None:
+            packets.append((hostlink.PKT_TIME,
+                            hostlink.time_payload(pts, self.latency)))
+        packets.append((ptype, payload))
+        #Frames sent before are likely to come round again
+        if self.cache and cached is None and self.frames.repeated(source):
+            ident = self.frames.store(source, frame)
+            if ident is not None:
+                packets.append((hostlink.PKT_CACHE_STORE, bytearray([ident])))
+        if self.rate:
+            self.rate.update(packets, self.quantised)
+        return packets
+
+    def cost(self, trial):
+        """Device cycles to receive and decode a trial encoding.  Frames are
+        decoded while the next one arrives, so the slower of the two counts;
+        ties go to the fewer bytes."""
+        tables, ptype, payload, frame = trial
+        size = sum(hostlink.wire_size(t, p) for t, p in tables)
+        size += hostlink.wire_size(ptype, payload)
+        return (max(size * LINK_CYCLES,
+                    len(payload) * self.decode_cycles[ptype]), size)
+
+    def choose(self, frame):
+        """Trial encode a frame with each lossless codec that shares the
+        reference frame, returning the table packets, packet type, payload
+        and reconstruction of the cheapest"""
+        key = (self.ref is None or self.want_key or
+               (self.keyint and self.since_key >= self.keyint))
+        ref = None if key else self.ref
+        lossy = frame if key else self.quantise(frame)
+        trials = [([], hostlink.PKT_RAW, frame, frame)]
+        if not key:
+            trials.append(([], hostlink.PKT_BLOCK,
+                           self.block.encode(lossy, ref), lossy))
+        trials.append(([], hostlink.PKT_LZ, self.lz.encode(lossy, ref), lossy))
+        #Only tables that go with the chosen frame count as sent, unless
+        #the device asked for them again
+        if self.want_key:
+            self.huff.sent = [False, False]
+        sent = list(self.huff.sent)
+        tables, payload, intra = self.huff.encode(lossy, ref)
+        trials.append(([(hostlink.PKT_HUFF_TABLE, t) for t in tables],
+                       hostlink.PKT_HUFF, payload, lossy))
+        best = min(trials, key=self.cost)
+        if best[1] != hostlink.PKT_HUFF:
+            self.huff.sent = sent
+        #Without a reference every candidate stands alone
+        if key or (best[1] == hostlink.PKT_HUFF and intra):
+            self.since_key = 0
+            self.want_key = False
+        count = self.chosen.setdefault(best[1], [0, 0])
+        count[0] += 1
+        count[1] += self.cost(best)[1]
+        return best
+
+    def decoded(self, ptype, length, cycles):
+        """Track the decode cycles the device reported for a frame"""
+        if ptype in self.decode_cycles and length:
+            self.decode_cycles[ptype] += DECODE_WEIGHT * (
+                float(cycles) / length - self.decode_cycles[ptype])
+
+    def choices(self):
+        """Summary of the packet types the auto codec chose"""
+        frames = sum(n for n, size in self.chosen.values())
+        return ', '.join('%s %.0f%% (%.0f bytes)' %
+                         (hostlink.PKT_NAMES[ptype], 100.0 * n / frames,
+                          float(size) / n)
+                         for ptype, (n, size) in sorted(self.chosen.items()))
+
+    def quantise(self, frame):
+        """The frame with the changes from the reference that the rate
+        controller chose to ignore undone"""
+        if not self.rate:
+            return frame
+        self.quantised = True
+        return self.rate.quantise(frame, self.ref)
+
+    def packet(self, frame, pts=None):
+        """Encode one packed frame, returning the bytes to write to the port"""
+        data = bytearray()
+        for ptype, payload in self.encode(frame, pts):
+            data += hostlink.packet(ptype, payload)
+        return data
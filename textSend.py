@@ -0,0 +1,67 @@
+#Send text to the console on the LM3S6965 OLED display, for status displays
+#and logs: each line read is written to the console, which scrolls
+import sys, time, argparse
+import serial
+import hostlink, textcon
+
+#Set serial baud rate
+baud = 1500000
+comPort = 'COM9'
+
+parser = argparse.ArgumentParser(description='Show text on the LM3S6965 OLED display')
+parser.add_argument('filename', nargs='?',
+                    help='file to show, read as it grows (default standard input)')
+parser.add_argument('--port', default=comPort, help='serial port of the board')
+parser.add_argument('--dump', metavar='FILE',
+                    help='write the packets to FILE for bench/decbench rather '
+                    'than send them')
+args = parser.parse_args()
+
+source = open(args.filename) if args.filename else sys.stdin
+console = textcon.TextConsole()
+
+def lines():
+    """A text packet for each line of the source that changes the console"""
+    for line in source:
+        console.write(line)
+        payload = console.packet()
+        if payload:
+            yield hostlink.PKT_TEXT, payload
+
+
+if args.dump:
+    hostlink.write_records(args.dump, lines())
+    sys.exit(0)
+
+ser = None
+sent = 0
+try:
+    ser = serial.Serial(args.port, baud)
+    reader = hostlink.ReportReader(ser, console)
+    reader.start()
+    while 1:
+        line = source.readline()
+        if line:
+            console.write(line)
+        elif not args.filename:
+            break
+        else:
+            #Wait for the file to grow, resending the console if the board
+            #asked for it meanwhile
+            time.sleep(0.05)
+        payload = console.packet()
+        if payload:
+            data = hostlink.packet(hostlink.PKT_TEXT, payload)
+            sent += len(data)
+            ser.write(data)
+except KeyboardInterrupt:
+    pass
+except serial.SerialException:
+    sys.exit('Error: Serial Error. Please check that the board is connected')
+
+#Let the last reports arrive, then close the serial connection
+time.sleep(0.2)
+ser.close()
+if reader.stats.types:
+    print(reader.stats.summary())
+print('Sent %d bytes' % sent)
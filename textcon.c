@@ -0,0 +1,482 @@
+//*****************************************************************************
+//
+// textcon.c - Text console rendered from a font in flash.
+//
+// Status displays are mostly text, so rather than frames the host can send
+// the characters and cursor movements that change them.  The board keeps the
+// console's characters and levels and renders them into the frame, so a
+// status update is the few characters that changed.
+//
+// A text packet is
+//
+//   byte 0        flags (TEXT_FLAG_*)
+//   rest          characters and control characters (TEXT_CTL_*)
+//
+// Only the character cells whose character or levels changed are rendered,
+// and only the frame cells they cover are marked for redrawing.  Glyphs are
+// expanded from the 1-bit font in flash to the frame layout on first use in
+// a pair of levels and kept in a small glyph cache, so rendering a cell is
+// normally eight copies of three bytes.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <string.h>
+#include "video.h"
+#include "textcon.h"
+
+//*****************************************************************************
+//
+// The first and last characters in the font.
+//
+//*****************************************************************************
+#define TEXT_FIRST              0x20
+#define TEXT_LAST               0x7E
+
+//*****************************************************************************
+//
+// Bytes of a glyph in the frame layout: three bytes for each of eight rows.
+//
+//*****************************************************************************
+#define TEXT_GLYPH_STRIDE       (TEXT_CELL_WIDTH / 2)
+#define TEXT_GLYPH_BYTES        (TEXT_GLYPH_STRIDE * TEXT_CELL_HEIGHT)
+
+//*****************************************************************************
+//
+// The number of glyphs cached, a power of two.  A glyph goes in the slot
+// given by the low bits of its character, so text in one pair of levels
+// misses only when two characters that differ by a multiple of this are both
+// in use.
+//
+//*****************************************************************************
+#define TEXT_CACHE_SLOTS        64
+
+//*****************************************************************************
+//
+// The levels of text on a new console: white on black.
+//
+//*****************************************************************************
+#define TEXT_LEVEL_DEFAULT      0xF0
+
+//*****************************************************************************
+//
+// The 5x7 font, five columns per character with the top row in bit 0.
+//
+//*****************************************************************************
+static const unsigned char g_pucTextFont[TEXT_LAST - TEXT_FIRST + 1][5] =
+{
+    { 0x00, 0x00, 0x00, 0x00, 0x00 },   // ' '
+    { 0x00, 0x00, 0x5F, 0x00, 0x00 },   // '!'
+    { 0x00, 0x07, 0x00, 0x07, 0x00 },   // '"'
+    { 0x14, 0x7F, 0x14, 0x7F, 0x14 },   // '#'
+    { 0x24, 0x2A, 0x7F, 0x2A, 0x12 },   // '$'
+    { 0x23, 0x13, 0x08, 0x64, 0x62 },   // '%'
+    { 0x36, 0x49, 0x55, 0x22, 0x50 },   // '&'
+    { 0x00, 0x05, 0x03, 0x00, 0x00 },   // quote
+    { 0x00, 0x1C, 0x22, 0x41, 0x00 },   // '('
+    { 0x00, 0x41, 0x22, 0x1C, 0x00 },   // ')'
+    { 0x14, 0x08, 0x3E, 0x08, 0x14 },   // '*'
+    { 0x08, 0x08, 0x3E, 0x08, 0x08 },   // '+'
+    { 0x00, 0x50, 0x30, 0x00, 0x00 },   // ','
+    { 0x08, 0x08, 0x08, 0x08, 0x08 },   // '-'
+    { 0x00, 0x60, 0x60, 0x00, 0x00 },   // '.'
+    { 0x20, 0x10, 0x08, 0x04, 0x02 },   // '/'
+    { 0x3E, 0x51, 0x49, 0x45, 0x3E },   // '0'
+    { 0x00, 0x42, 0x7F, 0x40, 0x00 },   // '1'
+    { 0x42, 0x61, 0x51, 0x49, 0x46 },   // '2'
+    { 0x21, 0x41, 0x45, 0x4B, 0x31 },   // '3'
+    { 0x18, 0x14, 0x12, 0x7F, 0x10 },   // '4'
+    { 0x27, 0x45, 0x45, 0x45, 0x39 },   // '5'
+    { 0x3C, 0x4A, 0x49, 0x49, 0x30 },   // '6'
+    { 0x01, 0x71, 0x09, 0x05, 0x03 },   // '7'
+    { 0x36, 0x49, 0x49, 0x49, 0x36 },   // '8'
+    { 0x06, 0x49, 0x49, 0x29, 0x1E },   // '9'
+    { 0x00, 0x36, 0x36, 0x00, 0x00 },   // ':'
+    { 0x00, 0x56, 0x36, 0x00, 0x00 },   // ';'
+    { 0x08, 0x14, 0x22, 0x41, 0x00 },   // '<'
+    { 0x14, 0x14, 0x14, 0x14, 0x14 },   // '='
+    { 0x00, 0x41, 0x22, 0x14, 0x08 },   // '>'
+    { 0x02, 0x01, 0x51, 0x09, 0x06 },   // '?'
+    { 0x32, 0x49, 0x79, 0x41, 0x3E },   // '@'
+    { 0x7E, 0x11, 0x11, 0x11, 0x7E },   // 'A'
+    { 0x7F, 0x49, 0x49, 0x49, 0x36 },   // 'B'
+    { 0x3E, 0x41, 0x41, 0x41, 0x22 },   // 'C'
+    { 0x7F, 0x41, 0x41, 0x22, 0x1C },   // 'D'
+    { 0x7F, 0x49, 0x49, 0x49, 0x41 },   // 'E'
+    { 0x7F, 0x09, 0x09, 0x09, 0x01 },   // 'F'
+    { 0x3E, 0x41, 0x49, 0x49, 0x7A },   // 'G'
+    { 0x7F, 0x08, 0x08, 0x08, 0x7F },   // 'H'
+    { 0x00, 0x41, 0x7F, 0x41, 0x00 },   // 'I'
+    { 0x20, 0x40, 0x41, 0x3F, 0x01 },   // 'J'
+    { 0x7F, 0x08, 0x14, 0x22, 0x41 },   // 'K'
+    { 0x7F, 0x40, 0x40, 0x40, 0x40 },   // 'L'
+    { 0x7F, 0x02, 0x0C, 0x02, 0x7F },   // 'M'
+    { 0x7F, 0x04, 0x08, 0x10, 0x7F },   // 'N'
+    { 0x3E, 0x41, 0x41, 0x41, 0x3E },   // 'O'
+    { 0x7F, 0x09, 0x09, 0x09, 0x06 },   // 'P'
+    { 0x3E, 0x41, 0x51, 0x21, 0x5E },   // 'Q'
+    { 0x7F, 0x09, 0x19, 0x29, 0x46 },   // 'R'
+    { 0x46, 0x49, 0x49, 0x49, 0x31 },   // 'S'
+    { 0x01, 0x01, 0x7F, 0x01, 0x01 },   // 'T'
+    { 0x3F, 0x40, 0x40, 0x40, 0x3F },   // 'U'
+    { 0x1F, 0x20, 0x40, 0x20, 0x1F },   // 'V'
+    { 0x3F, 0x40, 0x38, 0x40, 0x3F },   // 'W'
+    { 0x63, 0x14, 0x08, 0x14, 0x63 },   // 'X'
+    { 0x07, 0x08, 0x70, 0x08, 0x07 },   // 'Y'
+    { 0x61, 0x51, 0x49, 0x45, 0x43 },   // 'Z'
+    { 0x00, 0x7F, 0x41, 0x41, 0x00 },   // '['
+    { 0x02, 0x04, 0x08, 0x10, 0x20 },   // backslash
+    { 0x00, 0x41, 0x41, 0x7F, 0x00 },   // ']'
+    { 0x04, 0x02, 0x01, 0x02, 0x04 },   // '^'
+    { 0x40, 0x40, 0x40, 0x40, 0x40 },   // '_'
+    { 0x00, 0x01, 0x02, 0x04, 0x00 },   // '`'
+    { 0x20, 0x54, 0x54, 0x54, 0x78 },   // 'a'
+    { 0x7F, 0x48, 0x44, 0x44, 0x38 },   // 'b'
+    { 0x38, 0x44, 0x44, 0x44, 0x20 },   // 'c'
+    { 0x38, 0x44, 0x44, 0x48, 0x7F },   // 'd'
+    { 0x38, 0x54, 0x54, 0x54, 0x18 },   // 'e'
+    { 0x08, 0x7E, 0x09, 0x01, 0x02 },   // 'f'
+    { 0x0C, 0x52, 0x52, 0x52, 0x3E },   // 'g'
+    { 0x7F, 0x08, 0x04, 0x04, 0x78 },   // 'h'
+    { 0x00, 0x44, 0x7D, 0x40, 0x00 },   // 'i'
+    { 0x20, 0x40, 0x44, 0x3D, 0x00 },   // 'j'
+    { 0x7F, 0x10, 0x28, 0x44, 0x00 },   // 'k'
+    { 0x00, 0x41, 0x7F, 0x40, 0x00 },   // 'l'
+    { 0x7C, 0x04, 0x18, 0x04, 0x78 },   // 'm'
+    { 0x7C, 0x08, 0x04, 0x04, 0x78 },   // 'n'
+    { 0x38, 0x44, 0x44, 0x44, 0x38 },   // 'o'
+    { 0x7C, 0x14, 0x14, 0x14, 0x08 },   // 'p'
+    { 0x08, 0x14, 0x14, 0x18, 0x7C },   // 'q'
+    { 0x7C, 0x08, 0x04, 0x04, 0x08 },   // 'r'
+    { 0x48, 0x54, 0x54, 0x54, 0x20 },   // 's'
+    { 0x04, 0x3F, 0x44, 0x40, 0x20 },   // 't'
+    { 0x3C, 0x40, 0x40, 0x20, 0x7C },   // 'u'
+    { 0x1C, 0x20, 0x40, 0x20, 0x1C },   // 'v'
+    { 0x3C, 0x40, 0x30, 0x40, 0x3C },   // 'w'
+    { 0x44, 0x28, 0x10, 0x28, 0x44 },   // 'x'
+    { 0x0C, 0x50, 0x50, 0x50, 0x3C },   // 'y'
+    { 0x44, 0x64, 0x54, 0x4C, 0x44 },   // 'z'
+    { 0x00, 0x08, 0x36, 0x41, 0x00 },   // '{'
+    { 0x00, 0x00, 0x7F, 0x00, 0x00 },   // '|'
+    { 0x00, 0x41, 0x36, 0x08, 0x00 },   // '}'
+    { 0x08, 0x04, 0x08, 0x10, 0x08 }    // '~'
+};
+
+//*****************************************************************************
+//
+// The console: the character and levels (foreground in the high nibble) of
+// each cell, a mask per row of the cells to render, the cursor and the levels
+// for new characters.
+//
+//*****************************************************************************
+static unsigned char g_ppucTextChar[TEXT_ROWS][TEXT_COLUMNS];
+static unsigned char g_ppucTextLevel[TEXT_ROWS][TEXT_COLUMNS];
+static unsigned long g_pulTextDirty[TEXT_ROWS];
+static unsigned long g_ulTextColumn;
+static unsigned long g_ulTextRow;
+static unsigned char g_ucTextLevel;
+
+//*****************************************************************************
+//
+// The glyph cache.  An empty slot holds character 0, which is never drawn.
+//
+//*****************************************************************************
+static unsigned char g_ppucTextGlyph[TEXT_CACHE_SLOTS][TEXT_GLYPH_BYTES];
+static unsigned char g_pucTextGlyphChar[TEXT_CACHE_SLOTS];
+static unsigned char g_pucTextGlyphLevel[TEXT_CACHE_SLOTS];
+
+//*****************************************************************************
+//
+// Sets a cell, marking it for rendering if it changes.
+//
+//*****************************************************************************
+static void
+TextPut(unsigned long ulRow, unsigned long ulColumn, unsigned char ucChar,
+        unsigned char ucLevel)
+{
+    if((g_ppucTextChar[ulRow][ulColumn] != ucChar) ||
+       (g_ppucTextLevel[ulRow][ulColumn] != ucLevel))
+    {
+        g_ppucTextChar[ulRow][ulColumn] = ucChar;
+        g_ppucTextLevel[ulRow][ulColumn] = ucLevel;
+        g_pulTextDirty[ulRow] |= 1 << ulColumn;
+    }
+}
+
+//*****************************************************************************
+//
+// Blanks a line from a column to its end.
+//
+//*****************************************************************************
+static void
+TextErase(unsigned long ulRow, unsigned long ulColumn)
+{
+    for(; ulColumn < TEXT_COLUMNS; ulColumn++)
+    {
+        TextPut(ulRow, ulColumn, ' ', g_ucTextLevel);
+    }
+}
+
+//*****************************************************************************
+//
+// Moves the cursor to the start of the next line, scrolling the console up a
+// line if it is on the last.
+//
+//*****************************************************************************
+static void
+TextNewline(void)
+{
+    unsigned long ulRow, ulColumn;
+
+    g_ulTextColumn = 0;
+    if(g_ulTextRow < (TEXT_ROWS - 1))
+    {
+        g_ulTextRow++;
+        return;
+    }
+
+    for(ulRow = 0; ulRow < (TEXT_ROWS - 1); ulRow++)
+    {
+        for(ulColumn = 0; ulColumn < TEXT_COLUMNS; ulColumn++)
+        {
+            TextPut(ulRow, ulColumn, g_ppucTextChar[ulRow + 1][ulColumn],
+                    g_ppucTextLevel[ulRow + 1][ulColumn]);
+        }
+    }
+    TextErase(TEXT_ROWS - 1, 0);
+}
+
+//*****************************************************************************
+//
+// Returns a character's glyph in a pair of levels, expanding it from the
+// font into the glyph cache if it is not there.
+//
+//*****************************************************************************
+static const unsigned char *
+TextGlyph(unsigned char ucChar, unsigned char ucLevel)
+{
+    const unsigned char *pucFont;
+    unsigned char *pucGlyph;
+    unsigned long ulSlot, ulRow, ulColumn, ulPixel;
+
+    ulSlot = ucChar & (TEXT_CACHE_SLOTS - 1);
+    pucGlyph = g_ppucTextGlyph[ulSlot];
+    if((g_pucTextGlyphChar[ulSlot] == ucChar) &&
+       (g_pucTextGlyphLevel[ulSlot] == ucLevel))
+    {
+        return(pucGlyph);
+    }
+
+    //
+    // The sixth column and eighth row are spacing.
+    //
+    pucFont = g_pucTextFont[ucChar - TEXT_FIRST];
+    for(ulRow = 0; ulRow < TEXT_CELL_HEIGHT; ulRow++)
+    {
+        for(ulColumn = 0; ulColumn < TEXT_CELL_WIDTH; ulColumn++)
+        {
+            ulPixel = ((ulColumn < 5) && ((pucFont[ulColumn] >> ulRow) & 1)) ?
+                      (ucLevel >> 4) : (ucLevel & 0xF);
+            if(ulColumn & 1)
+            {
+                pucGlyph[ulColumn / 2] |= ulPixel;
+            }
+            else
+            {
+                pucGlyph[ulColumn / 2] = ulPixel << 4;
+            }
+        }
+        pucGlyph += TEXT_GLYPH_STRIDE;
+    }
+    g_pucTextGlyphChar[ulSlot] = ucChar;
+    g_pucTextGlyphLevel[ulSlot] = ucLevel;
+
+    return(g_ppucTextGlyph[ulSlot]);
+}
+
+//*****************************************************************************
+//
+// Renders the cells marked for rendering into the frame and marks the frame
+// cells they cover as dirty.
+//
+//*****************************************************************************
+static void
+TextRender(unsigned char *pucFrame, unsigned short *pusDirty)
+{
+    const unsigned char *pucGlyph;
+    unsigned char *pucCell;
+    unsigned long ulRow, ulColumn, ulLine, ulX;
+
+    for(ulRow = 0; ulRow < TEXT_ROWS; ulRow++)
+    {
+        if(!g_pulTextDirty[ulRow])
+        {
+            continue;
+        }
+        for(ulColumn = 0; ulColumn < TEXT_COLUMNS; ulColumn++)
+        {
+            if(!(g_pulTextDirty[ulRow] & (1 << ulColumn)))
+            {
+                continue;
+            }
+            pucGlyph = TextGlyph(g_ppucTextChar[ulRow][ulColumn],
+                                 g_ppucTextLevel[ulRow][ulColumn]);
+            ulX = ulColumn * TEXT_CELL_WIDTH;
+            pucCell = (pucFrame + (ulRow * TEXT_CELL_HEIGHT * FRAME_STRIDE) +
+                       (ulX / 2));
+            for(ulLine = 0; ulLine < TEXT_CELL_HEIGHT; ulLine++)
+            {
+                memcpy(pucCell, pucGlyph, TEXT_GLYPH_STRIDE);
+                pucCell += FRAME_STRIDE;
+                pucGlyph += TEXT_GLYPH_STRIDE;
+            }
+
+            //
+            // Text rows line up with the bands of frame cells.
+            //
+            pusDirty[ulRow] |= ((1 << (ulX / VIDEO_CELL_SIZE)) |
+                                (1 << ((ulX + TEXT_CELL_WIDTH - 1) /
+                                       VIDEO_CELL_SIZE)));
+        }
+        g_pulTextDirty[ulRow] = 0;
+    }
+}
+
+//*****************************************************************************
+//
+//! Applies a text packet to the console and renders the result.
+//!
+//! \param pucData is a pointer to the text packet.
+//! \param ulLength is the number of bytes in the packet.
+//! \param pucFrame is the frame to render into; unless the packet has
+//! \b TEXT_FLAG_RESET set it must already hold the previous frame.
+//! \param pusDirty is an array of \b VIDEO_BANDS masks; the bit for every
+//! cell rendered is set.
+//!
+//! A packet with \b TEXT_FLAG_RESET set starts from a blank console in the
+//! default levels with the cursor at the top left, and fills the frame.
+//! Otherwise it continues from the console left by the packets before it.
+//!
+//! \return Returns 0 on success or -1 if the packet is malformed, in which
+//! case the console may be partly updated.
+//
+//*****************************************************************************
+long
+TextDecode(const unsigned char *pucData, unsigned long ulLength,
+           unsigned char *pucFrame, unsigned short *pusDirty)
+{
+    unsigned long ulChar;
+
+    if(ulLength == 0)
+    {
+        return(-1);
+    }
+    if(pucData[0] & TEXT_FLAG_RESET)
+    {
+        //
+        // Marking every cell with a character that is never drawn renders
+        // them all.
+        //
+        memset(g_ppucTextChar, 0, sizeof(g_ppucTextChar));
+        memset(pucFrame, 0, FRAME_BYTES);
+        memset(pusDirty, 0xFF, VIDEO_BANDS * sizeof(pusDirty[0]));
+        g_ucTextLevel = TEXT_LEVEL_DEFAULT;
+        for(g_ulTextRow = 0; g_ulTextRow < TEXT_ROWS; g_ulTextRow++)
+        {
+            TextErase(g_ulTextRow, 0);
+        }
+        g_ulTextRow = 0;
+        g_ulTextColumn = 0;
+    }
+
+    for(ulLength--, pucData++; ulLength; ulLength--, pucData++)
+    {
+        ulChar = pucData[0];
+        if((ulChar >= TEXT_FIRST) && (ulChar <= TEXT_LAST))
+        {
+            if(g_ulTextColumn == TEXT_COLUMNS)
+            {
+                TextNewline();
+            }
+            TextPut(g_ulTextRow, g_ulTextColumn, ulChar, g_ucTextLevel);
+            g_ulTextColumn++;
+            continue;
+        }
+
+        switch(ulChar)
+        {
+            case TEXT_CTL_BACKSPACE:
+            {
+                if(g_ulTextColumn)
+                {
+                    g_ulTextColumn--;
+                }
+                break;
+            }
+
+            case TEXT_CTL_NEWLINE:
+            {
+                TextNewline();
+                break;
+            }
+
+            case TEXT_CTL_CLEAR:
+            {
+                for(g_ulTextRow = 0; g_ulTextRow < TEXT_ROWS; g_ulTextRow++)
+                {
+                    TextErase(g_ulTextRow, 0);
+                }
+                g_ulTextRow = 0;
+                g_ulTextColumn = 0;
+                break;
+            }
+
+            case TEXT_CTL_RETURN:
+            {
+                g_ulTextColumn = 0;
+                break;
+            }
+
+            case TEXT_CTL_MOVE:
+            {
+                if((ulLength < 3) || (pucData[1] >= TEXT_COLUMNS) ||
+                   (pucData[2] >= TEXT_ROWS))
+                {
+                    return(-1);
+                }
+                g_ulTextColumn = pucData[1];
+                g_ulTextRow = pucData[2];
+                ulLength -= 2;
+                pucData += 2;
+                break;
+            }
+
+            case TEXT_CTL_LEVEL:
+            {
+                if((ulLength < 3) || (pucData[1] > 15) || (pucData[2] > 15))
+                {
+                    return(-1);
+                }
+                g_ucTextLevel = (pucData[1] << 4) | pucData[2];
+                ulLength -= 2;
+                pucData += 2;
+                break;
+            }
+
+            case TEXT_CTL_ERASE:
+            {
+                TextErase(g_ulTextRow, g_ulTextColumn);
+                break;
+            }
+
+            default:
+            {
+                return(-1);
+            }
+        }
+    }
+
+    TextRender(pucFrame, pusDirty);
+
+    return(0);
+}
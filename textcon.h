@@ -0,0 +1,53 @@
+//*****************************************************************************
+//
+// textcon.h - Text console rendered from a font in flash.
+//
+//*****************************************************************************
+
+#ifndef __TEXTCON_H__
+#define __TEXTCON_H__
+
+//*****************************************************************************
+//
+// Console geometry.  Characters are 6x8 pixel cells, a 5x7 glyph with a
+// column and a row of spacing; the two columns of pixels right of the last
+// character cell are left blank.
+//
+//*****************************************************************************
+#define TEXT_CELL_WIDTH         6
+#define TEXT_CELL_HEIGHT        8
+#define TEXT_COLUMNS            21
+#define TEXT_ROWS               12
+
+//*****************************************************************************
+//
+// Flags carried in the first byte of a text packet.
+//
+//*****************************************************************************
+#define TEXT_FLAG_RESET         0x01        // Start from a blank console
+
+//*****************************************************************************
+//
+// Characters of a text packet.  Printable ASCII characters are written at the
+// cursor, which moves right and wraps to the next line before a character
+// that does not fit; the console scrolls up when the cursor moves past the
+// last line.  Control characters take the arguments listed, one byte each.
+//
+//*****************************************************************************
+#define TEXT_CTL_BACKSPACE      0x08        // Cursor left one column
+#define TEXT_CTL_NEWLINE        0x0A        // Cursor to the next line start
+#define TEXT_CTL_CLEAR          0x0C        // Blank the console, cursor home
+#define TEXT_CTL_RETURN         0x0D        // Cursor to the line start
+#define TEXT_CTL_MOVE           0x10        // column, row
+#define TEXT_CTL_LEVEL          0x11        // foreground, background level
+#define TEXT_CTL_ERASE          0x12        // Blank to the end of the line
+
+//*****************************************************************************
+//
+// Prototypes for the text console APIs.
+//
+//*****************************************************************************
+extern long TextDecode(const unsigned char *pucData, unsigned long ulLength,
+                       unsigned char *pucFrame, unsigned short *pusDirty);
+
+#endif // __TEXTCON_H__
@@ -0,0 +1,135 @@
+#Text packets: characters and cursor movements for the console the device
+#renders, matching textcon.h on the device
+
+#Console geometry in characters
+COLUMNS = 21
+ROWS = 12
+
+#Flags in the first byte of a text packet
+FLAG_RESET = 0x01
+
+#Control characters
+CTL_BACKSPACE = 0x08
+CTL_NEWLINE = 0x0A
+CTL_CLEAR = 0x0C
+CTL_RETURN = 0x0D
+CTL_MOVE = 0x10
+CTL_LEVEL = 0x11
+CTL_ERASE = 0x12
+
+#Levels of a new console, foreground in the high nibble
+LEVEL_DEFAULT = 0xF0
+
+
+class TextConsole(object):
+    """Keeps a copy of the device's console and collects the text packet
+    that changes it.  After request_keyframe() the next packet starts a new
+    console and redraws the copy in full, which the device accepts whatever
+    it lost."""
+
+    def __init__(self):
+        self.chars = [[' '] * COLUMNS for row in range(ROWS)]
+        self.levels = [[LEVEL_DEFAULT] * COLUMNS for row in range(ROWS)]
+        self.column = 0
+        self.row = 0
+        self.colour = LEVEL_DEFAULT
+        self.pending = bytearray()
+        self.reset = True
+
+    def request_keyframe(self):
+        self.reset = True
+
+    def decoded(self, ptype, length, cycles):
+        pass
+
+    def _newline(self):
+        self.column = 0
+        if self.row < ROWS - 1:
+            self.row += 1
+            return
+        self.chars = self.chars[1:] + [[' '] * COLUMNS]
+        self.levels = self.levels[1:] + [[self.colour] * COLUMNS]
+
+    def _erase(self, row, column):
+        for c in range(column, COLUMNS):
+            self.chars[row][c] = ' '
+            self.levels[row][c] = self.colour
+
+    def write(self, text):
+        """Write text at the cursor; newline, carriage return and backspace
+        move the cursor, tabs become spaces and other characters are
+        dropped"""
+        for c in text.expandtabs(4):
+            if ' ' <= c <= '~':
+                if self.column == COLUMNS:
+                    self._newline()
+                self.chars[self.row][self.column] = c
+                self.levels[self.row][self.column] = self.colour
+                self.column += 1
+            elif c == '\n':
+                self._newline()
+            elif c == '\r':
+                self.column = 0
+            elif c == '\b':
+                self.column = max(self.column - 1, 0)
+            else:
+                continue
+            self.pending.append(ord(c))
+
+    def move(self, column, row):
+        self.column = column
+        self.row = row
+        self.pending += bytearray([CTL_MOVE, column, row])
+
+    def level(self, foreground, background):
+        self.colour = foreground << 4 | background
+        self.pending += bytearray([CTL_LEVEL, foreground, background])
+
+    def erase(self):
+        """Blank from the cursor to the end of the line"""
+        self._erase(self.row, min(self.column, COLUMNS))
+        self.pending.append(CTL_ERASE)
+
+    def clear(self):
+        for row in range(ROWS):
+            self._erase(row, 0)
+        self.column = 0
+        self.row = 0
+        self.pending.append(CTL_CLEAR)
+
+    def _redraw(self):
+        """Commands that build the copy from a new console"""
+        data = bytearray()
+        colour = LEVEL_DEFAULT
+        for row in range(ROWS):
+            data += bytearray([CTL_MOVE, 0, row])
+            for column in range(COLUMNS):
+                if self.levels[row][column] != colour:
+                    colour = self.levels[row][column]
+                    data += bytearray([CTL_LEVEL, colour >> 4, colour & 0xF])
+                data.append(ord(self.chars[row][column]))
+        #A cursor past the last column is left by writing the last character
+        #again
+        if self.column == COLUMNS:
+            colour = self.levels[self.row][COLUMNS - 1]
+            data += bytearray([CTL_MOVE, COLUMNS - 1, self.row,
+                               CTL_LEVEL, colour >> 4, colour & 0xF,
+                               ord(self.chars[self.row][COLUMNS - 1])])
+        else:
+            data += bytearray([CTL_MOVE, self.column, self.row])
+        if self.colour != colour:
+            data += bytearray([CTL_LEVEL, self.colour >> 4, self.colour & 0xF])
+        return data
+
+    def packet(self):
+        """Return the payload of the text packet for the changes since the
+        last one, or None if there are none"""
+        if self.reset:
+            payload = bytearray([FLAG_RESET]) + self._redraw()
+            self.reset = False
+        elif self.pending:
+            payload = bytearray([0]) + self.pending
+        else:
+            return None
+        self.pending = bytearray()
+        return payload
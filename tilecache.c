@@ -0,0 +1,114 @@
+//*****************************************************************************
+//
+// tilecache.c - Decoder for frames built from a cache of 8x8 tiles.
+//
+// The device keeps TILE_CACHE_SIZE tiles in SRAM.  Which tile lives in which
+// slot is decided entirely by the host, which keeps a mirror of the cache and
+// replaces the least recently used tiles.  A tile frame is laid out as
+//
+//   byte 0        flags (TILE_FLAG_*)
+//   byte 1        number of tiles uploaded with this frame
+//   33 bytes each slot index followed by the 32 bytes of the tile
+//   192 bytes     slot index of every tile in the frame, in raster order
+//
+// Text and dashboard content repeats the same glyphs and widgets over and
+// over, so once the cache is warm a frame is little more than its 192 byte
+// tile map.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <string.h>
+#include "video.h"
+#include "tilecache.h"
+
+//*****************************************************************************
+//
+// The tile cache.
+//
+//*****************************************************************************
+static uint32_t g_ppulTileCache[TILE_CACHE_SIZE][TILE_BYTES / 4];
+
+//*****************************************************************************
+//
+// The tile map of the previous tile frame, used to find the cells that
+// changed.
+//
+//*****************************************************************************
+static unsigned char g_pucTileMap[TILE_MAP_BYTES];
+
+//*****************************************************************************
+//
+//! Decodes a tile frame.
+//!
+//! \param pucData is a pointer to the encoded frame.
+//! \param ulLength is the number of bytes of encoded data.
+//! \param pucFrame is the frame slot to decode into; it must be word aligned.
+//! \param pusDirty is an array of \b VIDEO_BANDS masks; the bit for every
+//! cell whose tile differs from the previous tile frame is set.
+//!
+//! Uploaded tiles are stored in the cache before the map is drawn, so a frame
+//! may use the tiles it carries.  Every cell of \e pucFrame is written.
+//!
+//! \return Returns 0 on success or -1 if the encoded data is malformed.
+//
+//*****************************************************************************
+long
+TileDecode(const unsigned char *pucData, unsigned long ulLength,
+           unsigned char *pucFrame, unsigned short *pusDirty)
+{
+    uint32_t pulLoaded[TILE_CACHE_SIZE / 32];
+    const uint32_t *pulTile;
+    uint32_t *pulDst;
+    unsigned long ulCount, ulCell, ulSlot, ulRow;
+
+    if(ulLength < 2)
+    {
+        return(-1);
+    }
+    ulCount = pucData[1];
+    if(ulLength != (2 + (ulCount * (1 + TILE_BYTES)) + TILE_MAP_BYTES))
+    {
+        return(-1);
+    }
+    pucData += 2;
+
+    //
+    // Store the uploaded tiles, remembering which slots were refreshed.
+    //
+    memset(pulLoaded, 0, sizeof(pulLoaded));
+    while(ulCount--)
+    {
+        ulSlot = *pucData++;
+        memcpy(g_ppulTileCache[ulSlot], pucData, TILE_BYTES);
+        pulLoaded[ulSlot / 32] |= (uint32_t)1 << (ulSlot % 32);
+        pucData += TILE_BYTES;
+    }
+
+    //
+    // Write every tile of the map into the frame.
+    //
+    for(ulCell = 0; ulCell < TILE_MAP_BYTES; ulCell++)
+    {
+        ulSlot = pucData[ulCell];
+        pulTile = g_ppulTileCache[ulSlot];
+        pulDst = (uint32_t *)(pucFrame +
+                              ((ulCell / TILE_COLS) * TILE_SIZE *
+                               FRAME_STRIDE) +
+                              ((ulCell % TILE_COLS) * TILE_ROW_BYTES));
+        for(ulRow = 0; ulRow < TILE_SIZE; ulRow++)
+        {
+            *pulDst = *pulTile++;
+            pulDst += FRAME_STRIDE / 4;
+        }
+
+        if((ulSlot != g_pucTileMap[ulCell]) ||
+           (pulLoaded[ulSlot / 32] & ((uint32_t)1 << (ulSlot % 32))))
+        {
+            pusDirty[ulCell / TILE_COLS] |= 1 << (ulCell % TILE_COLS);
+            g_pucTileMap[ulCell] = ulSlot;
+        }
+    }
+
+    return(0);
+}
@@ -0,0 +1,39 @@
+//*****************************************************************************
+//
+// tilecache.h - Decoder for frames built from a cache of 8x8 tiles.
+//
+//*****************************************************************************
+
+#ifndef __TILECACHE_H__
+#define __TILECACHE_H__
+
+//*****************************************************************************
+//
+// Tile geometry and cache size.  A tile is 8x8 pixels stored as eight rows
+// of four bytes, and the frame is a 16x12 grid of tiles.
+//
+//*****************************************************************************
+#define TILE_SIZE               8
+#define TILE_ROW_BYTES          (TILE_SIZE / 2)
+#define TILE_BYTES              (TILE_SIZE * TILE_ROW_BYTES)
+#define TILE_COLS               16
+#define TILE_ROWS               12
+#define TILE_MAP_BYTES          (TILE_COLS * TILE_ROWS)
+#define TILE_CACHE_SIZE         256
+
+//*****************************************************************************
+//
+// Flags carried in the first byte of a tile frame.
+//
+//*****************************************************************************
+#define TILE_FLAG_RESET         0x01        // Every tile used is uploaded
+
+//*****************************************************************************
+//
+// Prototypes for the tile cache APIs.
+//
+//*****************************************************************************
+extern long TileDecode(const unsigned char *pucData, unsigned long ulLength,
+                       unsigned char *pucFrame, unsigned short *pusDirty);
+
+#endif // __TILECACHE_H__
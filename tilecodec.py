@@ -0,0 +1,74 @@
+#Encoder for tile frames decoded by tilecache.c on the device.  The host
+#decides which tile lives in which cache slot and keeps a mirror of the cache.
+from collections import OrderedDict
+from hostframe import STRIDE
+
+#Tile geometry and cache size, matching tilecache.h
+TILE_SIZE = 8
+ROW_BYTES = TILE_SIZE // 2
+TILE_BYTES = TILE_SIZE * ROW_BYTES
+COLS = 16
+ROWS = 12
+MAP_BYTES = COLS * ROWS
+CACHE_SIZE = 256
+
+#Tile frame flags
+FLAG_RESET = 0x01
+
+
+def tiles(frame):
+    """Split a packed frame into its 192 tiles in raster order"""
+    result = []
+    for row in range(ROWS):
+        for col in range(COLS):
+            offset = row * TILE_SIZE * STRIDE + col * ROW_BYTES
+            result.append(b''.join(bytes(frame[o:o + ROW_BYTES])
+                                   for o in range(offset,
+                                                  offset + TILE_SIZE * STRIDE,
+                                                  STRIDE)))
+    return result
+
+
+class TileEncoder(object):
+    """Mirror of the device tile cache with least recently used replacement"""
+
+    def __init__(self):
+        #Tile contents to cache slot, least recently used first
+        self.slots = OrderedDict()
+
+    def encode(self, frame, reset=False, limit=None):
+        """Encode a tile frame, uploading any tiles the cache lacks.  With reset
+        the cache is assumed empty and every tile used is uploaded.  Returns
+        None, leaving the mirror untouched, if the frame would be longer than
+        limit."""
+        slots = OrderedDict() if reset else OrderedDict(self.slots)
+        free = sorted(set(range(CACHE_SIZE)) - set(slots.values()), reverse=True)
+        used = set()
+        uploads = bytearray()
+        count = 0
+        tile_map = bytearray()
+        for tile in tiles(frame):
+            if tile in slots:
+                #Move the tile to the most recently used end
+                slot = slots.pop(tile)
+            else:
+                if free:
+                    slot = free.pop()
+                else:
+                    #Evict the least recently used tile not in this frame
+                    for old in slots:
+                        if slots[old] not in used:
+                            break
+                    slot = slots.pop(old)
+                uploads.append(slot)
+                uploads += tile
+                count += 1
+            slots[tile] = slot
+            used.add(slot)
+            tile_map.append(slot)
+        payload = (bytearray([FLAG_RESET if reset else 0, count]) + uploads +
+                   tile_map)
+        if limit is not None and len(payload) > limit:
+            return None
+        self.slots = slots
+        return payload
@@ -0,0 +1,1056 @@
+//*****************************************************************************
+//
+// video.c - Frame slots and packet decoding for the video player.
+//
+// Two frame slots are kept.  The front slot holds the frame currently on the
+// display and doubles as the reference frame for inter coded packets; each
+// packet is decoded into the back slot, which then becomes the front slot.
+// Only the 8x8 cells a packet actually changed are redrawn.  A progressive
+// frame arrives as several bit-plane packets, and the host chooses after
+// which of them the frame is drawn.
+//
+// Tile, VQ and Huffman frames depend on the tile cache, codebook and code
+// tables rather than the reference frame, so each is tracked separately; a
+// lost packet invalidates them all.
+//
+// Whole frames can be kept in a frame cache and shown again by id.
+//
+// Window packets update one window of the frame on display, so windows laid
+// out by the host change at their own rates; whole frames are the background
+// they sit on.
+//
+// After every frame the number of cycles spent decoding and drawing it is
+// sent back to the host in a LINK_RPT_FRAME report:
+//
+//   byte 0     packet type
+//   byte 1     status (VIDEO_STATUS_*)
+//   bytes 2-3  payload length
+//   bytes 4-7  decode cycles
+//   bytes 8-11 draw cycles
+//
+// All multi-byte fields are little endian.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <string.h>
+#include "inc/hw_types.h"
+#include "my_rit128x96x4.h"
+#include "cyclecount.h"
+#include "link.h"
+#include "video.h"
+#include "blockcodec.h"
+#include "tilecache.h"
+#include "drawcmd.h"
+#include "textcon.h"
+#include "sprite.h"
+#include "window.h"
+#include "framecache.h"
+#include "boot.h"
+#include "latency.h"
+#include "profile.h"
+#include "vqcodec.h"
+#include "lzcodec.h"
+#include "huffcodec.h"
+#include "planecodec.h"
+#include "depthcodec.h"
+
+//*****************************************************************************
+//
+// The frame slots, and the index of the one currently displayed.
+//
+//*****************************************************************************
+static uint32_t g_ppulFrame[2][FRAME_BYTES / 4];
+static unsigned long g_ulFront;
+
+//*****************************************************************************
+//
+// Set once the front slot matches the host's idea of the reference frame.
+// Any lost packet clears it until the next raw frame arrives.
+//
+//*****************************************************************************
+static tBoolean g_bRefValid;
+static tBoolean g_bTilesValid;
+static tBoolean g_bCodebookValid;
+static tBoolean g_bBitmapsValid;
+static tBoolean g_bConsoleValid;
+static unsigned long g_ulHuffValid;
+static unsigned long g_ulLinkErrors;
+
+//*****************************************************************************
+//
+// The type of the packet that produced the front slot, and for scaled frames
+// the flags giving its size.
+//
+//*****************************************************************************
+static unsigned char g_ucFrontType;
+static unsigned char g_ucScale;
+
+//*****************************************************************************
+//
+// The rows the changed cells of the last decoded frame cover: every row, or
+// for an interlaced field every second row starting with g_ulRowFirst.  For
+// a field in the front slot g_ulRowFirst is also the field it carried.
+//
+//*****************************************************************************
+static unsigned long g_ulRowFirst;
+static unsigned long g_ulRowStep;
+
+//*****************************************************************************
+//
+// The rows the display is scrolled up by before the changed cells of the last
+// decoded frame are drawn.
+//
+//*****************************************************************************
+static unsigned long g_ulScroll;
+
+//*****************************************************************************
+//
+// While the reference frame is not valid, the band of blocks the next refresh
+// frame must refresh for the reference to be rebuilt, or 0 to wait for a
+// refresh cycle to start.
+//
+//*****************************************************************************
+static unsigned long g_ulRefreshNext;
+
+//*****************************************************************************
+//
+// The cells changed by the last decoded frame, and whether that frame still
+// has to be drawn.
+//
+//*****************************************************************************
+static unsigned short g_pusDirty[VIDEO_BANDS];
+static tBoolean g_bPending;
+
+//*****************************************************************************
+//
+// The cells changed by frames that were decoded but, at the host's request,
+// not drawn.  They are drawn with the next frame that is.
+//
+//*****************************************************************************
+static unsigned short g_pusHeld[VIDEO_BANDS];
+
+//*****************************************************************************
+//
+// The bit-plane that may follow the front slot, or PLANE_COUNT if the front
+// slot is not part of a progressive frame.
+//
+//*****************************************************************************
+static unsigned long g_ulPlaneNext;
+
+//*****************************************************************************
+//
+// The report describing the last decoded frame.
+//
+//*****************************************************************************
+static unsigned char g_pucReport[12];
+
+//*****************************************************************************
+//
+// Stores a 32-bit value little endian.
+//
+//*****************************************************************************
+static void
+VideoPut32(unsigned char *pucDst, unsigned long ulValue)
+{
+    pucDst[0] = ulValue;
+    pucDst[1] = ulValue >> 8;
+    pucDst[2] = ulValue >> 16;
+    pucDst[3] = ulValue >> 24;
+}
+
+//*****************************************************************************
+//
+// Marks every cell as changed.
+//
+//*****************************************************************************
+static void
+VideoDirtyAll(void)
+{
+    unsigned long ulBand;
+
+    for(ulBand = 0; ulBand < VIDEO_BANDS; ulBand++)
+    {
+        g_pusDirty[ulBand] = 0xFFFF;
+    }
+}
+
+//*****************************************************************************
+//
+// Marks the cells that differ between two frames as changed, for codecs that
+// do not track which cells they write.
+//
+//*****************************************************************************
+static void
+VideoDirtyDiff(const unsigned char *pucOld, const unsigned char *pucNew)
+{
+    const uint32_t *pulOld, *pulNew;
+    unsigned long ulRow, ulCol;
+
+    pulOld = (const uint32_t *)pucOld;
+    pulNew = (const uint32_t *)pucNew;
+    memset(g_pusDirty, 0, sizeof(g_pusDirty));
+    for(ulRow = 0; ulRow < FRAME_HEIGHT; ulRow++)
+    {
+        //
+        // One word of a row is the width of one cell.
+        //
+        for(ulCol = 0; ulCol < VIDEO_CELL_COLS; ulCol++)
+        {
+            if(*pulOld++ != *pulNew++)
+            {
+                g_pusDirty[ulRow / VIDEO_CELL_SIZE] |= 1 << ulCol;
+            }
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Initializes the frame slots.
+//!
+//! Both slots are cleared to black, matching the panel after
+//! RIT128x96x4Init(), and no reference frame is available until the first raw
+//! frame is received.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+VideoInit(void)
+{
+    memset(g_ppulFrame, 0, sizeof(g_ppulFrame));
+    g_ulFront = 0;
+    g_bRefValid = false;
+    g_bTilesValid = false;
+    g_bCodebookValid = false;
+    g_bBitmapsValid = false;
+    g_bConsoleValid = false;
+    g_ulHuffValid = 0;
+    SpriteForget();
+    WindowForget();
+    FrameCacheForget();
+    g_ucFrontType = LINK_PKT_RAW;
+    g_ulRowFirst = 0;
+    g_ulRowStep = 1;
+    g_ulRefreshNext = 0;
+    g_bPending = false;
+    memset(g_pusHeld, 0, sizeof(g_pusHeld));
+    g_ulPlaneNext = PLANE_COUNT;
+    g_ulLinkErrors = LinkErrorCountGet();
+}
+
+//*****************************************************************************
+//
+//! Decodes a packet received from the host.
+//!
+//! \param ucType is the packet type.
+//! \param pucData is a pointer to the packet payload.
+//! \param ulLength is the number of bytes of payload.
+//!
+//! Frame packets are decoded into the back slot, which becomes the front slot
+//! on success.  The payload is not needed after this function returns, so the
+//! receive buffer can be released before the frame is drawn with
+//! VideoPresent().
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+VideoPacketDecode(unsigned char ucType, const unsigned char *pucData,
+                  unsigned long ulLength)
+{
+    unsigned char *pucFront, *pucBack;
+    unsigned long ulStart, ulStatus, ulBand, ulPlaneNext, ulSize, ulRow;
+    unsigned long ulRowFirst, ulRowStep, ulRefresh, ulCached, ulScroll;
+    tBoolean bDraw, bRef;
+    long lResult;
+
+    ulStart = CycleCountGet();
+
+    //
+    // Inter frames are meaningless if anything was lost since the reference
+    // frame was received.
+    //
+    if(LinkErrorCountGet() != g_ulLinkErrors)
+    {
+        g_ulLinkErrors = LinkErrorCountGet();
+        g_bRefValid = false;
+        g_bTilesValid = false;
+        g_bCodebookValid = false;
+        g_bBitmapsValid = false;
+        g_bConsoleValid = false;
+        g_ulHuffValid = 0;
+        SpriteForget();
+        WindowForget();
+        FrameCacheForget();
+    }
+
+    pucFront = (unsigned char *)g_ppulFrame[g_ulFront];
+    pucBack = (unsigned char *)g_ppulFrame[g_ulFront ^ 1];
+    ulStatus = VIDEO_STATUS_OK;
+    ulPlaneNext = PLANE_COUNT;
+    bDraw = true;
+    bRef = true;
+    ulRowFirst = 0;
+    ulRowStep = 1;
+    ulRefresh = 0;
+    ulScroll = 0;
+
+    switch(ucType)
+    {
+        case LINK_PKT_RAW:
+        {
+            if(ulLength != FRAME_BYTES)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            memcpy(pucBack, pucData, FRAME_BYTES);
+            VideoDirtyAll();
+            break;
+        }
+
+        case LINK_PKT_BLOCK:
+        {
+            if(!g_bRefValid)
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            memset(g_pusDirty, 0, sizeof(g_pusDirty));
+            if(BlockDecode(pucData, ulLength, pucFront, pucBack,
+                           g_pusDirty) != 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+            }
+            break;
+        }
+
+        case LINK_PKT_REFRESH:
+        {
+            //
+            // A block frame whose first byte is a band of blocks that are all
+            // raw or filled.  The host refreshes the bands in order and keeps
+            // the blocks down to the refresh band from copying anything below
+            // it, so these frames are decoded without a reference; once bands
+            // 0 to BLOCK_ROWS - 1 have been refreshed in turn the frame is
+            // whole again.
+            //
+            if((ulLength == 0) || (pucData[0] >= BLOCK_ROWS))
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            memset(g_pusDirty, 0, sizeof(g_pusDirty));
+            if(BlockDecode(pucData + 1, ulLength - 1, pucFront, pucBack,
+                           g_pusDirty) != 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            if(pucData[0] == 0)
+            {
+                ulRefresh = 1;
+            }
+            else if(pucData[0] == g_ulRefreshNext)
+            {
+                ulRefresh = g_ulRefreshNext + 1;
+            }
+            bRef = (g_bRefValid || (ulRefresh == BLOCK_ROWS));
+            break;
+        }
+
+        case LINK_PKT_DRAW:
+        {
+            //
+            // Commands are drawn over the frame on display.  Blits of bitmaps
+            // loaded by earlier packets also need the bitmap cache, which a
+            // packet with DRAW_FLAG_RESET reloads.
+            //
+            if(!g_bRefValid)
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            memcpy(pucBack, pucFront, FRAME_BYTES);
+            memset(g_pusDirty, 0, sizeof(g_pusDirty));
+            if(DrawDecode(pucData, ulLength, pucBack, g_pusDirty,
+                          &ulCached) != 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                g_bBitmapsValid = false;
+                break;
+            }
+            if(ulCached && !g_bBitmapsValid)
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            if(pucData[0] & DRAW_FLAG_RESET)
+            {
+                g_bBitmapsValid = true;
+            }
+            break;
+        }
+
+        case LINK_PKT_TEXT:
+        {
+            //
+            // Text is rendered over the frame on display from the console
+            // the earlier packets built, unless the packet starts a new
+            // console, which fills the frame.
+            //
+            if(!((ulLength != 0) && (pucData[0] & TEXT_FLAG_RESET)) &&
+               !(g_bRefValid && g_bConsoleValid))
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            memcpy(pucBack, pucFront, FRAME_BYTES);
+            memset(g_pusDirty, 0, sizeof(g_pusDirty));
+            if(TextDecode(pucData, ulLength, pucBack, g_pusDirty) != 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                g_bConsoleValid = false;
+                break;
+            }
+            g_bConsoleValid = true;
+            break;
+        }
+
+        case LINK_PKT_SCROLL:
+        {
+            //
+            // The frame moves up and the rows uncovered at the bottom are
+            // sent.  The display is scrolled to match, unless it still has
+            // cells from earlier frames to draw, which are in the wrong
+            // place once it has moved, when it is redrawn instead.
+            //
+            if(!g_bRefValid)
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            if((ulLength == 0) || (pucData[0] == 0) ||
+               (pucData[0] > FRAME_HEIGHT) ||
+               (ulLength != (1UL + (pucData[0] * FRAME_STRIDE))))
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            ulSize = pucData[0] * FRAME_STRIDE;
+            memcpy(pucBack, pucFront + ulSize, FRAME_BYTES - ulSize);
+            memcpy(pucBack + FRAME_BYTES - ulSize, pucData + 1, ulSize);
+            memset(g_pusDirty, 0, sizeof(g_pusDirty));
+            ulScroll = g_bPending ? 0 : pucData[0];
+            for(ulBand = 0; ulBand < VIDEO_BANDS; ulBand++)
+            {
+                if(g_pusHeld[ulBand])
+                {
+                    ulScroll = 0;
+                }
+            }
+            if(!ulScroll)
+            {
+                VideoDirtyAll();
+            }
+            break;
+        }
+
+        case LINK_PKT_SPRITE_IMAGE:
+        {
+            //
+            // Image uploads do not produce a frame.  A bad upload leaves the
+            // image unusable until the host sends it again.
+            //
+            SpriteImageLoad(pucData, ulLength);
+            return;
+        }
+
+        case LINK_PKT_SPRITE:
+        {
+            //
+            // Sprites are redrawn where they changed since the sprite frame
+            // on display, unless the packet makes the frame on display the
+            // background for a new set.
+            //
+            if(!g_bRefValid ||
+               (!((ulLength != 0) && (pucData[0] & SPRITE_FLAG_BACKGROUND)) &&
+                (g_ucFrontType != LINK_PKT_SPRITE)))
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            memcpy(pucBack, pucFront, FRAME_BYTES);
+            memset(g_pusDirty, 0, sizeof(g_pusDirty));
+            lResult = SpriteDecode(pucData, ulLength, pucBack, g_pusDirty);
+            if(lResult < 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+            }
+            else if(lResult > 0)
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+            }
+            break;
+        }
+
+        case LINK_PKT_LAYOUT:
+        {
+            //
+            // Layouts do not produce a frame.  A bad layout leaves no
+            // windows until the host sends it again.
+            //
+            WindowLayout(pucData, ulLength);
+            return;
+        }
+
+        case LINK_PKT_WINDOW:
+        {
+            //
+            // The cells sent replace those of the window in the frame on
+            // display; the rest of the frame is kept.
+            //
+            if(!g_bRefValid)
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            memcpy(pucBack, pucFront, FRAME_BYTES);
+            memset(g_pusDirty, 0, sizeof(g_pusDirty));
+            lResult = WindowDecode(pucData, ulLength, pucBack, g_pusDirty);
+            if(lResult < 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+            }
+            else if(lResult > 0)
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+            }
+            break;
+        }
+
+        case LINK_PKT_CACHE_STORE:
+        {
+            //
+            // Stores do not produce a frame.  Only a whole frame that
+            // matches the host's can be stored.
+            //
+            if((ulLength == 1) && g_bRefValid &&
+               (g_ucFrontType != LINK_PKT_SCALED))
+            {
+                FrameCacheStore(pucData[0], pucFront);
+            }
+            FrameCacheReport();
+            return;
+        }
+
+        case LINK_PKT_CACHE_SHOW:
+        {
+            //
+            // A cached frame stands alone.
+            //
+            if(ulLength != 1)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            lResult = FrameCacheShow(pucData[0], pucBack);
+            FrameCacheReport();
+            if(lResult != 0)
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            VideoDirtyDiff(pucFront, pucBack);
+            break;
+        }
+
+        case LINK_PKT_TILE:
+        {
+            //
+            // Until a reset frame has reloaded every tile it uses, the cache
+            // cannot be trusted.
+            //
+            if(!g_bTilesValid &&
+               ((ulLength == 0) || !(pucData[0] & TILE_FLAG_RESET)))
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            memset(g_pusDirty, 0, sizeof(g_pusDirty));
+            if(TileDecode(pucData, ulLength, pucBack, g_pusDirty) != 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                g_bTilesValid = false;
+                break;
+            }
+            g_bTilesValid = true;
+
+            //
+            // Changes are tracked against the previous tile frame, which is
+            // only on the display if nothing else came in between.
+            //
+            if(g_ucFrontType != LINK_PKT_TILE)
+            {
+                VideoDirtyAll();
+            }
+            break;
+        }
+
+        case LINK_PKT_VQ_CODEBOOK:
+        {
+            //
+            // Codebook uploads do not produce a frame.  Only a complete
+            // codebook makes it usable, and a bad upload leaves it unusable
+            // until the host sends it again.
+            //
+            if(VQCodebookLoad(pucData, ulLength) != 0)
+            {
+                g_bCodebookValid = false;
+            }
+            else if(ulLength == (1 + (VQ_CODEBOOK_SIZE * VQ_ENTRY_BYTES)))
+            {
+                g_bCodebookValid = true;
+            }
+            return;
+        }
+
+        case LINK_PKT_VQ:
+        {
+            if(!g_bCodebookValid)
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            if(VQDecode(pucData, ulLength, pucBack) != 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            VideoDirtyAll();
+            break;
+        }
+
+        case LINK_PKT_LZ:
+        {
+            //
+            // Without a reference frame only frames that do not use it can
+            // be decoded.
+            //
+            if(LZDecode(pucData, ulLength, g_bRefValid ? pucFront : 0,
+                        pucBack) != 0)
+            {
+                ulStatus = (g_bRefValid ? VIDEO_STATUS_ERROR :
+                            VIDEO_STATUS_NO_REF);
+                break;
+            }
+            VideoDirtyDiff(pucFront, pucBack);
+            break;
+        }
+
+        case LINK_PKT_HUFF_TABLE:
+        {
+            //
+            // Table uploads do not produce a frame.  Each table is tracked
+            // as a bit in g_ulHuffValid; a bad upload leaves none usable
+            // until the host sends them again.
+            //
+            if(HuffTableLoad(pucData, ulLength) != 0)
+            {
+                g_ulHuffValid = 0;
+            }
+            else
+            {
+                g_ulHuffValid |= 1 << pucData[0];
+            }
+            return;
+        }
+
+        case LINK_PKT_HUFF:
+        {
+            //
+            // The flags byte selects the table.  Residual frames also need
+            // the reference frame.
+            //
+            if(ulLength == 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            if(!(g_ulHuffValid & (1 << (pucData[0] & HUFF_FLAG_DELTA))) ||
+               ((pucData[0] & HUFF_FLAG_DELTA) && !g_bRefValid))
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            if(HuffDecode(pucData, ulLength, pucFront, pucBack) != 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            VideoDirtyDiff(pucFront, pucBack);
+            break;
+        }
+
+        case LINK_PKT_PLANE:
+        {
+            //
+            // Only the most significant plane stands alone; every other
+            // plane must follow the one above it.
+            //
+            if(ulLength == 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            ulPlaneNext = pucData[0] & PLANE_NUMBER_M;
+            if((ulPlaneNext != (PLANE_COUNT - 1)) &&
+               (!g_bRefValid || (ulPlaneNext != g_ulPlaneNext)))
+            {
+                ulStatus = VIDEO_STATUS_NO_REF;
+                break;
+            }
+            if(PlaneDecode(pucData, ulLength, pucFront, pucBack) != 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            VideoDirtyDiff(pucFront, pucBack);
+            ulPlaneNext = ulPlaneNext ? (ulPlaneNext - 1) : PLANE_COUNT;
+            bDraw = (pucData[0] & PLANE_FLAG_DRAW) ? true : false;
+            break;
+        }
+
+        case LINK_PKT_DEPTH:
+        {
+            if(DepthDecode(pucData, ulLength, pucBack) != 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            VideoDirtyDiff(pucFront, pucBack);
+            break;
+        }
+
+        case LINK_PKT_SCALED:
+        {
+            //
+            // The small frame is kept as it is and only scaled up as it is
+            // drawn, which redraws the whole display.
+            //
+            if(ulLength == 0)
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            ulSize = FRAME_BYTES;
+            if(pucData[0] & VIDEO_SCALE_HALF_X)
+            {
+                ulSize /= 2;
+            }
+            if(pucData[0] & VIDEO_SCALE_HALF_Y)
+            {
+                ulSize /= 2;
+            }
+            if(ulLength != (1 + ulSize))
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            memcpy(pucBack, pucData + 1, ulSize);
+            g_ucScale = pucData[0];
+            VideoDirtyAll();
+            bRef = false;
+            break;
+        }
+
+        case LINK_PKT_FIELD:
+        {
+            //
+            // The rows of the other field are kept from the front slot.  If
+            // that was not a valid reference, the frame becomes whole again
+            // once both fields have arrived.
+            //
+            if((ulLength != (1 + (FRAME_BYTES / 2))) ||
+               (pucData[0] & ~VIDEO_FIELD_ODD))
+            {
+                ulStatus = VIDEO_STATUS_ERROR;
+                break;
+            }
+            ulRowFirst = pucData[0];
+            ulRowStep = 2;
+            pucData++;
+            for(ulRow = 0; ulRow < FRAME_HEIGHT; ulRow++)
+            {
+                if((ulRow & 1) == ulRowFirst)
+                {
+                    memcpy(pucBack + (ulRow * FRAME_STRIDE), pucData,
+                           FRAME_STRIDE);
+                    pucData += FRAME_STRIDE;
+                }
+                else
+                {
+                    memcpy(pucBack + (ulRow * FRAME_STRIDE),
+                           pucFront + (ulRow * FRAME_STRIDE), FRAME_STRIDE);
+                }
+            }
+            VideoDirtyDiff(pucFront, pucBack);
+            bRef = (g_bRefValid ||
+                    ((g_ucFrontType == LINK_PKT_FIELD) &&
+                     (g_ulRowFirst != ulRowFirst)));
+            break;
+        }
+
+        default:
+        {
+            //
+            // Unknown packet types are ignored.
+            //
+            return;
+        }
+    }
+
+    //
+    // A failed frame leaves the device out of step with the host, which has
+    // already moved its reference on, so wait for the next raw frame.
+    //
+    if(ulStatus == VIDEO_STATUS_OK)
+    {
+        //
+        // A frame following a scaled one changes every cell on the display.
+        // A scaled frame is no use as a reference, since the host's copy is
+        // the full size frame.
+        //
+        if(g_ucFrontType == LINK_PKT_SCALED)
+        {
+            VideoDirtyAll();
+            ulRowStep = 1;
+            ulScroll = 0;
+        }
+        g_ulFront ^= 1;
+        g_ucFrontType = ucType;
+        g_ulPlaneNext = ulPlaneNext;
+        g_bRefValid = bRef;
+        g_ulRefreshNext = ulRefresh;
+
+        //
+        // Cells changed by frames that were not drawn still need drawing,
+        // on every row.
+        //
+        for(ulBand = 0; ulBand < VIDEO_BANDS; ulBand++)
+        {
+            if(g_pusHeld[ulBand])
+            {
+                ulRowStep = 1;
+            }
+            g_pusDirty[ulBand] |= g_pusHeld[ulBand];
+            g_pusHeld[ulBand] = bDraw ? 0 : g_pusDirty[ulBand];
+        }
+        g_bPending = bDraw;
+        g_ulRowFirst = ulRowFirst;
+        g_ulRowStep = ulRowStep;
+        g_ulScroll = ulScroll;
+    }
+    else
+    {
+        g_bRefValid = false;
+        g_ulPlaneNext = PLANE_COUNT;
+    }
+
+    g_pucReport[0] = ucType;
+    g_pucReport[1] = ulStatus;
+    g_pucReport[2] = ulLength;
+    g_pucReport[3] = ulLength >> 8;
+    VideoPut32(g_pucReport + 4, CycleCountGet() - ulStart);
+    VideoPut32(g_pucReport + 8, 0);
+
+    //
+    // Frames that will not be drawn are reported straight away.
+    //
+    if(!g_bPending)
+    {
+        LinkReport(LINK_RPT_FRAME, g_pucReport, sizeof(g_pucReport));
+    }
+}
+
+//*****************************************************************************
+//
+// Draws the changed cells of a full size frame.  Bands of changed cells are
+// sent to the display as windows; consecutive bands with the same changed
+// columns are merged into a single window.  After an interlaced field only
+// the rows of that field are drawn.
+//
+//*****************************************************************************
+static void
+VideoDrawDirty(const unsigned char *pucFrame)
+{
+    unsigned long ulBand, ulEnd, ulFirst, ulLast;
+
+    for(ulBand = 0; ulBand < VIDEO_BANDS; ulBand = ulEnd)
+    {
+        ulEnd = ulBand + 1;
+        if(g_pusDirty[ulBand] == 0)
+        {
+            continue;
+        }
+
+        //
+        // Find the first and last changed cell in this band.
+        //
+        for(ulFirst = 0; !(g_pusDirty[ulBand] & (1 << ulFirst)); ulFirst++)
+        {
+        }
+        for(ulLast = VIDEO_CELL_COLS - 1;
+            !(g_pusDirty[ulBand] & (1 << ulLast)); ulLast--)
+        {
+        }
+
+        //
+        // Extend the window over following bands with the same mask.
+        //
+        while((ulEnd < VIDEO_BANDS) &&
+              (g_pusDirty[ulEnd] == g_pusDirty[ulBand]))
+        {
+            ulEnd++;
+        }
+
+        if(g_ulRowStep == 1)
+        {
+            RIT128x96x4ImageDrawStride(pucFrame +
+                                       (ulBand * VIDEO_CELL_SIZE *
+                                        FRAME_STRIDE) +
+                                       (ulFirst * VIDEO_CELL_SIZE / 2),
+                                       FRAME_STRIDE, ulFirst * VIDEO_CELL_SIZE,
+                                       ulBand * VIDEO_CELL_SIZE,
+                                       (ulLast - ulFirst + 1) *
+                                       VIDEO_CELL_SIZE,
+                                       (ulEnd - ulBand) * VIDEO_CELL_SIZE);
+        }
+        else
+        {
+            RIT128x96x4ImageDrawInterlaced(pucFrame +
+                                           (((ulBand * VIDEO_CELL_SIZE) +
+                                             g_ulRowFirst) * FRAME_STRIDE) +
+                                           (ulFirst * VIDEO_CELL_SIZE / 2),
+                                           2 * FRAME_STRIDE,
+                                           ulFirst * VIDEO_CELL_SIZE,
+                                           (ulBand * VIDEO_CELL_SIZE) +
+                                           g_ulRowFirst,
+                                           (ulLast - ulFirst + 1) *
+                                           VIDEO_CELL_SIZE,
+                                           (ulEnd - ulBand) *
+                                           VIDEO_CELL_SIZE / 2);
+        }
+    }
+}
+
+//*****************************************************************************
+//
+//! Draws the most recently decoded frame.
+//!
+//! Only the cells the frame changed are drawn, except for scaled frames,
+//! which are scaled up over the whole display, and frames that scroll, which
+//! scroll the display and draw the rows they uncover.  Nothing is drawn if no
+//! frame has been decoded since the last call.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+VideoPresent(void)
+{
+    const unsigned char *pucFront;
+    unsigned long ulStart;
+    ProfileBegin();
+
+    if(!g_bPending)
+    {
+        return;
+    }
+    g_bPending = false;
+
+    ulStart = CycleCountGet();
+    pucFront = (const unsigned char *)g_ppulFrame[g_ulFront];
+
+    if(g_ucFrontType == LINK_PKT_SCALED)
+    {
+        RIT128x96x4ImageDrawScaled(pucFront,
+                                   ((g_ucScale & VIDEO_SCALE_HALF_X) ?
+                                    (FRAME_WIDTH / 2) : FRAME_WIDTH),
+                                   ((g_ucScale & VIDEO_SCALE_HALF_Y) ?
+                                    (FRAME_HEIGHT / 2) : FRAME_HEIGHT),
+                                   ((g_ucScale & VIDEO_SCALE_FILTER) ?
+                                    true : false));
+    }
+    else
+    {
+        if(g_ulScroll)
+        {
+            RIT128x96x4Scroll(pucFront +
+                              ((FRAME_HEIGHT - g_ulScroll) * FRAME_STRIDE),
+                              g_ulScroll);
+        }
+        VideoDrawDirty(pucFront);
+    }
+
+    VideoPut32(g_pucReport + 8, CycleCountGet() - ulStart);
+    LinkReport(LINK_RPT_FRAME, g_pucReport, sizeof(g_pucReport));
+    LatencyDrawn(ulStart);
+    ProfileEnd(PROFILE_PRESENT);
+
+    //
+    // The first frame ends the startup timeline.
+    //
+    BootMark(BOOT_MARK_FRAME);
+}
+
+//*****************************************************************************
+//
+//! Returns whether a decoded frame is waiting to be drawn.
+//!
+//! \return Returns non-zero if VideoPresent() has a frame to draw.
+//
+//*****************************************************************************
+unsigned long
+VideoPending(void)
+{
+    return(g_bPending);
+}
+
+//*****************************************************************************
+//
+//! Drops the most recently decoded frame without drawing it.
+//!
+//! The cells it changed are drawn with the next frame that is drawn, as for
+//! frames the host asks not to be drawn.  A scroll cannot be carried over, so
+//! after one the next frame is drawn whole.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+VideoSkip(void)
+{
+    unsigned long ulBand;
+
+    if(!g_bPending)
+    {
+        return;
+    }
+    g_bPending = false;
+
+    if(g_ulScroll)
+    {
+        VideoDirtyAll();
+        g_ulScroll = 0;
+    }
+    for(ulBand = 0; ulBand < VIDEO_BANDS; ulBand++)
+    {
+        g_pusHeld[ulBand] |= g_pusDirty[ulBand];
+    }
+
+    LinkReport(LINK_RPT_FRAME, g_pucReport, sizeof(g_pucReport));
+    LatencySkipped();
+}
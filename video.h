@@ -0,0 +1,68 @@
+//*****************************************************************************
+//
+// video.h - Frame slots and packet decoding for the video player.
+//
+//*****************************************************************************
+
+#ifndef __VIDEO_H__
+#define __VIDEO_H__
+
+//*****************************************************************************
+//
+// Geometry of a frame slot.  Frames use the same layout as
+// RIT128x96x4ImageDraw(): two pixels per byte, left pixel in the high nibble,
+// rows stored top to bottom with no padding.
+//
+//*****************************************************************************
+#define FRAME_WIDTH             128
+#define FRAME_HEIGHT            96
+#define FRAME_STRIDE            (FRAME_WIDTH / 2)
+#define FRAME_BYTES             (FRAME_STRIDE * FRAME_HEIGHT)
+
+//*****************************************************************************
+//
+// Dirty regions are tracked on a grid of 8x8 pixel cells: one 16-bit mask per
+// band of eight rows, with bit n set when cell column n has changed.
+//
+//*****************************************************************************
+#define VIDEO_CELL_SIZE         8
+#define VIDEO_CELL_COLS         (FRAME_WIDTH / VIDEO_CELL_SIZE)
+#define VIDEO_BANDS             (FRAME_HEIGHT / VIDEO_CELL_SIZE)
+
+//*****************************************************************************
+//
+// Flags in the first byte of a scaled frame, which carries a frame of half
+// the width and/or height that is scaled up as it is drawn.
+//
+#define VIDEO_SCALE_HALF_X      0x01        // 64 columns rather than 128
+#define VIDEO_SCALE_HALF_Y      0x02        // 48 rows rather than 96
+#define VIDEO_SCALE_FILTER      0x04        // Interpolate the added pixels
+
+//
+// The first byte of an interlaced field, which carries every second row of a
+// frame starting with row 0 or, if VIDEO_FIELD_ODD is set, row 1.
+//
+#define VIDEO_FIELD_ODD         0x01        // Odd numbered rows
+
+//
+// Status codes returned in the LINK_RPT_FRAME report.
+//
+//*****************************************************************************
+#define VIDEO_STATUS_OK         0           // Frame decoded and displayed
+#define VIDEO_STATUS_NO_REF     1           // Inter frame without a reference
+#define VIDEO_STATUS_ERROR      2           // Malformed frame payload
+
+//*****************************************************************************
+//
+// Prototypes for the video APIs.
+//
+//*****************************************************************************
+extern void VideoInit(void);
+extern void VideoPacketDecode(unsigned char ucType,
+                              const unsigned char *pucData,
+                              unsigned long ulLength);
+extern void VideoPresent(void);
+extern unsigned long VideoPending(void);
+extern void VideoSkip(void);
+
+#endif // __VIDEO_H__
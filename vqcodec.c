@@ -0,0 +1,107 @@
+//*****************************************************************************
+//
+// vqcodec.c - Decoder for the vector quantised frame codec.
+//
+// The host trains a codebook of 256 4x4 blocks for each scene and uploads
+// it once with a codebook packet:
+//
+//   byte 0        index of the first entry being loaded
+//   8 bytes each  entries, four rows of two bytes
+//
+// Every frame of the scene is then one byte per 4x4 block, 768 bytes in
+// raster order, an eighth of a raw frame.  Decoding is a table lookup per
+// block with two blocks written per word store.
+//
+//*****************************************************************************
+
+#include <stdint.h>
+#include <string.h>
+#include "video.h"
+#include "vqcodec.h"
+
+//*****************************************************************************
+//
+// The codebook.  Each entry is held as four 16-bit rows in memory order, so a
+// row of two neighbouring blocks is one 32-bit word.
+//
+//*****************************************************************************
+static uint16_t g_ppusCodebook[VQ_CODEBOOK_SIZE][VQ_BLOCK_SIZE];
+
+//*****************************************************************************
+//
+//! Loads entries into the codebook.
+//!
+//! \param pucData is a pointer to the codebook packet.
+//! \param ulLength is the number of bytes in the packet.
+//!
+//! \return Returns 0 on success or -1 if the packet is malformed, in which
+//! case the codebook is left unchanged.
+//
+//*****************************************************************************
+long
+VQCodebookLoad(const unsigned char *pucData, unsigned long ulLength)
+{
+    unsigned long ulFirst, ulCount;
+
+    if((ulLength < 1) || (((ulLength - 1) % VQ_ENTRY_BYTES) != 0))
+    {
+        return(-1);
+    }
+    ulFirst = pucData[0];
+    ulCount = (ulLength - 1) / VQ_ENTRY_BYTES;
+    if((ulFirst + ulCount) > VQ_CODEBOOK_SIZE)
+    {
+        return(-1);
+    }
+
+    memcpy(g_ppusCodebook[ulFirst], pucData + 1, ulCount * VQ_ENTRY_BYTES);
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Decodes a VQ frame.
+//!
+//! \param pucData is a pointer to the block indices.
+//! \param ulLength is the number of bytes of encoded data.
+//! \param pucFrame is the frame slot to decode into; it must be word aligned.
+//!
+//! \return Returns 0 on success or -1 if the encoded data is malformed.
+//
+//*****************************************************************************
+long
+VQDecode(const unsigned char *pucData, unsigned long ulLength,
+         unsigned char *pucFrame)
+{
+    const uint16_t *pusLeft, *pusRight;
+    uint32_t *pulDst;
+    unsigned long ulRow, ulCol, ulLine;
+
+    if(ulLength != VQ_INDEX_BYTES)
+    {
+        return(-1);
+    }
+
+    for(ulRow = 0; ulRow < VQ_ROWS; ulRow++)
+    {
+        pulDst = (uint32_t *)(pucFrame +
+                              (ulRow * VQ_BLOCK_SIZE * FRAME_STRIDE));
+        for(ulCol = 0; ulCol < VQ_COLS; ulCol += 2)
+        {
+            //
+            // Each output word holds one row of a pair of blocks; the part is
+            // little endian, so the left block goes in the low half.
+            //
+            pusLeft = g_ppusCodebook[*pucData++];
+            pusRight = g_ppusCodebook[*pucData++];
+            for(ulLine = 0; ulLine < VQ_BLOCK_SIZE; ulLine++)
+            {
+                pulDst[ulLine * (FRAME_STRIDE / 4)] =
+                    ((uint32_t)pusRight[ulLine] << 16) | pusLeft[ulLine];
+            }
+            pulDst++;
+        }
+    }
+
+    return(0);
+}
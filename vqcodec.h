@@ -0,0 +1,34 @@
+//*****************************************************************************
+//
+// vqcodec.h - Decoder for the vector quantised frame codec.
+//
+//*****************************************************************************
+
+#ifndef __VQCODEC_H__
+#define __VQCODEC_H__
+
+//*****************************************************************************
+//
+// Block and codebook geometry.  A codebook entry is a 4x4 block stored as
+// four rows of two bytes, and a frame is a 32x24 grid of entry indices.
+//
+//*****************************************************************************
+#define VQ_BLOCK_SIZE           4
+#define VQ_ROW_BYTES            (VQ_BLOCK_SIZE / 2)
+#define VQ_ENTRY_BYTES          (VQ_BLOCK_SIZE * VQ_ROW_BYTES)
+#define VQ_CODEBOOK_SIZE        256
+#define VQ_COLS                 32
+#define VQ_ROWS                 24
+#define VQ_INDEX_BYTES          (VQ_COLS * VQ_ROWS)
+
+//*****************************************************************************
+//
+// Prototypes for the VQ codec APIs.
+//
+//*****************************************************************************
+extern long VQCodebookLoad(const unsigned char *pucData,
+                           unsigned long ulLength);
+extern long VQDecode(const unsigned char *pucData, unsigned long ulLength,
+                     unsigned char *pucFrame);
+
+#endif // __VQCODEC_H__
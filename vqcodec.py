@@ -0,0 +1,138 @@
+#Codebook trainer and encoder for the vector quantised codec decoded by
+#vqcodec.c on the device.  Requires numpy.
+import numpy as np
+from multiprocessing import cpu_count
+from multiprocessing.pool import ThreadPool
+from hostframe import WIDTH, HEIGHT
+
+#Block and codebook geometry, matching vqcodec.h
+BLOCK_SIZE = 4
+ROW_BYTES = BLOCK_SIZE // 2
+ENTRY_BYTES = BLOCK_SIZE * ROW_BYTES
+CODEBOOK_SIZE = 256
+COLS = WIDTH // BLOCK_SIZE
+ROWS = HEIGHT // BLOCK_SIZE
+INDEX_BYTES = COLS * ROWS
+
+#Mean absolute difference per pixel, in grey levels, that starts a new scene
+SCENE_CUT = 2.5
+#K-means passes when training a codebook
+ITERATIONS = 12
+#Most frames of a scene sampled for training
+TRAIN_FRAMES = 16
+
+
+def blocks(frame):
+    """Unpack a frame into one 16 pixel vector per 4x4 block, raster order"""
+    packed = np.frombuffer(bytes(frame), dtype=np.uint8).reshape(HEIGHT, WIDTH // 2)
+    pixels = np.empty((HEIGHT, WIDTH), np.uint8)
+    pixels[:, 0::2] = packed >> 4
+    pixels[:, 1::2] = packed & 0xF
+    return (pixels.reshape(ROWS, BLOCK_SIZE, COLS, BLOCK_SIZE).swapaxes(1, 2)
+            .reshape(INDEX_BYTES, BLOCK_SIZE * BLOCK_SIZE).astype(np.float32))
+
+
+def unblocks(vectors):
+    """Pack block vectors back into a frame"""
+    pixels = (vectors.reshape(ROWS, COLS, BLOCK_SIZE, BLOCK_SIZE).swapaxes(1, 2)
+              .reshape(HEIGHT, WIDTH).astype(np.uint8))
+    return bytearray(((pixels[:, 0::2] << 4) | pixels[:, 1::2]).tobytes())
+
+
+def entries(codebook):
+    """Pack a codebook into the 8 bytes per entry the device stores"""
+    c = codebook.reshape(CODEBOOK_SIZE, BLOCK_SIZE, BLOCK_SIZE)
+    return bytearray(((c[:, :, 0::2] << 4) | c[:, :, 1::2]).tobytes())
+
+
+def scene_change(prev, vectors):
+    """Decide whether two frames, as block vectors, belong to different
+    scenes"""
+    return prev is None or np.abs(vectors - prev).mean() > SCENE_CUT
+
+
+def nearest(vectors, codebook, pool=None, parts=1):
+    """Index of the closest codebook entry for each vector, split into parts
+    searched on the thread pool when one is given"""
+    norms = (codebook * codebook).sum(axis=1)
+
+    def search(chunk):
+        return np.argmin(norms - 2.0 * chunk.dot(codebook.T), axis=1)
+
+    if pool is None:
+        return search(vectors)
+    chunks = np.array_split(vectors, parts)
+    return np.concatenate(pool.map(search, chunks))
+
+
+def train(vectors, pool=None, parts=1, iterations=ITERATIONS):
+    """K-means codebook for a set of block vectors, as 4-bit pixel values"""
+    distinct = np.unique(vectors, axis=0)
+    if len(distinct) <= CODEBOOK_SIZE:
+        #Few enough distinct blocks to represent them all exactly
+        codebook = np.zeros((CODEBOOK_SIZE, vectors.shape[1]), np.float32)
+        codebook[:len(distinct)] = distinct
+        return codebook.astype(np.uint8)
+    rng = np.random.RandomState(len(vectors))
+    codebook = distinct[rng.choice(len(distinct), CODEBOOK_SIZE, replace=False)]
+    for n in range(iterations):
+        assign = nearest(vectors, codebook, pool, parts)
+        counts = np.bincount(assign, minlength=CODEBOOK_SIZE)
+        sums = np.zeros_like(codebook)
+        np.add.at(sums, assign, vectors)
+        used = counts > 0
+        codebook[used] = sums[used] / counts[used][:, None]
+        #Move unused entries onto the worst represented blocks
+        unused = np.flatnonzero(~used)
+        if len(unused):
+            error = ((vectors - codebook[assign]) ** 2).sum(axis=1)
+            codebook[unused] = vectors[np.argsort(error)[-len(unused):]]
+    return np.clip(np.rint(codebook), 0, 15).astype(np.uint8)
+
+
+class VQEncoder(object):
+    """Chooses a codebook for each scene and maps frames onto it"""
+
+    def __init__(self, workers=None):
+        self.workers = workers or cpu_count()
+        self.pool = ThreadPool(self.workers)
+        self.codebook = None
+        self.prev = None
+        #Codebooks trained ahead of time, by frame number within the clip
+        self.plan = {}
+        self.clip_len = 0
+        self.count = 0
+
+    def pretrain(self, frames):
+        """Split a clip into scenes and train their codebooks in parallel"""
+        vectors = [blocks(frame) for frame in frames]
+        starts = [0] + [i for i in range(1, len(vectors))
+                        if scene_change(vectors[i - 1], vectors[i])]
+        samples = []
+        for start, end in zip(starts, starts[1:] + [len(vectors)]):
+            step = max(1, (end - start) // TRAIN_FRAMES)
+            samples.append(np.concatenate(vectors[start:end:step]))
+        self.plan = dict(zip(starts, self.pool.map(train, samples)))
+        self.clip_len = len(frames)
+        self.count = 0
+
+    def encode(self, frame, upload=False):
+        """Encode a frame, returning (codebook packet or None, block indices,
+        reconstructed frame).  The codebook is sent when it changes or when
+        upload is set."""
+        vectors = blocks(frame)
+        codebook = None
+        if self.plan:
+            codebook = self.plan.get(self.count % self.clip_len)
+        elif self.codebook is None or scene_change(self.prev, vectors):
+            codebook = train(vectors, self.pool, self.workers)
+        self.prev = vectors
+        self.count += 1
+        if codebook is not None:
+            self.codebook = codebook
+            upload = True
+        indices = nearest(vectors, self.codebook.astype(np.float32), self.pool,
+                          self.workers)
+        recon = unblocks(self.codebook[indices])
+        return ((bytearray([0]) + entries(self.codebook)) if upload else None,
+                bytearray(indices.astype(np.uint8).tobytes()), recon)
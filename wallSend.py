@@ -0,0 +1,154 @@
+#Video wall: play a video across several boards side by side, each showing its
+#tile of the larger picture, with every board drawing each frame at the same
+#moment by the host's clock
+import serial, time, os, sys, argparse, threading
+from subprocess import call, Popen
+import hostframe, hostlink
+from streamenc import StreamEncoder
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+#Set serial baud rate
+baud = 1500000
+#Codecs that need no training on the whole clip
+CODECS = ['raw', 'block', 'lz', 'huff', 'auto']
+
+parser = argparse.ArgumentParser(description='Play a video across several LM3S6965 OLED displays')
+parser.add_argument('filename', help='video file to play')
+parser.add_argument('--ports', nargs='+', required=True,
+                    help='serial ports of the boards, left to right then top to bottom')
+parser.add_argument('--columns', type=int,
+                    help='boards across the wall (default all of them)')
+parser.add_argument('--codec', choices=CODECS, default='block',
+                    help='frame codec (default block)')
+parser.add_argument('--keyint', type=int, default=60,
+                    help='frames between keyframes (default 60)')
+parser.add_argument('--fps', type=float, default=17,
+                    help='frames per second (default 17)')
+parser.add_argument('--latency', type=int, default=100,
+                    help='milliseconds the boards hold frames before drawing them (default 100)')
+parser.add_argument('--sync', type=float, default=1,
+                    help='seconds between sync packets (default 1)')
+parser.add_argument('--dump', metavar='PREFIX',
+                    help='write each board\'s packets to PREFIXn.bin for bench/decbench '
+                    'rather than send them')
+args = parser.parse_args()
+columns = args.columns or len(args.ports)
+if len(args.ports) % columns:
+    sys.exit('Error: %d boards do not make rows of %d' % (len(args.ports), columns))
+rows = len(args.ports) // columns
+width = hostframe.WIDTH * columns
+height = hostframe.HEIGHT * rows
+
+
+class Board(threading.Thread):
+    """Sends one board its tile of every frame from a queue, so a board whose
+    port is backed up does not hold up the others.  The queue holds (pts,
+    tile) for frames, a time for sync packets and None at the end."""
+
+    def __init__(self, index, port, start):
+        threading.Thread.__init__(self)
+        self.daemon = True
+        self.column = index % columns
+        self.row = index // columns
+        #Host time the clock in sync packets counts from
+        self.start_time = start
+        self.encoder = StreamEncoder(args.codec, args.keyint, latency=args.latency)
+        self.queue = queue.Queue()
+        self.index = index
+        self.reader = None
+        if args.dump:
+            self.ser = None
+        else:
+            self.ser = serial.Serial(port, baud)
+            self.reader = hostlink.ReportReader(self.ser, self.encoder)
+            self.reader.start()
+
+    def packets(self):
+        """The packets for the queued frames and sync times, in order"""
+        while 1:
+            item = self.queue.get()
+            if item is None:
+                break
+            if isinstance(item, tuple):
+                pts, frame = item
+                for packet in self.encoder.encode(frame, pts):
+                    yield packet
+            else:
+                #The board times a sync packet from when it arrives, so it is
+                #sent on an idle port and stamped just before it goes
+                if self.ser:
+                    self.ser.flush()
+                    item = 1000.0 * (time.time() - self.start_time)
+                yield hostlink.PKT_SYNC, hostlink.sync_payload(item)
+
+    def run(self):
+        if self.ser:
+            for ptype, payload in self.packets():
+                self.ser.write(hostlink.packet(ptype, payload))
+        else:
+            hostlink.write_records('%s%d.bin' % (args.dump, self.index),
+                                   self.packets())
+
+
+#Move into the imageConv directory and convert the file at the size of the wall
+os.chdir('./imageConv')
+for file in os.listdir("./"):
+    if file.endswith(".pgm"):
+        os.remove(file)
+if call('ffmpeg -i %s -s %dx%d -r %s -threads 8 -loglevel panic out%%05d.pgm' %
+        (args.filename, width, height, args.fps)) != 0:
+    sys.exit('Error: could not convert ' + args.filename)
+
+boards = []
+start = time.time()
+try:
+    for n, port in enumerate(args.ports):
+        boards.append(Board(n, port, start))
+except serial.SerialException:
+    sys.exit('Error: Serial Error. Please check that the boards are connected')
+for board in boards:
+    board.start()
+
+#Frame n is due n frame intervals after the start by the host's clock, and
+#every board draws it the latency after that
+frames = hostframe.list_frames()
+try:
+    if not args.dump:
+        threading.Timer(args.latency / 1000.0, Popen,
+                        ['ffplay -autoexit -loglevel panic ' + args.filename]).start()
+    next_sync = 0
+    for n, file in enumerate(frames):
+        pts = 1000.0 * n / args.fps
+        if not args.dump:
+            delay = start + pts / 1000.0 - time.time()
+            if delay > 0:
+                time.sleep(delay)
+        if pts >= next_sync:
+            for board in boards:
+                board.queue.put(pts)
+            next_sync += 1000.0 * args.sync
+        pixels = hostframe.read_pgm(file, width, height)
+        if pixels is None:
+            continue
+        for board in boards:
+            tile = hostframe.tile(pixels, width, board.column, board.row)
+            board.queue.put((pts, hostframe.pack(tile)))
+except KeyboardInterrupt:
+    pass
+
+for board in boards:
+    board.queue.put(None)
+for board in boards:
+    board.join()
+#Let the last reports arrive, then close the serial connections
+time.sleep(0.2)
+for n, board in enumerate(boards):
+    if board.ser:
+        board.ser.close()
+    if board.reader and board.reader.stats.types:
+        print('Board %d (%s):' % (n, args.ports[n]))
+        print(board.reader.stats.summary())
+print('Sent %d frames to %d boards' % (len(frames), len(boards)))
@@ -0,0 +1,187 @@
+//*****************************************************************************
+//
+// window.c - Windows of the frame updated by their own stream channels.
+//
+// A screen that mixes, for example, a small video inset with a status pane
+// changes at very different rates in different places, and whole frame
+// packets make the slowest changing part follow the fastest.  Instead the
+// host can lay out rectangles of cells as windows, in a layout packet
+//
+//   rest          for each window: x, y, width and height in cells
+//
+// and update each one on its own, in window packets
+//
+//   byte 0        channel: the window's place in the layout
+//   next          a bit for each cell of the window, in rows, set for the
+//                 cells sent; bit n of the bitmap is bit n % 8 of byte n / 8
+//   rest          the pixels of each cell sent, WINDOW_CELL_BYTES each
+//
+// so each channel goes at its own rate and only its changed cells cross the
+// link.  Windows must not overlap.  A window's pixels live in its rectangle
+// of the frame on display, so windows take no memory of their own, and the
+// changed cells are drawn with the rest of the display's dirty cells.  Whole
+// frame packets replace every window along with the rest of the frame, which
+// makes them the background the windows sit on.
+//
+//*****************************************************************************
+
+#include <string.h>
+#include "video.h"
+#include "window.h"
+
+//*****************************************************************************
+//
+// The windows laid out: x, y, width and height in cells, as sent.
+//
+//*****************************************************************************
+static unsigned char g_ppucWindow[WINDOW_COUNT][4];
+static unsigned long g_ulWindowCount;
+
+//*****************************************************************************
+//
+//! Lays out the windows.
+//!
+//! \param pucData is a pointer to the layout packet.
+//! \param ulLength is the number of bytes in the packet.
+//!
+//! The layout replaces any before it.  A malformed packet leaves no windows
+//! laid out.
+//!
+//! \return Returns 0 on success or -1 if the packet is malformed.
+//
+//*****************************************************************************
+long
+WindowLayout(const unsigned char *pucData, unsigned long ulLength)
+{
+    unsigned short pusUsed[VIDEO_BANDS];
+    unsigned short usMask;
+    unsigned long ulWindow, ulBand;
+
+    g_ulWindowCount = 0;
+    if((ulLength % 4) || (ulLength > sizeof(g_ppucWindow)))
+    {
+        return(-1);
+    }
+
+    memset(pusUsed, 0, sizeof(pusUsed));
+    for(ulWindow = 0; ulWindow < (ulLength / 4); ulWindow++)
+    {
+        if((pucData[2] == 0) || (pucData[3] == 0) ||
+           ((pucData[0] + pucData[2]) > VIDEO_CELL_COLS) ||
+           ((pucData[1] + pucData[3]) > VIDEO_BANDS))
+        {
+            return(-1);
+        }
+        usMask = ((1 << pucData[2]) - 1) << pucData[0];
+        for(ulBand = pucData[1]; ulBand < (pucData[1] + pucData[3]);
+            ulBand++)
+        {
+            if(pusUsed[ulBand] & usMask)
+            {
+                return(-1);
+            }
+            pusUsed[ulBand] |= usMask;
+        }
+        memcpy(g_ppucWindow[ulWindow], pucData, 4);
+        pucData += 4;
+    }
+    g_ulWindowCount = ulLength / 4;
+
+    return(0);
+}
+
+//*****************************************************************************
+//
+//! Forgets the window layout, so window packets are refused until the host
+//! sends it again.
+//!
+//! \return None.
+//
+//*****************************************************************************
+void
+WindowForget(void)
+{
+    g_ulWindowCount = 0;
+}
+
+//*****************************************************************************
+//
+//! Decodes the cells of a window packet.
+//!
+//! \param pucData is a pointer to the window packet.
+//! \param ulLength is the number of bytes in the packet.
+//! \param pucFrame is the frame to write the cells into, which must already
+//! hold the previous frame.
+//! \param pusDirty is an array of \b VIDEO_BANDS masks, which must be clear;
+//! the bit for every cell written is set.
+//!
+//! \return Returns 0 on success, 1 if the packet is for a window that is not
+//! laid out or -1 if the packet is malformed.
+//
+//*****************************************************************************
+long
+WindowDecode(const unsigned char *pucData, unsigned long ulLength,
+             unsigned char *pucFrame, unsigned short *pusDirty)
+{
+    const unsigned char *pucWindow, *pucMask;
+    unsigned char *pucCell;
+    unsigned long ulCells, ulMaskBytes, ulSent, ulCell, ulColumn, ulBand;
+    unsigned long ulRow;
+
+    if((ulLength == 0) || (pucData[0] >= WINDOW_COUNT))
+    {
+        return(-1);
+    }
+    if(pucData[0] >= g_ulWindowCount)
+    {
+        return(1);
+    }
+    pucWindow = g_ppucWindow[pucData[0]];
+    ulCells = pucWindow[2] * pucWindow[3];
+    ulMaskBytes = (ulCells + 7) / 8;
+    if(ulLength < (1 + ulMaskBytes))
+    {
+        return(-1);
+    }
+
+    //
+    // The length must match the cells sent.
+    //
+    pucMask = pucData + 1;
+    for(ulSent = 0, ulCell = 0; ulCell < ulCells; ulCell++)
+    {
+        if(pucMask[ulCell / 8] & (1 << (ulCell % 8)))
+        {
+            ulSent++;
+        }
+    }
+    if(ulLength != (1 + ulMaskBytes + (ulSent * WINDOW_CELL_BYTES)))
+    {
+        return(-1);
+    }
+
+    //
+    // A row of a cell is one word of a frame row.
+    //
+    pucData = pucMask + ulMaskBytes;
+    for(ulCell = 0; ulCell < ulCells; ulCell++)
+    {
+        if(!(pucMask[ulCell / 8] & (1 << (ulCell % 8))))
+        {
+            continue;
+        }
+        ulColumn = pucWindow[0] + (ulCell % pucWindow[2]);
+        ulBand = pucWindow[1] + (ulCell / pucWindow[2]);
+        pucCell = (pucFrame + (ulBand * VIDEO_CELL_SIZE * FRAME_STRIDE) +
+                   (ulColumn * (VIDEO_CELL_SIZE / 2)));
+        for(ulRow = 0; ulRow < VIDEO_CELL_SIZE; ulRow++)
+        {
+            memcpy(pucCell + (ulRow * FRAME_STRIDE), pucData,
+                   VIDEO_CELL_SIZE / 2);
+            pucData += VIDEO_CELL_SIZE / 2;
+        }
+        pusDirty[ulBand] |= 1 << ulColumn;
+    }
+
+    return(0);
+}
@@ -0,0 +1,36 @@
+//*****************************************************************************
+//
+// window.h - Windows of the frame updated by their own stream channels.
+//
+//*****************************************************************************
+
+#ifndef __WINDOW_H__
+#define __WINDOW_H__
+
+//*****************************************************************************
+//
+// The most windows laid out at once.  A window's channel is its place in the
+// layout.
+//
+//*****************************************************************************
+#define WINDOW_COUNT            8
+
+//*****************************************************************************
+//
+// The bytes of one cell of a window update: its rows of pixels, laid out as
+// in a frame.
+//
+//*****************************************************************************
+#define WINDOW_CELL_BYTES       (VIDEO_CELL_SIZE * VIDEO_CELL_SIZE / 2)
+
+//*****************************************************************************
+//
+// Prototypes for the window APIs.
+//
+//*****************************************************************************
+extern long WindowLayout(const unsigned char *pucData, unsigned long ulLength);
+extern void WindowForget(void);
+extern long WindowDecode(const unsigned char *pucData, unsigned long ulLength,
+                         unsigned char *pucFrame, unsigned short *pusDirty);
+
+#endif // __WINDOW_H__
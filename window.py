@@ -0,0 +1,97 @@
+#Windows of the frame updated on their own stream channels, matching window.h
+#on the device
+import hostlink
+from hostframe import FRAME_BYTES, STRIDE
+
+#Most windows laid out at once
+COUNT = 8
+#Pixels along the side of a cell, and bytes of a cell as sent
+CELL = 8
+CELL_BYTES = CELL * CELL // 2
+#Display size in cells
+COLUMNS = 16
+BANDS = 12
+
+
+class WindowSet(object):
+    """Keeps the host's copy of the frame on display and sends each window's
+    changed cells on its own channel.  After request_keyframe() the next
+    update sends the whole frame and the layout again."""
+
+    def __init__(self, layout, background=None):
+        """layout is a list of (x, y, width, height) in cells; a window's
+        channel is its place in the list"""
+        if len(layout) > COUNT:
+            raise ValueError('too many windows: %d' % len(layout))
+        used = set()
+        for x, y, width, height in layout:
+            cells = set((x + i, y + j) for i in range(width)
+                        for j in range(height))
+            if (width < 1 or height < 1 or x < 0 or y < 0 or
+                    x + width > COLUMNS or y + height > BANDS or
+                    cells & used):
+                raise ValueError('bad window %r' % ((x, y, width, height),))
+            used |= cells
+        self.layout = list(layout)
+        self.frame = bytearray(background or bytearray(FRAME_BYTES))
+        self.reset = True
+
+    def request_keyframe(self):
+        self.reset = True
+
+    def decoded(self, ptype, length, cycles):
+        pass
+
+    def _key(self):
+        """The packets that make the device's frame and layout whole again"""
+        self.reset = False
+        layout = bytearray()
+        for window in self.layout:
+            layout += bytearray(window)
+        return [(hostlink.PKT_RAW, bytearray(self.frame)),
+                (hostlink.PKT_LAYOUT, layout)]
+
+    def background(self, frame):
+        """Return the packets that replace the frame around the windows; the
+        windows keep what they show"""
+        frame = bytearray(frame)
+        for x, y, width, height in self.layout:
+            for row in range(y * CELL, (y + height) * CELL):
+                start = row * STRIDE + x * CELL // 2
+                end = start + width * CELL // 2
+                frame[start:end] = self.frame[start:end]
+        self.frame = frame
+        return self._key()
+
+    def update(self, channel, pixels):
+        """Return the packets that show packed pixels, rows of the window's
+        width, in a window; empty if nothing changed"""
+        x, y, width, height = self.layout[channel]
+        row_bytes = width * CELL // 2
+        if len(pixels) != row_bytes * height * CELL:
+            raise ValueError('window %d needs %d bytes' %
+                             (channel, row_bytes * height * CELL))
+        pixels = bytearray(pixels)
+        mask = bytearray((width * height + 7) // 8)
+        cells = bytearray()
+        for n in range(width * height):
+            column = x + n % width
+            band = y + n // width
+            cell = bytearray()
+            for row in range(CELL):
+                src = (n // width * CELL + row) * row_bytes + n % width * 4
+                cell += pixels[src:src + 4]
+            changed = False
+            for row in range(CELL):
+                dst = (band * CELL + row) * STRIDE + column * 4
+                if self.frame[dst:dst + 4] != cell[row * 4:row * 4 + 4]:
+                    self.frame[dst:dst + 4] = cell[row * 4:row * 4 + 4]
+                    changed = True
+            if changed:
+                mask[n // 8] |= 1 << (n % 8)
+                cells += cell
+        if self.reset:
+            return self._key()
+        if not cells:
+            return []
+        return [(hostlink.PKT_WINDOW, bytearray([channel]) + mask + cells)]
@@ -0,0 +1,104 @@
+#Window demo: an animated inset and a clock pane, each sent on its own
+#channel at its own rate over a background sent once
+import math, sys, argparse
+import serial
+import hostframe, hostlink, window
+
+#Set serial baud rate
+baud = 1500000
+comPort = 'COM9'
+
+parser = argparse.ArgumentParser(description='Update windows of the LM3S6965 OLED display')
+parser.add_argument('--port', default=comPort, help='serial port of the board')
+parser.add_argument('--fps', type=float, default=15,
+                    help='frames per second of the inset (default 15)')
+parser.add_argument('--frames', type=int, default=0,
+                    help='inset frames to send, 0 to run until interrupted')
+parser.add_argument('--dump', metavar='FILE',
+                    help='write the packets to FILE for bench/decbench rather '
+                    'than send them')
+args = parser.parse_args()
+
+#Channels: a 64x48 inset at the top left and a 64x48 pane at the top right
+INSET, CLOCK = 0, 1
+LAYOUT = [(0, 0, 8, 6), (8, 0, 8, 6)]
+SIZE = 64, 48
+
+#Digits of 3x5 pixels, a row of three bits per entry
+DIGITS = [[7, 5, 5, 5, 7], [2, 6, 2, 2, 7], [7, 1, 7, 4, 7], [7, 1, 7, 1, 7],
+          [5, 5, 7, 1, 1], [7, 4, 7, 1, 7], [7, 4, 7, 5, 7], [7, 1, 1, 1, 1],
+          [7, 5, 7, 5, 7], [7, 5, 7, 1, 7]]
+
+
+def background():
+    """Stripes under the windows"""
+    pixels = bytearray(hostframe.WIDTH * hostframe.HEIGHT)
+    for y in range(hostframe.HEIGHT):
+        for x in range(hostframe.WIDTH):
+            pixels[y * hostframe.WIDTH + x] = (2 + ((x + 2 * y) // 8) % 3) << 4
+    return hostframe.pack(pixels)
+
+
+def pack(levels):
+    """Packed pixels from 4-bit levels"""
+    return bytearray(levels[i] << 4 | levels[i + 1]
+                     for i in range(0, len(levels), 2))
+
+
+def inset(n):
+    """An interference pattern that changes every pixel on every frame"""
+    t = n / 8.0
+    width, height = SIZE
+    return pack([int(7.5 + 2.5 * (math.sin(x / 6.0 + t) +
+                                  math.sin(y / 5.0 - 0.7 * t) +
+                                  math.sin((x + y) / 9.0 + 1.3 * t)))
+                  for y in range(height) for x in range(width)])
+
+
+def clock(seconds):
+    """Minutes and seconds in digits four pixels to a dot"""
+    width, height = SIZE
+    levels = [1] * (width * height)
+    text = '%02d%02d' % (seconds // 60 % 100, seconds % 60)
+    for i, digit in enumerate(text):
+        left = 4 + i * 14 + (4 if i > 1 else 0)
+        for row, bits in enumerate(DIGITS[int(digit)]):
+            for col in range(3):
+                if bits >> (2 - col) & 1:
+                    for y in range(14 + row * 4, 18 + row * 4):
+                        for x in range(left + col * 4, left + col * 4 + 4):
+                            levels[y * width + x] = 15
+    for y in (22, 30):
+        for x in range(31, 33):
+            levels[y * width + x] = levels[(y + 1) * width + x] = 15
+    return pack(levels)
+
+
+windows = window.WindowSet(LAYOUT, background())
+
+
+def step(n):
+    """The packets for inset frame n, with the clock pane when its second
+    changes"""
+    packets = windows.update(INSET, inset(n))
+    if n == 0 or int(n / args.fps) != int((n - 1) / args.fps):
+        packets += windows.update(CLOCK, clock(int(n / args.fps)))
+    return packets
+
+
+if args.dump:
+    hostlink.write_records(args.dump, [packet for n in range(args.frames or 300)
+                                       for packet in step(n)])
+    sys.exit(0)
+
+try:
+    ser = serial.Serial(args.port, baud)
+    stats, sent, n = hostlink.stream(ser, step, args.fps, windows, args.frames)
+except KeyboardInterrupt:
+    sys.exit(0)
+except serial.SerialException:
+    sys.exit('Error: Serial Error. Please check that the board is connected')
+
+if stats.types:
+    print(stats.summary())
+print('Sent %d bytes, %.1f bytes/frame' % (sent, float(sent) / max(n, 1)))